@@ -1,7 +1,42 @@
 #include "GDALDataSource.h"
+#include "Async/Async.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "CoordinateSystemRegistry.h"
 #include "GDALHeaders.h"
 #include "GDALHelpers.h"
+#include "GenerationCostCalibration.h"
+#include "GenerationMemoryBudget.h"
+#include "HeightmapHoleFilling.h"
 #include "LandscapeConstraints.h"
+#include "LandscapeGenRuntime.h"
+#include "RasterBuffers.h"
+
+// Holds a copy of the data source's properties, so that retrieval on a worker thread is unaffected by subsequent property changes
+struct FGDALRetrievalRequest
+{
+	FString HeightmapDataset;
+	FString RGBDataset;
+	EGISDataChannels Channels;
+	bool bRestrictToExtent;
+	FVector2D ExtentUpperLeft;
+	FVector2D ExtentLowerRight;
+	int32 OverviewLevel;
+	int32 RemoteBlockCacheMB;
+	FString TargetProjection;
+	bool bFillNoData;
+	EGDALResamplingKernel HeightmapResampling;
+	EGDALResamplingKernel RGBResampling;
+	int32 WarpThreads;
+	int32 WarpChunkMemoryMB;
+};
+
+// The state of an in-flight retrieval, shared between the data source and the worker thread performing the retrieval
+struct FGDALRetrievalState
+{
+	FThreadSafeBool bCancelled;
+	FThreadSafeCounter ProgressPercent;
+};
 
 namespace
 {
@@ -10,86 +45,622 @@ namespace
 		const char* projection = dataset->GetProjectionRef();
 		return ((projection != nullptr) ? FString(UTF8_TO_TCHAR(projection)) : FString() );
 	}
+	
+	// Converts remote dataset URLs to the equivalent GDAL virtual filesystem paths so that they are read using HTTP range requests
+	// (See: https://gdal.org/user/virtual_file_systems.html#network-based-file-systems)
+	FString ResolveDatasetPath(const FString& path)
+	{
+		const TPair<const TCHAR*, const TCHAR*> prefixes[] =
+		{
+			{ TEXT("s3://"), TEXT("/vsis3/") },
+			{ TEXT("gs://"), TEXT("/vsigs/") },
+			{ TEXT("az://"), TEXT("/vsiaz/") }
+		};
+		
+		for (const TPair<const TCHAR*, const TCHAR*>& prefix : prefixes)
+		{
+			if (path.StartsWith(prefix.Key)) {
+				return prefix.Value + path.RightChop(FCString::Strlen(prefix.Key));
+			}
+		}
+		
+		if (path.StartsWith(TEXT("http://")) || path.StartsWith(TEXT("https://"))) {
+			return TEXT("/vsicurl/") + path;
+		}
+		
+		return path;
+	}
+	
+	// Determines whether a resolved dataset path refers to a network-based virtual filesystem
+	bool IsRemoteDatasetPath(const FString& path)
+	{
+		return path.StartsWith(TEXT("/vsicurl")) || path.StartsWith(TEXT("/vsis3")) || path.StartsWith(TEXT("/vsigs")) || path.StartsWith(TEXT("/vsiaz"));
+	}
+	
+	// Ensures the GDAL block cache is large enough to hold the tiles of remote datasets covering the requested extent
+	// (The block cache is shared by the whole process, so it is only ever grown and never shrunk)
+	void ReserveRemoteBlockCache(int32 blockCacheMB)
+	{
+		GIntBig blockCacheBytes = (GIntBig)FMath::Max(blockCacheMB, 0) * 1024 * 1024;
+		if (GDALGetCacheMax64() < blockCacheBytes) {
+			GDALSetCacheMax64(blockCacheBytes);
+		}
+	}
+	
+	// Configures GDAL for efficient reads of remote cloud-optimised GeoTIFFs on the current thread for the lifetime of the object
+	// (The options are set as thread-local overrides and the thread's previous values are restored afterwards, so that other
+	// GDAL users in the process are unaffected)
+	class FScopedRemoteReadOptions
+	{
+		public:
+			
+			FScopedRemoteReadOptions(bool enabled)
+			{
+				if (!enabled) {
+					return;
+				}
+				
+				// Avoid directory listings when opening remote files and cache the data that has been fetched
+				this->SetOption("GDAL_DISABLE_READDIR_ON_OPEN", "EMPTY_DIR");
+				this->SetOption("VSI_CACHE", "TRUE");
+				
+				// Merge requests for consecutive tiles and fetch non-consecutive tiles using parallel range requests over HTTP/2
+				this->SetOption("GDAL_HTTP_MERGE_CONSECUTIVE_RANGES", "YES");
+				this->SetOption("GDAL_HTTP_MULTIRANGE", "YES");
+				this->SetOption("GDAL_HTTP_MULTIPLEX", "YES");
+				this->SetOption("GDAL_HTTP_VERSION", "2");
+				
+				// Allow the GeoTIFF driver to fetch and decode tiles using multiple threads
+				this->SetOption("GDAL_NUM_THREADS", "ALL_CPUS");
+			}
+			
+			~FScopedRemoteReadOptions()
+			{
+				// Restore the previous values in reverse order (a null value removes the thread-local override)
+				for (int32 index = this->PreviousValues.Num() - 1; index >= 0; --index)
+				{
+					const TPair<FString, TOptional<FString>>& previous = this->PreviousValues[index];
+					CPLSetThreadLocalConfigOption(TCHAR_TO_UTF8(*previous.Key), previous.Value.IsSet() ? TCHAR_TO_UTF8(*previous.Value.GetValue()) : nullptr);
+				}
+			}
+			
+			FScopedRemoteReadOptions(const FScopedRemoteReadOptions&) = delete;
+			FScopedRemoteReadOptions& operator=(const FScopedRemoteReadOptions&) = delete;
+			
+		private:
+			
+			void SetOption(const char* key, const char* value)
+			{
+				const char* previous = CPLGetThreadLocalConfigOption(key, nullptr);
+				this->PreviousValues.Emplace(UTF8_TO_TCHAR(key), (previous != nullptr) ? TOptional<FString>(UTF8_TO_TCHAR(previous)) : TOptional<FString>());
+				CPLSetThreadLocalConfigOption(key, value);
+			}
+			
+			TArray<TPair<FString, TOptional<FString>>> PreviousValues;
+	};
+	
+	// Opens a raster dataset, optionally selecting one of its overview levels
+	GDALDatasetRef OpenDataset(const FString& path, int32 overviewLevel)
+	{
+		FTCHARToUTF8 overviewOption(*FString::Printf(TEXT("OVERVIEW_LEVEL=%d"), overviewLevel));
+		const char* openOptions[] = { overviewOption.Get(), nullptr };
+		return GDALDatasetRef((GDALDataset*)GDALOpenEx(
+			TCHAR_TO_UTF8(*path),
+			GDAL_OF_RASTER | GDAL_OF_READONLY,
+			nullptr,
+			(overviewLevel >= 0) ? openOptions : nullptr,
+			nullptr
+		));
+	}
+	
+	// Reads the data within the specified extent into an in-memory dataset, which only reads the blocks covering the extent
+	GDALDatasetRef CropToExtent(GDALDatasetRef& dataset, const FVector2D& upperLeft, const FVector2D& lowerRight, const FString& extentWkt)
+	{
+		return GDALHelpers::Translate(dataset, GDALHelpers::UniqueMemFilename(),
+			GDALHelpers::ParseGDALTranslateOptions({
+				TEXT("-of"),
+				TEXT("MEM"),
+				TEXT("-projwin"),
+				FString::Printf(TEXT("%lf"), upperLeft.X),
+				FString::Printf(TEXT("%lf"), upperLeft.Y),
+				FString::Printf(TEXT("%lf"), lowerRight.X),
+				FString::Printf(TEXT("%lf"), lowerRight.Y),
+				TEXT("-projwin_srs"),
+				extentWkt
+			})
+		);
+	}
+	
+	// The metadata of a dataset that determines the cost of reading the requested extent from it
+	struct FDatasetPlan
+	{
+		int32 sizeX = 0;
+		int32 sizeY = 0;
+		int32 numBlocks = 0;
+		int64 readBytes = 0;
+		bool remote = false;
+		bool hasNoData = false;
+	};
+	
+	// Opens a dataset and computes the dimensions, block count and uncompressed size of the data within the requested extent (if any)
+	// (The extent is assumed to be specified in the dataset's own projected coordinate system, and opening a remote dataset blocks the
+	// calling thread while its header is fetched)
+	FString PlanDataset(const FString& path, int32 overviewLevel, int32 numBands, bool restrictToExtent, const FVector2D& upperLeft, const FVector2D& lowerRight, FDatasetPlan& plan)
+	{
+		FString resolvedPath = ResolveDatasetPath(path);
+		FScopedRemoteReadOptions remoteReadOptions(IsRemoteDatasetPath(resolvedPath));
+		GDALDatasetRef dataset = OpenDataset(resolvedPath, overviewLevel);
+		if (!dataset) {
+			return FString::Printf(TEXT("Failed to open the dataset \"%s\""), *path);
+		}
+		
+		if (dataset->GetRasterCount() < numBands) {
+			return FString::Printf(TEXT("Dataset \"%s\" must contain at least %d raster bands"), *path, numBands);
+		}
+		
+		plan.sizeX = dataset->GetRasterXSize();
+		plan.sizeY = dataset->GetRasterYSize();
+		double geoTransform[6];
+		if (restrictToExtent && dataset->GetGeoTransform(geoTransform) == CE_None && geoTransform[1] != 0.0 && geoTransform[5] != 0.0)
+		{
+			plan.sizeX = FMath::Min(plan.sizeX, FMath::CeilToInt(FMath::Abs(lowerRight.X - upperLeft.X) / FMath::Abs(geoTransform[1])));
+			plan.sizeY = FMath::Min(plan.sizeY, FMath::CeilToInt(FMath::Abs(lowerRight.Y - upperLeft.Y) / FMath::Abs(geoTransform[5])));
+		}
+		
+		GDALRasterBand* band = dataset->GetRasterBand(1);
+		int blockX = 0;
+		int blockY = 0;
+		band->GetBlockSize(&blockX, &blockY);
+		plan.numBlocks = FMath::DivideAndRoundUp(plan.sizeX, FMath::Max(blockX, 1)) * FMath::DivideAndRoundUp(plan.sizeY, FMath::Max(blockY, 1));
+		plan.readBytes = (int64)plan.sizeX * plan.sizeY * numBands * GDALGetDataTypeSizeBytes(band->GetRasterDataType());
+		plan.remote = IsRemoteDatasetPath(resolvedPath);
+		
+		int hasNoDataValue = 0;
+		band->GetNoDataValue(&hasNoDataValue);
+		plan.hasNoData = (hasNoDataValue != 0);
+		return TEXT("");
+	}
+	
+	// Returns the gdalwarp name for the specified resampling kernel
+	FString GetResamplingMethod(EGDALResamplingKernel kernel)
+	{
+		switch (kernel)
+		{
+			case EGDALResamplingKernel::Nearest:
+				return TEXT("near");
+			case EGDALResamplingKernel::Cubic:
+				return TEXT("cubic");
+			case EGDALResamplingKernel::CubicSpline:
+				return TEXT("cubicspline");
+			case EGDALResamplingKernel::Lanczos:
+				return TEXT("lanczos");
+			case EGDALResamplingKernel::Average:
+				return TEXT("average");
+			case EGDALResamplingKernel::Bilinear:
+			default:
+				return TEXT("bilinear");
+		}
+	}
+	
+	// Builds the gdalwarp options shared by all warp operations, which perform multithreaded chunked warping into an in-memory dataset
+	TArray<FString> GetCommonWarpOptions(EGDALResamplingKernel kernel, int32 numThreads, int32 chunkMemoryMB)
+	{
+		return {
+			TEXT("-of"),
+			TEXT("MEM"),
+			TEXT("-r"),
+			GetResamplingMethod(kernel),
+			TEXT("-multi"),
+			TEXT("-wo"),
+			(numThreads > 0) ? FString::Printf(TEXT("NUM_THREADS=%d"), numThreads) : FString(TEXT("NUM_THREADS=ALL_CPUS")),
+			TEXT("-wm"),
+			FString::Printf(TEXT("%d"), FMath::Max(chunkMemoryMB, 1))
+		};
+	}
 }
 
 void UGDALDataSource::RetrieveData(FGISDataSourceDelegate OnSuccess, FGISDataSourceDelegate OnFailure)
 {
-	// Attempt to perform data retrieval
-	FGISData data;
-	FString error = this->RetrieveDataInternal(data);
+	FLandscapeGenRuntimeModule::EnsureGDALInitialized();
+	
+	// Take a copy of our properties so that retrieval is unaffected by any changes made while it is in flight
+	FGDALRetrievalRequest request;
+	request.HeightmapDataset = this->HeightmapDataset;
+	request.RGBDataset = this->RGBDataset;
+	request.Channels = this->Channels;
+	request.bRestrictToExtent = this->bRestrictToExtent;
+	request.ExtentUpperLeft = this->ExtentUpperLeft;
+	request.ExtentLowerRight = this->ExtentLowerRight;
+	request.OverviewLevel = this->OverviewLevel;
+	request.RemoteBlockCacheMB = this->RemoteBlockCacheMB;
+	request.TargetProjection = this->TargetProjection;
+	request.bFillNoData = this->bFillNoData;
+	request.HeightmapResampling = this->HeightmapResampling;
+	request.RGBResampling = this->RGBResampling;
+	request.WarpThreads = this->WarpThreads;
+	request.WarpChunkMemoryMB = this->WarpChunkMemoryMB;
+	
+	TSharedRef<FGDALRetrievalState, ESPMode::ThreadSafe> state = MakeShared<FGDALRetrievalState, ESPMode::ThreadSafe>();
+	this->ActiveRetrievals.Add(state);
+	
+	// Perform data retrieval on a dedicated thread (leaving the thread pool free for the concurrent reads that retrieval spawns),
+	// which allows multiple retrievals to run at once without blocking the game thread
+	TWeakObjectPtr<UGDALDataSource> weakThis(this);
+	Async(EAsyncExecution::Thread, [weakThis, request, state, OnSuccess, OnFailure]()
+	{
+		// Attempt to perform data retrieval
+		TSharedRef<FGISData, ESPMode::ThreadSafe> data = MakeShared<FGISData, ESPMode::ThreadSafe>();
+		FString error = UGDALDataSource::RetrieveDataInternal(request, state.Get(), data.Get());
+		
+		// Notify the appropriate delegate of our success or failure on the game thread, unless retrieval was cancelled
+		AsyncTask(ENamedThreads::GameThread, [weakThis, state, OnSuccess, OnFailure, error, data]()
+		{
+			if (weakThis.IsValid()) {
+				weakThis->ActiveRetrievals.Remove(state);
+			}
+			
+			if (state->bCancelled) {
+				return;
+			}
+			
+			if (error.IsEmpty()) {
+				OnSuccess.Broadcast(error, data.Get());
+			}
+			else {
+				OnFailure.Broadcast(error, FGISData());
+			}
+		});
+	});
+}
+
+void UGDALDataSource::CancelRetrieval()
+{
+	// Signal all in-flight retrievals to stop at their next checkpoint (their buffers are released once they finish)
+	for (const TSharedRef<FGDALRetrievalState, ESPMode::ThreadSafe>& state : this->ActiveRetrievals) {
+		state->bCancelled = true;
+	}
+	
+	this->ActiveRetrievals.Empty();
+}
+
+float UGDALDataSource::GetRetrievalProgress() const
+{
+	if (this->ActiveRetrievals.Num() == 0) {
+		return 0.0f;
+	}
+	
+	// Report the average progress of all in-flight retrievals
+	float progress = 0.0f;
+	for (const TSharedRef<FGDALRetrievalState, ESPMode::ThreadSafe>& state : this->ActiveRetrievals) {
+		progress += state->ProgressPercent.GetValue() / 100.0f;
+	}
+	
+	return progress / this->ActiveRetrievals.Num();
+}
+
+FGISRetrievalPlan UGDALDataSource::PlanRetrieval() const
+{
+	FLandscapeGenRuntimeModule::EnsureGDALInitialized();
+	
+	FGISRetrievalPlan plan;
+	const bool retrieveHeight = (this->Channels != EGISDataChannels::ColorOnly);
+	const bool retrieveColor = (this->Channels != EGISDataChannels::HeightOnly);
 	
-	//Notify the appropriate delegate of our success or failure
-	if (error.IsEmpty()) {
-		OnSuccess.Broadcast(error, data);
+	// Planning runs synchronously on the calling thread, so open the RGB dataset on a worker thread while we open the heightmap
+	// dataset, which limits the time spent blocked on remote datasets to a single round trip for their headers
+	FDatasetPlan rgb;
+	TFuture<FString> rgbPlanResult = Async(EAsyncExecution::ThreadPool, [&]() -> FString
+	{
+		if (!retrieveColor) {
+			return TEXT("");
+		}
+		
+		return PlanDataset(this->RGBDataset, this->OverviewLevel, 3, this->bRestrictToExtent, this->ExtentUpperLeft, this->ExtentLowerRight, rgb);
+	});
+	
+	FDatasetPlan heightmap;
+	FString heightmapError;
+	if (retrieveHeight) {
+		heightmapError = PlanDataset(this->HeightmapDataset, this->OverviewLevel, 1, this->bRestrictToExtent, this->ExtentUpperLeft, this->ExtentLowerRight, heightmap);
 	}
-	else {
-		OnFailure.Broadcast(error, data);
+	
+	// Wait for the RGB dataset to be planned and report the first error encountered (if any)
+	FString rgbError = rgbPlanResult.Get();
+	if (!heightmapError.IsEmpty() || !rgbError.IsEmpty())
+	{
+		plan.Error = (!heightmapError.IsEmpty() ? heightmapError : rgbError);
+		return plan;
+	}
+	
+	if (retrieveHeight && ((uint64)heightmap.sizeX > LandscapeConstraints::MaxRasterSizeX() || (uint64)heightmap.sizeY > LandscapeConstraints::MaxRasterSizeY()))
+	{
+		plan.Error = FString::Printf(
+			TEXT("Heightmap raster size of %dx%d exceeds maximum supported size of %llux%llu"),
+			heightmap.sizeX, heightmap.sizeY, LandscapeConstraints::MaxRasterSizeX(), LandscapeConstraints::MaxRasterSizeY()
+		);
+		return plan;
 	}
+	
+	if (retrieveColor && ((uint64)rgb.sizeX > LandscapeConstraints::MaxRasterSizeX() || (uint64)rgb.sizeY > LandscapeConstraints::MaxRasterSizeY()))
+	{
+		plan.Error = FString::Printf(
+			TEXT("RGB raster size of %dx%d exceeds maximum supported size of %llux%llu"),
+			rgb.sizeX, rgb.sizeY, LandscapeConstraints::MaxRasterSizeX(), LandscapeConstraints::MaxRasterSizeY()
+		);
+		return plan;
+	}
+	
+	// Each block of the datasets is read once, and the blocks of remote datasets are fetched using range requests
+	// (The download size is the uncompressed size of the blocks, which is an upper bound for compressed cloud-optimised GeoTIFFs)
+	plan.NumTiles = heightmap.numBlocks + rgb.numBlocks;
+	plan.NumRequests = (heightmap.remote ? heightmap.numBlocks : 0) + (rgb.remote ? rgb.numBlocks : 0);
+	plan.ExpectedDownloadBytes = (heightmap.remote ? heightmap.readBytes : 0) + (rgb.remote ? rgb.readBytes : 0);
+	plan.HeightSizeX = heightmap.sizeX;
+	plan.HeightSizeY = heightmap.sizeY;
+	plan.ColorSizeX = rgb.sizeX;
+	plan.ColorSizeY = rgb.sizeY;
+	plan.bHeightMayHaveNoData = heightmap.hasNoData && !this->bFillNoData;
+	
+	// The in-memory copies made when cropping, warping and converting the datasets are held alongside the output buffers, and
+	// filling holes during retrieval allocates the same working buffers as filling them during generation
+	int64 numSamples = (int64)heightmap.sizeX * heightmap.sizeY;
+	int64 numPixels = (int64)rgb.sizeX * rgb.sizeY;
+	plan.PeakMemoryBytes = plan.GetDataBytes() + heightmap.readBytes + rgb.readBytes;
+	plan.PeakMemoryBytes += (heightmap.hasNoData && this->bFillNoData) ? FGenerationMemoryBudget::EstimateHoleFilling(numSamples) : 0;
+	plan.PeakMemoryBytes += (this->TargetProjection.IsEmpty() ? 0 : numSamples * sizeof(float)) + ((retrieveHeight && retrieveColor) ? numPixels * 3 : 0);
+	
+	// Only the time spent downloading remote data is estimated, since reads of local datasets are typically much faster
+	plan.EstimatedSeconds = FGenerationCostCalibration::Load().EstimateDownloadSeconds(plan.ExpectedDownloadBytes);
+	return plan;
 }
 
-FString UGDALDataSource::RetrieveDataInternal(FGISData& data)
+FString UGDALDataSource::RetrieveDataInternal(const FGDALRetrievalRequest& request, FGDALRetrievalState& state, FGISData& data)
 {
+	// Determine which of the datasets we need to read from
+	const bool retrieveHeight = (request.Channels != EGISDataChannels::ColorOnly);
+	const bool retrieveColor = (request.Channels != EGISDataChannels::HeightOnly);
+	
+	
 	//------- STEP 1: OPEN DATASETS -------
 	
-	// Attempt to open the heightmap dataset
-	GDALDatasetRef heightmap = mergetiff::DatasetManagement::openDataset(TCHAR_TO_UTF8(*(this->HeightmapDataset)));
-	if (!heightmap) {
-		return TEXT("Failed to open the heightmap dataset");
+	// Resolve any remote URLs to GDAL virtual filesystem paths and configure GDAL for remote reads if required
+	// (The remote read options are thread-local, so they are held by this thread for the remainder of the retrieval and by each of
+	// the worker threads that open and read the RGB dataset, since blocks are fetched lazily whenever the datasets are read)
+	FString heightmapPath = (retrieveHeight ? ResolveDatasetPath(request.HeightmapDataset) : FString());
+	FString rgbPath = (retrieveColor ? ResolveDatasetPath(request.RGBDataset) : FString());
+	const bool remoteReads = (IsRemoteDatasetPath(heightmapPath) || IsRemoteDatasetPath(rgbPath));
+	if (remoteReads) {
+		ReserveRemoteBlockCache(request.RemoteBlockCacheMB);
 	}
 	
-	// Attempt to open the RGB dataset
-	GDALDatasetRef rgb = mergetiff::DatasetManagement::openDataset(TCHAR_TO_UTF8(*(this->RGBDataset)));
-	if (!rgb) {
-		return TEXT("Failed to open the RGB dataset");
+	FScopedRemoteReadOptions remoteReadOptions(remoteReads);
+	
+	// Attempt to open the heightmap dataset
+	GDALDatasetRef heightmap;
+	FString extentWkt;
+	if (retrieveHeight)
+	{
+		heightmap = OpenDataset(heightmapPath, request.OverviewLevel);
+		if (!heightmap) {
+			return TEXT("Failed to open the heightmap dataset");
+		}
+		
+		// The requested extent (if any) is specified in the projected coordinate system of the heightmap dataset
+		extentWkt = GetProjectionWkt(heightmap);
+		if (request.bRestrictToExtent && extentWkt.IsEmpty()) {
+			return TEXT("Failed to retrieve the projected coordinate system used by the heightmap dataset");
+		}
 	}
 	
+	// Open the RGB dataset and read the requested extent from it on a worker thread while we do the same for the heightmap,
+	// with each thread using its own dataset handle (retrieval as a whole already runs on a worker thread, so neither open blocks
+	// the game thread)
+	GDALDatasetRef rgb;
+	TFuture<FString> rgbOpenResult = Async(EAsyncExecution::ThreadPool, [&]() -> FString
+	{
+		if (!retrieveColor) {
+			return TEXT("");
+		}
+		
+		// Attempt to open the RGB dataset
+		FScopedRemoteReadOptions workerRemoteReadOptions(remoteReads);
+		rgb = OpenDataset(rgbPath, request.OverviewLevel);
+		if (!rgb) {
+			return TEXT("Failed to open the RGB dataset");
+		}
+		
+		// Attempt to read the data within the extent from the RGB dataset
+		// (If we are not retrieving height data then the extent is specified in the projected coordinate system of the RGB dataset)
+		if (request.bRestrictToExtent)
+		{
+			rgb = CropToExtent(rgb, request.ExtentUpperLeft, request.ExtentLowerRight, retrieveHeight ? extentWkt : GetProjectionWkt(rgb));
+			if (!rgb) {
+				return TEXT("Failed to read the requested extent from the RGB dataset");
+			}
+		}
+		
+		return TEXT("");
+	});
+	
 	
-	//------- STEP 2: RETRIEVE DATASET METADATA -------
+	//------- STEP 2: RESTRICT DATASETS TO THE REQUESTED EXTENT -------
+	
+	// Attempt to read the data within the extent from the heightmap dataset
+	FString heightmapError;
+	if (retrieveHeight && request.bRestrictToExtent)
+	{
+		heightmap = CropToExtent(heightmap, request.ExtentUpperLeft, request.ExtentLowerRight, extentWkt);
+		if (!heightmap) {
+			heightmapError = TEXT("Failed to read the requested extent from the heightmap dataset");
+		}
+	}
 	
-	// Attempt to retrieve the Well-Known Text (WKT) representation of the projected coordinate system used by the heightmap dataset
-	FString heightmapWkt = GetProjectionWkt(heightmap);
-	if (heightmapWkt.IsEmpty()) {
-		return TEXT("Failed to retrieve the projected coordinate system used by the heightmap dataset");
+	// Wait for the RGB dataset to be opened and report the first error encountered (if any)
+	FString rgbError = rgbOpenResult.Get();
+	if (!heightmapError.IsEmpty() || !rgbError.IsEmpty()) {
+		return (!heightmapError.IsEmpty() ? heightmapError : rgbError);
 	}
 	
-	// Attempt to retrieve the Well-Known Text (WKT) representation of the projected coordinate system used by the RGB dataset
-	FString rgbWkt = GetProjectionWkt(rgb);
-	if (rgbWkt.IsEmpty()) {
-		return TEXT("Failed to retrieve the projected coordinate system used by the RGB dataset");
+	if (state.bCancelled) {
+		return TEXT("Data retrieval was cancelled");
 	}
 	
-	// Attempt to retrieve the projected corner coordinates for the heightmap dataset
-	RasterCornerCoordinatesRef heightmapCorners = GDALHelpers::GetRasterCorners(heightmap);
-	if (!heightmapCorners) {
-		return TEXT("Failed to compute the projected corner coordinates of the heightmap dataset");
+	state.ProgressPercent.Set(25);
+	
+	
+	//------- STEP 3: RETRIEVE DATASET METADATA -------
+	
+	// The target grid is defined by the heightmap dataset, or by the RGB dataset if we are not retrieving height data
+	FString gridWkt;
+	FVector2D gridUpperLeft;
+	FVector2D gridLowerRight;
+	
+	if (retrieveHeight)
+	{
+		// Attempt to retrieve the Well-Known Text (WKT) representation of the projected coordinate system used by the heightmap dataset
+		gridWkt = GetProjectionWkt(heightmap);
+		if (gridWkt.IsEmpty()) {
+			return TEXT("Failed to retrieve the projected coordinate system used by the heightmap dataset");
+		}
+		
+		// Attempt to retrieve the projected corner coordinates for the heightmap dataset
+		RasterCornerCoordinatesRef heightmapCorners = GDALHelpers::GetRasterCorners(heightmap);
+		if (!heightmapCorners) {
+			return TEXT("Failed to compute the projected corner coordinates of the heightmap dataset");
+		}
+		
+		gridUpperLeft = heightmapCorners->UpperLeft;
+		gridLowerRight = heightmapCorners->LowerRight;
 	}
 	
-	// Attempt to retrieve the projected corner coordinates for the RGB dataset
-	RasterCornerCoordinatesRef rgbCorners = GDALHelpers::GetRasterCorners(rgb);
-	if (!rgbCorners) {
-		return TEXT("Failed to compute the projected corner coordinates of the RGB dataset");
+	FString rgbWkt;
+	FVector2D rgbUpperLeft;
+	FVector2D rgbLowerRight;
+	
+	if (retrieveColor)
+	{
+		// Attempt to retrieve the Well-Known Text (WKT) representation of the projected coordinate system used by the RGB dataset
+		rgbWkt = GetProjectionWkt(rgb);
+		if (rgbWkt.IsEmpty()) {
+			return TEXT("Failed to retrieve the projected coordinate system used by the RGB dataset");
+		}
+		
+		// Attempt to retrieve the projected corner coordinates for the RGB dataset
+		RasterCornerCoordinatesRef rgbCorners = GDALHelpers::GetRasterCorners(rgb);
+		if (!rgbCorners) {
+			return TEXT("Failed to compute the projected corner coordinates of the RGB dataset");
+		}
+		
+		rgbUpperLeft = rgbCorners->UpperLeft;
+		rgbLowerRight = rgbCorners->LowerRight;
+		
+		// Verify that the RGB dataset has at least 3 bands
+		if (rgb->GetRasterCount() < 3) {
+			return TEXT("RGB dataset must contain R, G and B channels");
+		}
 	}
 	
 	
-	//------- STEP 3: VERIFY METADATA VALIDITY -------
+	//------- STEP 4: WARP DATASETS TO A COMMON TARGET GRID -------
 	
-	// Verify that the two datasets use the same projected coordinate system
-	if (heightmapWkt.Equals(rgbWkt) == false) {
-		return TEXT("The heightmap dataset and RGB dataset must use the same projected coordinate system");
+	// If a target projected coordinate system was specified and it differs from the heightmap's then warp the heightmap to it,
+	// preserving the heightmap's nodata value so that areas outside of its coverage can be identified
+	if (retrieveHeight && request.TargetProjection.IsEmpty() == false && CoordinateSystemRegistry::IsSameCoordinateSystem(gridWkt, request.TargetProjection) == false)
+	{
+		TArray<FString> options = GetCommonWarpOptions(request.HeightmapResampling, request.WarpThreads, request.WarpChunkMemoryMB);
+		options.Append({
+			TEXT("-t_srs"),
+			request.TargetProjection,
+			TEXT("-ot"),
+			TEXT("Float32")
+		});
+		
+		heightmap = GDALHelpers::Warp(heightmap, GDALHelpers::UniqueMemFilename(), GDALHelpers::ParseGDALWarpOptions(options));
+		if (!heightmap) {
+			return TEXT("Failed to warp the heightmap dataset to the target projected coordinate system");
+		}
+		
+		// Retrieve the metadata for the warped heightmap, which now defines the target grid
+		gridWkt = GetProjectionWkt(heightmap);
+		RasterCornerCoordinatesRef heightmapCorners = GDALHelpers::GetRasterCorners(heightmap);
+		if (gridWkt.IsEmpty() || !heightmapCorners) {
+			return TEXT("Failed to retrieve the metadata of the warped heightmap dataset");
+		}
+		
+		gridUpperLeft = heightmapCorners->UpperLeft;
+		gridLowerRight = heightmapCorners->LowerRight;
 	}
 	
-	// Verify that the two datasets have the same corner coordinates
-	if (heightmapCorners->UpperLeft != rgbCorners->UpperLeft || heightmapCorners->LowerRight != rgbCorners->LowerRight) {
-		return TEXT("The heightmap dataset and RGB dataset must have the same geographic extents");
+	if (retrieveColor && !retrieveHeight)
+	{
+		// If we are only retrieving colour data then the RGB dataset defines the target grid, warping it to the target projected
+		// coordinate system if one was specified and it differs from the RGB dataset's
+		if (request.TargetProjection.IsEmpty() == false && CoordinateSystemRegistry::IsSameCoordinateSystem(rgbWkt, request.TargetProjection) == false)
+		{
+			TArray<FString> options = GetCommonWarpOptions(request.RGBResampling, request.WarpThreads, request.WarpChunkMemoryMB);
+			options.Append({
+				TEXT("-t_srs"),
+				request.TargetProjection
+			});
+			
+			rgb = GDALHelpers::Warp(rgb, GDALHelpers::UniqueMemFilename(), GDALHelpers::ParseGDALWarpOptions(options));
+			if (!rgb) {
+				return TEXT("Failed to warp the RGB dataset to the target projected coordinate system");
+			}
+			
+			rgbWkt = GetProjectionWkt(rgb);
+			RasterCornerCoordinatesRef rgbCorners = GDALHelpers::GetRasterCorners(rgb);
+			if (rgbWkt.IsEmpty() || !rgbCorners) {
+				return TEXT("Failed to retrieve the metadata of the warped RGB dataset");
+			}
+			
+			rgbUpperLeft = rgbCorners->UpperLeft;
+			rgbLowerRight = rgbCorners->LowerRight;
+		}
+		
+		gridWkt = rgbWkt;
+		gridUpperLeft = rgbUpperLeft;
+		gridLowerRight = rgbLowerRight;
 	}
 	
-	// Verify that the RGB dataset has at least 3 bands
-	if (rgb->GetRasterCount() < 3) {
-		return TEXT("RGB dataset must contain R, G and B channels");
+	// If the RGB dataset does not already share the heightmap's grid then warp it to the heightmap's projection and extents
+	bool rgbSameProjection = (retrieveColor && CoordinateSystemRegistry::IsSameCoordinateSystem(gridWkt, rgbWkt));
+	if (retrieveColor && retrieveHeight && (rgbSameProjection == false || gridUpperLeft != rgbUpperLeft || gridLowerRight != rgbLowerRight))
+	{
+		TArray<FString> options = GetCommonWarpOptions(request.RGBResampling, request.WarpThreads, request.WarpChunkMemoryMB);
+		options.Append({
+			TEXT("-t_srs"),
+			gridWkt,
+			TEXT("-te"),
+			FString::Printf(TEXT("%lf"), FMath::Min(gridUpperLeft.X, gridLowerRight.X)),
+			FString::Printf(TEXT("%lf"), FMath::Min(gridUpperLeft.Y, gridLowerRight.Y)),
+			FString::Printf(TEXT("%lf"), FMath::Max(gridUpperLeft.X, gridLowerRight.X)),
+			FString::Printf(TEXT("%lf"), FMath::Max(gridUpperLeft.Y, gridLowerRight.Y))
+		});
+		
+		// If the RGB data is already in the target projection then preserve its native resolution, otherwise let the warper
+		// select a resolution that approximately preserves the number of source pixels
+		double rgbGeoTransform[6];
+		if (rgbSameProjection && rgb->GetGeoTransform(rgbGeoTransform) == CE_None)
+		{
+			options.Append({
+				TEXT("-tr"),
+				FString::Printf(TEXT("%lf"), FMath::Abs(rgbGeoTransform[1])),
+				FString::Printf(TEXT("%lf"), FMath::Abs(rgbGeoTransform[5]))
+			});
+		}
+		
+		rgb = GDALHelpers::Warp(rgb, GDALHelpers::UniqueMemFilename(), GDALHelpers::ParseGDALWarpOptions(options));
+		if (!rgb) {
+			return TEXT("Failed to warp the RGB dataset to the projected coordinate system and extents of the heightmap dataset");
+		}
 	}
 	
+	
+	//------- STEP 5: VERIFY METADATA VALIDITY -------
+	
 	// Verify that the heightmap dataset does not exceed the maximum supported raster size for landscape generation
-	if (heightmap->GetRasterXSize() > LandscapeConstraints::MaxRasterSizeX() || heightmap->GetRasterYSize() > LandscapeConstraints::MaxRasterSizeY())
+	if (retrieveHeight && (heightmap->GetRasterXSize() > LandscapeConstraints::MaxRasterSizeX() || heightmap->GetRasterYSize() > LandscapeConstraints::MaxRasterSizeY()))
 	{
 		return FString::Printf(
 			TEXT("Heightmap raster size of %llux%llu exceeds maximum supported size of %llux%llu"),
@@ -101,7 +672,7 @@ FString UGDALDataSource::RetrieveDataInternal(FGISData& data)
 	}
 	
 	// Verify that the RGB dataset does not exceed the maximum supported raster size for landscape generation
-	if (rgb->GetRasterXSize() > LandscapeConstraints::MaxRasterSizeX() || rgb->GetRasterYSize() > LandscapeConstraints::MaxRasterSizeY())
+	if (retrieveColor && (rgb->GetRasterXSize() > LandscapeConstraints::MaxRasterSizeX() || rgb->GetRasterYSize() > LandscapeConstraints::MaxRasterSizeY()))
 	{
 		return FString::Printf(
 			TEXT("RGB raster size of %llux%llu exceeds maximum supported size of %llux%llu"),
@@ -113,20 +684,17 @@ FString UGDALDataSource::RetrieveDataInternal(FGISData& data)
 	}
 	
 	
-	//------- STEP 4: EMIT WARNINGS FOR KNOWN PROBLEMATIC METADATA -------
+	//------- STEP 6: EMIT WARNINGS FOR KNOWN PROBLEMATIC METADATA -------
 	
-	// Emit a warning if the heightmap data contains nodata values
+	// Retrieve the nodata value for the heightmap data (if any), which is used to identify holes once the data has been read
 	int hasNoDataValue = 0;
-	double noDataValue = heightmap->GetRasterBand(1)->GetNoDataValue(&hasNoDataValue);
-	if (hasNoDataValue) {
-		UE_LOG(LogTemp, Warning, TEXT("Heightmap dataset contains nodata values, this can interfere with height scaling!"));
-	}
+	double noDataValue = (retrieveHeight ? heightmap->GetRasterBand(1)->GetNoDataValue(&hasNoDataValue) : 0.0);
 	
 	// Emit a warning if the colour interpretation metadata for the raster bands do not indicate an RGB image
 	GDALColorInterp expectedInterp[] = { GCI_RedBand, GCI_GreenBand, GCI_BlueBand };
-	for (int index = 1; index <= 3; ++index)
+	for (int index = 1; retrieveColor && index <= 3; ++index)
 	{
-		if (rgb->GetRasterBand(index)->GetColorInterpretation() != expectedInterp[index])
+		if (rgb->GetRasterBand(index)->GetColorInterpretation() != expectedInterp[index - 1])
 		{
 			UE_LOG(LogTemp, Warning, TEXT("RGB dataset metadata does not indicate R,G,B ordering for raster bands!"));
 			break;
@@ -134,10 +702,10 @@ FString UGDALDataSource::RetrieveDataInternal(FGISData& data)
 	}
 	
 	
-	//------- STEP 5: RASTER DATA PREPROCESSING -------
+	//------- STEP 7: RASTER DATA PREPROCESSING -------
 	
 	// If the heightmap data is not already in Float32 format then convert it
-	if (heightmap->GetRasterBand(1)->GetRasterDataType() != GDT_Float32)
+	if (retrieveHeight && heightmap->GetRasterBand(1)->GetRasterDataType() != GDT_Float32)
 	{
 		// Attempt to convert the heightmap data to Float32
 		heightmap = GDALHelpers::Translate(heightmap, GDALHelpers::UniqueMemFilename(),
@@ -153,47 +721,103 @@ FString UGDALDataSource::RetrieveDataInternal(FGISData& data)
 		}
 	}
 	
+	if (state.bCancelled) {
+		return TEXT("Data retrieval was cancelled");
+	}
 	
-	//------- STEP 6: READ HEIGHTMAP RASTER DATA -------
-	
-	// Retrieve the raster dimensions for the heightmap
-	data.HeightBufferX = heightmap->GetRasterXSize();
-	data.HeightBufferY = heightmap->GetRasterYSize();
-	
-	// Create a buffer to hold the heightmap data and wrap it in a RasterData object
-	mergetiff::RasterData<float> heightmapData = GDALHelpers::AllocateAndWrap<float>(data.HeightBuffer, 1, data.HeightBufferY, data.HeightBufferX, 0.0f);
+	state.ProgressPercent.Set(50);
 	
-	// Attempt to read the heightmap data into our buffer
-	if (mergetiff::RasterIO::readDataset(heightmap, heightmapData, {1}) == false) {
-		return TEXT("Failed to read the data from the heightmap");
-	}
 	
+	//------- STEP 8: READ HEIGHTMAP AND RGB RASTER DATA -------
 	
-	//------- STEP 7: READ RGB RASTER DATA -------
+	// Read the RGB data on a worker thread while we read the heightmap data
+	TFuture<FString> rgbReadResult = Async(EAsyncExecution::ThreadPool, [&]() -> FString
+	{
+		if (!retrieveColor) {
+			return TEXT("");
+		}
+		
+		// Reads of an RGB dataset that was neither cropped nor warped fetch its remote blocks on this thread
+		FScopedRemoteReadOptions workerRemoteReadOptions(remoteReads);
+		
+		// Retrieve the raster dimensions for the RGB data
+		data.ColorBufferX = rgb->GetRasterXSize();
+		data.ColorBufferY = rgb->GetRasterYSize();
+		
+		// Create a buffer to hold the RGBA data and wrap it in a RasterData object, filling all channels with 255 by default
+		data.PixelFormat = EPixelFormat::PF_R8G8B8A8;
+		mergetiff::RasterData<uint8> rgbaData = RasterBuffers::AllocateAndWrap<uint8>(data.ColorBuffer, 4, data.ColorBufferY, data.ColorBufferX, 255);
+		
+		// Attempt to read the RGB data into our buffer, leaving the alpha channel filled with 255
+		if (mergetiff::RasterIO::readDataset(rgb, rgbaData, {1,2,3}) == false) {
+			return TEXT("Failed to read the data from the RGB dataset");
+		}
+		
+		return TEXT("");
+	});
 	
-	// Retrieve the raster dimensions for the RGB data
-	data.ColorBufferX = rgb->GetRasterXSize();
-	data.ColorBufferY = rgb->GetRasterYSize();
+	heightmapError = [&]() -> FString
+	{
+		if (!retrieveHeight) {
+			return TEXT("");
+		}
+		
+		// Retrieve the raster dimensions for the heightmap
+		data.HeightBufferX = heightmap->GetRasterXSize();
+		data.HeightBufferY = heightmap->GetRasterYSize();
+		
+		// Create a buffer to hold the heightmap data and wrap it in a RasterData object
+		mergetiff::RasterData<float> heightmapData = RasterBuffers::AllocateAndWrap<float>(data.HeightBuffer, 1, data.HeightBufferY, data.HeightBufferX, 0.0f);
+		
+		// Attempt to read the heightmap data into our buffer
+		if (mergetiff::RasterIO::readDataset(heightmap, heightmapData, {1}) == false) {
+			return TEXT("Failed to read the data from the heightmap");
+		}
+		
+		// If the heightmap has a nodata value then either fill the holes now or flag them for filling during landscape generation
+		if (hasNoDataValue)
+		{
+			if (request.bFillNoData)
+			{
+				int64 numFilled = HeightmapHoleFilling::FillHoles(data.HeightBuffer, data.HeightBufferX, data.HeightBufferY, (float)noDataValue);
+				if (numFilled < 0) {
+					return TEXT("The heightmap dataset does not contain any valid height values");
+				}
+				
+				if (numFilled > 0) {
+					UE_LOG(LogTemp, Log, TEXT("Filled %lld nodata samples in the heightmap dataset"), numFilled);
+				}
+			}
+			else
+			{
+				data.bHeightHasNoData = true;
+				data.HeightNoDataValue = (float)noDataValue;
+			}
+		}
+		
+		return TEXT("");
+	}();
 	
-	// Create a buffer to hold the RGBA data and wrap it in a RasterData object, filling all channels with 255 by default
-	data.PixelFormat = EPixelFormat::PF_R8G8B8A8;
-	mergetiff::RasterData<uint8> rgbaData = GDALHelpers::AllocateAndWrap<uint8>(data.ColorBuffer, 4, data.ColorBufferY, data.ColorBufferX, 255);
+	// Wait for the RGB data to be read and report the first error encountered (if any)
+	rgbError = rgbReadResult.Get();
+	if (!heightmapError.IsEmpty() || !rgbError.IsEmpty()) {
+		return (!heightmapError.IsEmpty() ? heightmapError : rgbError);
+	}
 	
-	// Attempt to read the RGB data into our buffer, leaving the alpha channel filled with 255
-	if (mergetiff::RasterIO::readDataset(rgb, rgbaData, {1,2,3}) == false) {
-		return TEXT("Failed to read the data from the RGB dataset");
+	if (state.bCancelled) {
+		return TEXT("Data retrieval was cancelled");
 	}
 	
 	
-	//------- STEP 8: STORE REQUIRED METADATA -------
+	//------- STEP 9: STORE REQUIRED METADATA -------
 	
 	// Store the corner coordinates
 	data.CornerType = ECornerCoordinateType::Projected;
-	data.UpperLeft = heightmapCorners->UpperLeft;
-	data.LowerRight = heightmapCorners->LowerRight;
+	data.UpperLeft = gridUpperLeft;
+	data.LowerRight = gridLowerRight;
 	
 	// Store the projected coordinate system WKT
-	data.ProjectionWKT = heightmapWkt;
+	data.ProjectionWKT = gridWkt;
 	
 	// If we reach this point then data retrieval succeeded
 	return TEXT("");
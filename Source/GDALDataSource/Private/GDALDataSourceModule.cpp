@@ -1,13 +1,8 @@
 #include "GDALDataSourceModule.h"
-#include "UnrealGDAL.h"
 
 #define LOCTEXT_NAMESPACE "FGDALDataSourceModule"
 
-void FGDALDataSourceModule::StartupModule()
-{
-	FUnrealGDALModule* UnrealGDAL = FModuleManager::Get().LoadModulePtr<FUnrealGDALModule>("UnrealGDAL");
-	UnrealGDAL->InitGDAL();
-}
+void FGDALDataSourceModule::StartupModule() {}
 
 void FGDALDataSourceModule::ShutdownModule() {}
 
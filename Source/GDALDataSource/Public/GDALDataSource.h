@@ -4,6 +4,21 @@
 #include "GISDataSource.h"
 #include "GDALDataSource.generated.h"
 
+// The resampling kernels that can be used when warping datasets to a common target grid
+UENUM(BlueprintType)
+enum class EGDALResamplingKernel : uint8
+{
+	Nearest      UMETA(DisplayName = "Nearest Neighbour"),
+	Bilinear     UMETA(DisplayName = "Bilinear"),
+	Cubic        UMETA(DisplayName = "Cubic"),
+	CubicSpline  UMETA(DisplayName = "Cubic Spline"),
+	Lanczos      UMETA(DisplayName = "Lanczos"),
+	Average      UMETA(DisplayName = "Average"),
+};
+
+struct FGDALRetrievalRequest;
+struct FGDALRetrievalState;
+
 UCLASS(Blueprintable)
 class GDALDATASOURCE_API UGDALDataSource : public UObject, public IGISDataSource
 {
@@ -11,17 +26,85 @@ class GDALDATASOURCE_API UGDALDataSource : public UObject, public IGISDataSource
 	
 	public:
 		
-		// Attempts to retrieve the GIS data from the specified heightmap and RGB datasets
+		// Attempts to retrieve the GIS data from the specified heightmap and RGB datasets on a worker thread
+		// (Multiple retrievals may be in flight at once, and the delegates are always invoked on the game thread)
 		virtual void RetrieveData(FGISDataSourceDelegate OnSuccess, FGISDataSourceDelegate OnFailure);
 		
+		// Cancels all in-flight retrievals
+		virtual void CancelRetrieval() override;
+		
+		// Returns the average progress of all in-flight retrievals
+		virtual float GetRetrievalProgress() const override;
+		
+		// Estimates the raster dimensions, download size, memory usage and duration of the retrieval from the metadata of the datasets
+		// (Only the dataset headers are read, so no raster data is fetched even for remote datasets, but planning blocks the calling
+		// thread while the headers are opened, which takes a network round trip for remote datasets)
+		virtual FGISRetrievalPlan PlanRetrieval() const override;
+		
 		// The path to the GDAL raster dataset containing the heightmap data
+		// (Remote cloud-optimised GeoTIFFs can be specified using http(s)://, s3://, gs:// or az:// URLs or GDAL /vsi paths)
 		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
 		FString HeightmapDataset;
 		
-		// The path to the GDAL raster dataset containing the RGB data
+		// The path to the GDAL raster dataset containing the RGB data (which supports the same remote paths as the heightmap)
 		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
 		FString RGBDataset;
 		
+		// The raster data to retrieve (the dataset for any channel that is not retrieved is never opened and may be left empty)
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		EGISDataChannels Channels = EGISDataChannels::HeightAndColor;
+		
+		// Specifies whether only the data within the requested extent should be read from the datasets
+		// (For cloud-optimised GeoTIFFs this means only the internal tiles covering the extent are fetched)
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		bool bRestrictToExtent = false;
+		
+		// The upper-left corner of the requested extent, in the projected coordinate system of the heightmap dataset
+		// (or of the RGB dataset when only colour data is retrieved)
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		FVector2D ExtentUpperLeft;
+		
+		// The lower-right corner of the requested extent, in the projected coordinate system of the heightmap dataset
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		FVector2D ExtentLowerRight;
+		
+		// The overview level to read from each dataset (-1 reads the full resolution data, 0 reads the first overview, etc.)
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		int32 OverviewLevel = -1;
+		
+		// The minimum size in megabytes of GDAL's raster block cache when reading from remote datasets
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		int32 RemoteBlockCacheMB = 512;
+		
+		// The projected coordinate system that both datasets will be warped to, in any form accepted by gdalwarp's -t_srs option
+		// (Leave empty to use the projected coordinate system of the heightmap dataset)
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		FString TargetProjection;
+		
+		// Specifies whether nodata holes in the heightmap should be filled by interpolation during retrieval
+		// (If disabled then the nodata value is passed through so that holes are filled during landscape generation)
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		bool bFillNoData = true;
+		
+		// The resampling kernel used when the heightmap dataset needs to be warped to the target grid
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		EGDALResamplingKernel HeightmapResampling = EGDALResamplingKernel::Bilinear;
+		
+		// The resampling kernel used when the RGB dataset needs to be warped to the target grid
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		EGDALResamplingKernel RGBResampling = EGDALResamplingKernel::Cubic;
+		
+		// The number of worker threads used by the GDAL warper (zero uses all available CPU cores)
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		int32 WarpThreads = 0;
+		
+		// The amount of memory in megabytes that the GDAL warper may use for each processing chunk
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		int32 WarpChunkMemoryMB = 256;
+		
 	private:
-		FString RetrieveDataInternal(FGISData& data);
+		static FString RetrieveDataInternal(const FGDALRetrievalRequest& request, FGDALRetrievalState& state, FGISData& data);
+		
+		// The state of each in-flight retrieval
+		TArray<TSharedRef<FGDALRetrievalState, ESPMode::ThreadSafe>> ActiveRetrievals;
 };
@@ -24,6 +24,8 @@ public class LandscapeGenEditor : ModuleRules
 				"Landscape",
 				"Foliage",
 				"UnrealEd",
+				"Json",
+				"JsonUtilities",
 				"RHI",
 				"RenderCore",
 				"UnrealGDAL",
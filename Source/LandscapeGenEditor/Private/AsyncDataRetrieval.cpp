@@ -8,14 +8,88 @@ UAsyncDataRetrieval* UAsyncDataRetrieval::RetrieveDataFromSource(const TScriptIn
 }
 
 void UAsyncDataRetrieval::Activate() {
-	this->DataSource->RetrieveData(this->OnSuccess, this->OnFailure);
+	// Keep the action (and by extension the data source) alive until retrieval has finished
+	AddToRoot();
+	this->bRunning = true;
+	
+	FGISDataSourceDelegate InternalOnSuccess;
+	FGISDataSourceDelegate InternalOnFailure;
+	InternalOnSuccess.AddDynamic(this, &UAsyncDataRetrieval::HandleSuccess);
+	InternalOnFailure.AddDynamic(this, &UAsyncDataRetrieval::HandleFailure);
+	this->DataSource->RetrieveData(InternalOnSuccess, InternalOnFailure);
 }
 
-UAsyncDataRetrieval::UAsyncDataRetrieval(const FObjectInitializer& ObjectInitializer)
-	: Super(ObjectInitializer)
+void UAsyncDataRetrieval::SetReadyToDestroy()
 {
-	if ( HasAnyFlags(RF_ClassDefaultObject) == false )
+	if (this->bFinished) {
+		return;
+	}
+	
+	// Abort any in-flight retrieval so the data source releases its requests and buffers
+	if (this->bRunning && this->DataSource)
 	{
-		AddToRoot();
+		this->DataSource->CancelRetrieval();
+		this->bRunning = false;
+	}
+	
+	this->bFinished = true;
+	this->DataSource = nullptr;
+	this->OnSuccess.Clear();
+	this->OnFailure.Clear();
+	
+	Super::SetReadyToDestroy();
+	RemoveFromRoot();
+}
+
+void UAsyncDataRetrieval::Cancel()
+{
+	if (this->bRunning == false) {
+		return;
 	}
-}
\ No newline at end of file
+	
+	this->DataSource->CancelRetrieval();
+	this->bRunning = false;
+	
+	this->OnFailure.Broadcast(TEXT("Data retrieval was cancelled"), FGISData());
+	this->SetReadyToDestroy();
+}
+
+float UAsyncDataRetrieval::GetProgress() const
+{
+	if (this->bRunning && this->DataSource) {
+		return this->DataSource->GetRetrievalProgress();
+	}
+	
+	return (this->bFinished ? 1.0f : 0.0f);
+}
+
+bool UAsyncDataRetrieval::IsRunning() const {
+	return this->bRunning;
+}
+
+void UAsyncDataRetrieval::HandleSuccess(const FString& Error, const FGISData& Data)
+{
+	if (this->bRunning == false) {
+		return;
+	}
+	
+	this->bRunning = false;
+	this->OnSuccess.Broadcast(Error, Data);
+	this->SetReadyToDestroy();
+}
+
+void UAsyncDataRetrieval::HandleFailure(const FString& Error, const FGISData& Data)
+{
+	if (this->bRunning == false) {
+		return;
+	}
+	
+	this->bRunning = false;
+	this->OnFailure.Broadcast(Error, Data);
+	this->SetReadyToDestroy();
+}
+
+UAsyncDataRetrieval::UAsyncDataRetrieval(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
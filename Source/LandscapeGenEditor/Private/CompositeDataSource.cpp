@@ -0,0 +1,286 @@
+#include "CompositeDataSource.h"
+#include "Async/Async.h"
+#include "CoordinateSystemRegistry.h"
+#include "GDALHelpers.h"
+#include "LandscapeGenRuntime.h"
+#include "RasterBuffers.h"
+
+namespace
+{
+	// Warps the colour data to the projected coordinate system and extents of the heightmap data, storing the result in the heightmap data
+	FString AlignColorData(FGISData& heightData, FGISData& colorData)
+	{
+		// Retrieve the projected corner coordinates for both sets of data
+		FVector2D heightUpperLeft;
+		FVector2D heightLowerRight;
+		if (heightData.GetProjectedCorners(heightUpperLeft, heightLowerRight) == false) {
+			return TEXT("Failed to compute the projected corner coordinates of the heightmap data");
+		}
+		
+		FVector2D colorUpperLeft;
+		FVector2D colorLowerRight;
+		if (colorData.GetProjectedCorners(colorUpperLeft, colorLowerRight) == false) {
+			return TEXT("Failed to compute the projected corner coordinates of the colour data");
+		}
+		
+		// Only 4-channel colour data is supported, since that is what the landscape generation system consumes
+		if (colorData.ColorBuffer.Num() != (int64)colorData.ColorBufferX * colorData.ColorBufferY * 4) {
+			return TEXT("Colour data must contain 4 channels");
+		}
+		
+		// If the colour data already shares the heightmap's grid then it can be used as-is
+		bool sameProjection = CoordinateSystemRegistry::IsSameCoordinateSystem(heightData.ProjectionWKT, colorData.ProjectionWKT);
+		if (sameProjection && heightUpperLeft.Equals(colorUpperLeft) && heightLowerRight.Equals(colorLowerRight))
+		{
+			heightData.ColorBuffer = MoveTemp(colorData.ColorBuffer);
+			heightData.ColorBufferX = colorData.ColorBufferX;
+			heightData.ColorBufferY = colorData.ColorBufferY;
+			heightData.PixelFormat = colorData.PixelFormat;
+			return TEXT("");
+		}
+		
+		// Wrap the colour data in a GDAL dataset and attach its geospatial metadata
+		FLandscapeGenRuntimeModule::EnsureGDALInitialized();
+		mergetiff::RasterData<uint8> colorWrapper(colorData.ColorBuffer.GetData(), 4, colorData.ColorBufferY, colorData.ColorBufferX, true);
+		GDALDatasetRef colorDataset = mergetiff::DatasetManagement::datasetFromRaster(colorWrapper);
+		if (!colorDataset || colorDataset->SetProjection(TCHAR_TO_UTF8(*colorData.ProjectionWKT)) != CE_None || !GDALHelpers::SetRasterCorners(colorDataset, colorUpperLeft, colorLowerRight)) {
+			return TEXT("Failed to attach geospatial metadata to the colour data");
+		}
+		
+		TArray<FString> options = {
+			TEXT("-of"),
+			TEXT("MEM"),
+			TEXT("-r"),
+			TEXT("cubic"),
+			TEXT("-multi"),
+			TEXT("-wo"),
+			TEXT("NUM_THREADS=ALL_CPUS"),
+			TEXT("-t_srs"),
+			heightData.ProjectionWKT,
+			TEXT("-te"),
+			FString::Printf(TEXT("%lf"), FMath::Min(heightUpperLeft.X, heightLowerRight.X)),
+			FString::Printf(TEXT("%lf"), FMath::Min(heightUpperLeft.Y, heightLowerRight.Y)),
+			FString::Printf(TEXT("%lf"), FMath::Max(heightUpperLeft.X, heightLowerRight.X)),
+			FString::Printf(TEXT("%lf"), FMath::Max(heightUpperLeft.Y, heightLowerRight.Y))
+		};
+		
+		// If the colour data is already in the heightmap's projection then preserve its native resolution, otherwise let the warper
+		// select a resolution that approximately preserves the number of source pixels
+		if (sameProjection)
+		{
+			FVector2D resolution = (colorLowerRight - colorUpperLeft).GetAbs() / FVector2D(colorData.ColorBufferX, colorData.ColorBufferY);
+			options.Append({
+				TEXT("-tr"),
+				FString::Printf(TEXT("%lf"), resolution.X),
+				FString::Printf(TEXT("%lf"), resolution.Y)
+			});
+		}
+		
+		GDALDatasetRef warped = GDALHelpers::Warp(colorDataset, GDALHelpers::UniqueMemFilename(), GDALHelpers::ParseGDALWarpOptions(options));
+		if (!warped) {
+			return TEXT("Failed to warp the colour data to the projected coordinate system and extents of the heightmap data");
+		}
+		
+		// Read the warped colour data, preserving the original channel order (areas outside the colour data's coverage are left transparent)
+		heightData.ColorBufferX = warped->GetRasterXSize();
+		heightData.ColorBufferY = warped->GetRasterYSize();
+		heightData.PixelFormat = colorData.PixelFormat;
+		mergetiff::RasterData<uint8> alignedData = RasterBuffers::AllocateAndWrap<uint8>(heightData.ColorBuffer, 4, heightData.ColorBufferY, heightData.ColorBufferX, 0);
+		if (mergetiff::RasterIO::readDataset(warped, alignedData, {1,2,3,4}) == false) {
+			return TEXT("Failed to read the aligned colour data");
+		}
+		
+		return TEXT("");
+	}
+}
+
+void UCompositeDataSource::RetrieveData(FGISDataSourceDelegate OnSuccess, FGISDataSourceDelegate OnFailure)
+{
+	if (!this->HeightSource || !this->ColorSource)
+	{
+		OnFailure.Broadcast(TEXT("Both a height source and a colour source must be specified"), FGISData());
+		return;
+	}
+	
+	if (this->bRunning)
+	{
+		OnFailure.Broadcast(TEXT("A retrieval is already in progress for this data source"), FGISData());
+		return;
+	}
+	
+	this->OnSuccess = OnSuccess;
+	this->OnFailure = OnFailure;
+	this->HeightData = FGISData();
+	this->ColorData = FGISData();
+	this->bHeightReceived = false;
+	this->bColorReceived = false;
+	this->bRunning = true;
+	this->RetrievalID++;
+	
+	FGISDataSourceDelegate HeightOnSuccess;
+	FGISDataSourceDelegate HeightOnFailure;
+	HeightOnSuccess.AddDynamic(this, &UCompositeDataSource::HandleHeightSuccess);
+	HeightOnFailure.AddDynamic(this, &UCompositeDataSource::HandleHeightFailure);
+	
+	FGISDataSourceDelegate ColorOnSuccess;
+	FGISDataSourceDelegate ColorOnFailure;
+	ColorOnSuccess.AddDynamic(this, &UCompositeDataSource::HandleColorSuccess);
+	ColorOnFailure.AddDynamic(this, &UCompositeDataSource::HandleColorFailure);
+	
+	// Start both retrievals so that they run concurrently (the height source may fail synchronously, in which case we stop there)
+	this->HeightSource->RetrieveData(HeightOnSuccess, HeightOnFailure);
+	if (this->bRunning) {
+		this->ColorSource->RetrieveData(ColorOnSuccess, ColorOnFailure);
+	}
+}
+
+void UCompositeDataSource::CancelRetrieval()
+{
+	if (this->bRunning == false) {
+		return;
+	}
+	
+	if (!this->bHeightReceived && this->HeightSource) {
+		this->HeightSource->CancelRetrieval();
+	}
+	
+	if (!this->bColorReceived && this->ColorSource) {
+		this->ColorSource->CancelRetrieval();
+	}
+	
+	this->bRunning = false;
+	this->HeightData = FGISData();
+	this->ColorData = FGISData();
+}
+
+float UCompositeDataSource::GetRetrievalProgress() const
+{
+	if (this->bRunning == false) {
+		return 0.0f;
+	}
+	
+	float heightProgress = (this->bHeightReceived ? 1.0f : this->HeightSource->GetRetrievalProgress());
+	float colorProgress = (this->bColorReceived ? 1.0f : this->ColorSource->GetRetrievalProgress());
+	return (heightProgress + colorProgress) * 0.5f;
+}
+
+FGISRetrievalPlan UCompositeDataSource::PlanRetrieval() const
+{
+	FGISRetrievalPlan plan;
+	if (!this->HeightSource || !this->ColorSource)
+	{
+		plan.Error = TEXT("Both a height source and a colour source must be specified");
+		return plan;
+	}
+	
+	FGISRetrievalPlan heightPlan = this->HeightSource->PlanRetrieval();
+	FGISRetrievalPlan colorPlan = this->ColorSource->PlanRetrieval();
+	if (!heightPlan.Error.IsEmpty() || !colorPlan.Error.IsEmpty())
+	{
+		plan.Error = !heightPlan.Error.IsEmpty() ? heightPlan.Error : colorPlan.Error;
+		return plan;
+	}
+	
+	// Both underlying sources retrieve all of their channels, even though only one channel of each is kept
+	plan.NumTiles = heightPlan.NumTiles + colorPlan.NumTiles;
+	plan.NumRequests = heightPlan.NumRequests + colorPlan.NumRequests;
+	plan.ExpectedDownloadBytes = heightPlan.ExpectedDownloadBytes + colorPlan.ExpectedDownloadBytes;
+	plan.HeightSizeX = heightPlan.HeightSizeX;
+	plan.HeightSizeY = heightPlan.HeightSizeY;
+	plan.ColorSizeX = colorPlan.ColorSizeX;
+	plan.ColorSizeY = colorPlan.ColorSizeY;
+	plan.HeightFormat = heightPlan.HeightFormat;
+	plan.bHeightMayHaveNoData = heightPlan.bHeightMayHaveNoData;
+	
+	// Both retrievals hold their data until they have completed, and aligning the colour data produces a warped copy of it
+	// (The aligned colour data is assumed to have approximately the same number of pixels as the colour data that was retrieved)
+	plan.PeakMemoryBytes = heightPlan.PeakMemoryBytes + colorPlan.PeakMemoryBytes + (int64)colorPlan.ColorSizeX * colorPlan.ColorSizeY * 4;
+	plan.EstimatedSeconds = FMath::Max(heightPlan.EstimatedSeconds, colorPlan.EstimatedSeconds);
+	return plan;
+}
+
+void UCompositeDataSource::HandleHeightSuccess(const FString& Error, const FGISData& Data)
+{
+	if (this->bRunning == false || this->bHeightReceived) {
+		return;
+	}
+	
+	this->HeightData = Data;
+	this->bHeightReceived = true;
+	this->CombineResults();
+}
+
+void UCompositeDataSource::HandleHeightFailure(const FString& Error, const FGISData& Data)
+{
+	if (this->bRunning == false || this->bHeightReceived) {
+		return;
+	}
+	
+	this->bHeightReceived = true;
+	this->FailRetrieval(FString::Printf(TEXT("Height source failed: %s"), *Error));
+}
+
+void UCompositeDataSource::HandleColorSuccess(const FString& Error, const FGISData& Data)
+{
+	if (this->bRunning == false || this->bColorReceived) {
+		return;
+	}
+	
+	this->ColorData = Data;
+	this->bColorReceived = true;
+	this->CombineResults();
+}
+
+void UCompositeDataSource::HandleColorFailure(const FString& Error, const FGISData& Data)
+{
+	if (this->bRunning == false || this->bColorReceived) {
+		return;
+	}
+	
+	this->bColorReceived = true;
+	this->FailRetrieval(FString::Printf(TEXT("Colour source failed: %s"), *Error));
+}
+
+void UCompositeDataSource::FailRetrieval(const FString& Error)
+{
+	this->CancelRetrieval();
+	this->OnFailure.Broadcast(Error, FGISData());
+}
+
+void UCompositeDataSource::CombineResults()
+{
+	if (!this->bHeightReceived || !this->bColorReceived) {
+		return;
+	}
+	
+	// Hand the retrieved data over to a worker thread, since warping the colour data can take a considerable amount of time
+	TSharedRef<FGISData, ESPMode::ThreadSafe> heightData = MakeShared<FGISData, ESPMode::ThreadSafe>(MoveTemp(this->HeightData));
+	TSharedRef<FGISData, ESPMode::ThreadSafe> colorData = MakeShared<FGISData, ESPMode::ThreadSafe>(MoveTemp(this->ColorData));
+	this->HeightData = FGISData();
+	this->ColorData = FGISData();
+	
+	TWeakObjectPtr<UCompositeDataSource> weakThis(this);
+	int32 retrievalID = this->RetrievalID;
+	Async(EAsyncExecution::ThreadPool, [weakThis, retrievalID, heightData, colorData]()
+	{
+		FString error = AlignColorData(heightData.Get(), colorData.Get());
+		colorData.Get() = FGISData();
+		
+		// Notify the appropriate delegate on the game thread, unless the retrieval was cancelled in the meantime
+		AsyncTask(ENamedThreads::GameThread, [weakThis, retrievalID, heightData, error]()
+		{
+			UCompositeDataSource* source = weakThis.Get();
+			if (source == nullptr || source->bRunning == false || source->RetrievalID != retrievalID) {
+				return;
+			}
+			
+			source->bRunning = false;
+			if (error.IsEmpty()) {
+				source->OnSuccess.Broadcast(error, heightData.Get());
+			}
+			else {
+				source->OnFailure.Broadcast(error, FGISData());
+			}
+		});
+	});
+}
@@ -0,0 +1,116 @@
+#include "CoordinateSystemRegistry.h"
+#include "GDALHeaders.h"
+#include "GDALHelpers.h"
+#include "HAL/PlatformTLS.h"
+#include "LandscapeGenRuntime.h"
+#include "Misc/ScopeLock.h"
+
+#include <memory>
+
+namespace
+{
+	struct FSpatialReferenceDeleter
+	{
+		void operator()(OGRSpatialReference* Reference) const {
+			OGRSpatialReference::DestroySpatialReference(Reference);
+		}
+	};
+	
+	typedef std::unique_ptr<OGRSpatialReference, FSpatialReferenceDeleter> FSpatialReferencePtr;
+	
+	// Identifies the transformation between two coordinate systems that is owned by a given thread
+	typedef TTuple<FString, FString, uint32> FTransformationKey;
+	
+	// The cached state of the registry (the spatial references are not thread-safe, so they are only used while holding the lock)
+	struct FRegistryState
+	{
+		FCriticalSection Lock;
+		TMap<int32, FString> WKTForEPSGCode;
+		TMap<FString, FSpatialReferencePtr> SpatialReferences;
+		TMap<FTransformationKey, TUniquePtr<OGRCoordinateTransformationRef>> Transformations;
+	};
+	
+	FRegistryState& GetState()
+	{
+		static FRegistryState State;
+		return State;
+	}
+	
+	// Retrieves the cached spatial reference for a coordinate system definition, parsing it if it is not already cached
+	// (Must be called while holding the lock, and returns null if the definition is invalid)
+	OGRSpatialReference* FindOrParseSpatialReference(FRegistryState& State, const FString& Definition)
+	{
+		if (FSpatialReferencePtr* Existing = State.SpatialReferences.Find(Definition)) {
+			return Existing->get();
+		}
+		
+		FLandscapeGenRuntimeModule::EnsureGDALInitialized();
+		FSpatialReferencePtr Reference(new OGRSpatialReference());
+		if (Reference->SetFromUserInput(TCHAR_TO_UTF8(*Definition)) != OGRERR_NONE) {
+			Reference.reset();
+		}
+		
+		// Invalid definitions are cached as well, so that they are not parsed repeatedly
+		return State.SpatialReferences.Add(Definition, MoveTemp(Reference)).get();
+	}
+}
+
+FString CoordinateSystemRegistry::GetWKT(int32 EPSGCode)
+{
+	FRegistryState& State = GetState();
+	FScopeLock ScopedLock(&State.Lock);
+	if (FString* Existing = State.WKTForEPSGCode.Find(EPSGCode)) {
+		return *Existing;
+	}
+	
+	FLandscapeGenRuntimeModule::EnsureGDALInitialized();
+	return State.WKTForEPSGCode.Add(EPSGCode, GDALHelpers::WktFromEPSG(EPSGCode));
+}
+
+bool CoordinateSystemRegistry::IsSameCoordinateSystem(const FString& First, const FString& Second)
+{
+	if (First.Equals(Second)) {
+		return true;
+	}
+	
+	FRegistryState& State = GetState();
+	FScopeLock ScopedLock(&State.Lock);
+	OGRSpatialReference* FirstReference = FindOrParseSpatialReference(State, First);
+	OGRSpatialReference* SecondReference = FindOrParseSpatialReference(State, Second);
+	return FirstReference != nullptr && SecondReference != nullptr && FirstReference->IsSame(SecondReference) != 0;
+}
+
+bool CoordinateSystemRegistry::TransformCoordinate(const FString& Source, const FString& Target, const FVector& Coordinate, FVector& OutTransformed)
+{
+	// Retrieve the calling thread's transformation, creating it if this is the first time the thread has requested it
+	OGRCoordinateTransformationRef* Transformation = nullptr;
+	{
+		FRegistryState& State = GetState();
+		FScopeLock ScopedLock(&State.Lock);
+		FTransformationKey Key(Source, Target, FPlatformTLS::GetCurrentThreadId());
+		if (TUniquePtr<OGRCoordinateTransformationRef>* Existing = State.Transformations.Find(Key)) {
+			Transformation = Existing->Get();
+		}
+		else
+		{
+			OGRSpatialReference* SourceReference = FindOrParseSpatialReference(State, Source);
+			OGRSpatialReference* TargetReference = FindOrParseSpatialReference(State, Target);
+			OGRCoordinateTransformation* Created = (SourceReference != nullptr && TargetReference != nullptr) ?
+				OGRCreateCoordinateTransformation(SourceReference, TargetReference) : nullptr;
+			
+			Transformation = State.Transformations.Add(Key, MakeUnique<OGRCoordinateTransformationRef>(Created)).Get();
+		}
+	}
+	
+	// Cached transformations are never removed while the registry is in use, so the transformation remains valid outside of the lock
+	return *Transformation && GDALHelpers::TransformCoordinate(*Transformation, Coordinate, OutTransformed);
+}
+
+void CoordinateSystemRegistry::Reset()
+{
+	FRegistryState& State = GetState();
+	FScopeLock ScopedLock(&State.Lock);
+	State.Transformations.Empty();
+	State.SpatialReferences.Empty();
+	State.WKTForEPSGCode.Empty();
+}
@@ -0,0 +1,214 @@
+#include "FoliageScatterBPFL.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "FoliageType.h"
+#include "InstancedFoliage.h"
+#include "InstancedFoliageActor.h"
+#include "Landscape.h"
+
+#include "GeodesicMeasurement.h"
+#include "LandscapeSurface.h"
+#include "RasterAlignment.h"
+
+namespace
+{
+	// The number of raster rows processed by each worker thread task
+	const int32 RowsPerTask = 64;
+	
+	// Computes the transform of a single foliage instance at the specified projected coordinates, respecting the settings of the
+	// foliage type (returns false if the location does not satisfy the foliage type's slope and height constraints)
+	bool PlaceInstance(const FLandscapeSurface& Surface, const UFoliageType* FoliageType, double X, double Y, FRandomStream& Random, FFoliageInstance& Instance)
+	{
+		// Draw every random value before testing the candidate and regardless of the foliage type's settings, so that placement is
+		// stable when those settings change (including the slope and height limits that determine which candidates are rejected)
+		float Yaw = Random.FRandRange(0.0f, 360.0f);
+		float ScaleX = FoliageType->ScaleX.Interpolate(Random.FRand());
+		float ScaleY = FoliageType->ScaleY.Interpolate(Random.FRand());
+		float ScaleZ = FoliageType->ScaleZ.Interpolate(Random.FRand());
+		float ZOffset = FoliageType->ZOffset.Interpolate(Random.FRand());
+		
+		FVector Normal = Surface.GetNormal(X, Y);
+		float Slope = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Normal.Z, -1.0f, 1.0f)));
+		Instance.Location = Surface.ProjectedToWorld(X, Y);
+		if (!FoliageType->GroundSlopeAngle.Contains(Slope) || !FoliageType->Height.Contains(Instance.Location.Z)) {
+			return false;
+		}
+		
+		Instance.Rotation = FRotator(0.0f, FoliageType->RandomYaw ? Yaw : 0.0f, 0.0f);
+		switch (FoliageType->Scaling)
+		{
+			case EFoliageScaling::Free:
+				Instance.DrawScale3D = FVector(ScaleX, ScaleY, ScaleZ);
+				break;
+			
+			case EFoliageScaling::LockXY:
+				Instance.DrawScale3D = FVector(ScaleX, ScaleX, ScaleZ);
+				break;
+			
+			case EFoliageScaling::LockXZ:
+				Instance.DrawScale3D = FVector(ScaleX, ScaleY, ScaleX);
+				break;
+			
+			case EFoliageScaling::LockYZ:
+				Instance.DrawScale3D = FVector(ScaleX, ScaleY, ScaleY);
+				break;
+			
+			default:
+				Instance.DrawScale3D = FVector(ScaleX);
+				break;
+		}
+		
+		if (FoliageType->AlignToNormal) {
+			Instance.AlignToNormal(Normal, FoliageType->AlignMaxAngle);
+		}
+		
+		Instance.ZOffset = ZOffset;
+		Instance.Location += Instance.Rotation.RotateVector(FVector(0.0f, 0.0f, ZOffset));
+		return true;
+	}
+}
+
+int32 UFoliageScatterBPFL::ScatterFoliageFromLandCover(const UObject* WorldContext, ALandscape* Landscape, const FLandCoverScatterOptions& Options)
+{
+	// Read the landscape's heightmap so that the worker threads can sample ground heights without performing traces
+	FLandscapeSurface Surface;
+	if (Surface.ReadFromLandscape(Landscape) == false)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Foliage scattering requires a landscape generated from GIS data"));
+		return -1;
+	}
+	
+	// Group the rules by land cover class
+	TMap<int32, TArray<int32>> RulesForClass;
+	for (int32 RuleIndex = 0; RuleIndex < Options.Rules.Num(); ++RuleIndex)
+	{
+		if (Options.Rules[RuleIndex].FoliageType != nullptr && Options.Rules[RuleIndex].DensityPerHectare > 0.0f) {
+			RulesForClass.FindOrAdd(Options.Rules[RuleIndex].ClassValue).Add(RuleIndex);
+		}
+	}
+	
+	// Align the classification raster (and density map, if any) with the landscape
+	TArray64<int32> Classes;
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+	FString Error = RasterAlignment::ReadAlignedBand<int32>(Options.ClassificationRasterPath, Surface.GetWKT(), Surface.GetUpperLeft(), Surface.GetLowerRight(), TEXT("near"), Classes, SizeX, SizeY);
+	if (!Error.IsEmpty())
+	{
+		UE_LOG(LogTemp, Log, TEXT("%s"), *Error);
+		return -1;
+	}
+	
+	TArray64<float> Density;
+	if (!Options.DensityMapPath.IsEmpty())
+	{
+		Error = RasterAlignment::ReadAlignedBand<float>(Options.DensityMapPath, Surface.GetWKT(), Surface.GetUpperLeft(), Surface.GetLowerRight(), TEXT("bilinear"), Density, SizeX, SizeY);
+		if (!Error.IsEmpty())
+		{
+			UE_LOG(LogTemp, Log, TEXT("%s"), *Error);
+			return -1;
+		}
+	}
+	
+	// Compute the size of each raster cell in projected units, and the ground area in hectares of the cells in each row
+	// (Projected units are not ground metres for every projection, so the scale of the projection is measured across each row,
+	// assuming that it is locally conformal as Web Mercator and UTM are. Web Mercator inflates areas by the inverse square of the
+	// cosine of the latitude, for example. Rows whose scale cannot be measured fall back to the projected area)
+	FVector2D CellSize = (Surface.GetLowerRight() - Surface.GetUpperLeft()) / FVector2D(SizeX, SizeY);
+	double ProjectedWidth = FMath::Abs(Surface.GetLowerRight().X - Surface.GetUpperLeft().X);
+	FGeodesicMeasurement Measurement(Surface.GetWKT());
+	TArray<float> RowCellHectares;
+	RowCellHectares.SetNumUninitialized(SizeY);
+	for (int32 Row = 0; Row < SizeY; ++Row)
+	{
+		double Y = Surface.GetUpperLeft().Y + (Row + 0.5) * CellSize.Y;
+		double GroundWidth;
+		bool bMeasured = (ProjectedWidth > 0.0 && Measurement.MeasureDistance(Surface.GetUpperLeft().X, Y, Surface.GetLowerRight().X, Y, GroundWidth));
+		double Scale = bMeasured ? (GroundWidth / ProjectedWidth) : 1.0;
+		RowCellHectares[Row] = FMath::Abs(CellSize.X * CellSize.Y) * Scale * Scale / 10000.0;
+	}
+	
+	// Compute the instance transforms for blocks of rows in parallel, with a random stream per block so the result is deterministic
+	int32 NumTasks = FMath::DivideAndRoundUp(SizeY, RowsPerTask);
+	TArray<TArray<TArray<FFoliageInstance>>> TaskInstances;
+	TaskInstances.SetNum(NumTasks);
+	ParallelFor(NumTasks, [&](int32 TaskIndex)
+	{
+		TArray<TArray<FFoliageInstance>>& Instances = TaskInstances[TaskIndex];
+		Instances.SetNum(Options.Rules.Num());
+		FRandomStream Random(HashCombine(GetTypeHash(Options.Seed), GetTypeHash(TaskIndex)));
+		
+		int32 EndRow = FMath::Min((TaskIndex + 1) * RowsPerTask, SizeY);
+		for (int32 Row = TaskIndex * RowsPerTask; Row < EndRow; ++Row)
+		{
+			float CellHectares = RowCellHectares[Row];
+			for (int32 Col = 0; Col < SizeX; ++Col)
+			{
+				int64 Index = (int64)Row * SizeX + Col;
+				const TArray<int32>* Rules = RulesForClass.Find(Classes[Index]);
+				if (Rules == nullptr) {
+					continue;
+				}
+				
+				float DensityScale = (Density.Num() > 0) ? FMath::Clamp(Density[Index], 0.0f, 1.0f) : 1.0f;
+				for (int32 RuleIndex : *Rules)
+				{
+					// Place the whole number of expected instances, plus one more with a probability equal to the fractional remainder
+					const FLandCoverFoliageRule& Rule = Options.Rules[RuleIndex];
+					float Expected = Rule.DensityPerHectare * CellHectares * DensityScale;
+					int32 NumInstances = FMath::FloorToInt(Expected) + ((Random.FRand() < FMath::Frac(Expected)) ? 1 : 0);
+					for (int32 Instance = 0; Instance < NumInstances; ++Instance)
+					{
+						double X = Surface.GetUpperLeft().X + (Col + Random.FRand()) * CellSize.X;
+						double Y = Surface.GetUpperLeft().Y + (Row + Random.FRand()) * CellSize.Y;
+						FFoliageInstance& Placed = Instances[RuleIndex].AddDefaulted_GetRef();
+						if (PlaceInstance(Surface, Rule.FoliageType, X, Y, Random, Placed) == false) {
+							Instances[RuleIndex].Pop(false);
+						}
+					}
+				}
+			}
+		}
+	});
+	
+	// Release the rasters before committing, since the foliage system will allocate its own copies of the instance data
+	Classes.Empty();
+	Density.Empty();
+	
+	// Commit the instances to the foliage system in large batches, which avoids rebuilding the foliage cluster trees for each instance
+	AInstancedFoliageActor* FoliageActor = AInstancedFoliageActor::GetInstancedFoliageActorForCurrentLevel(WorldContext->GetWorld(), true);
+	int32 InstancesPerCommit = FMath::Max(Options.InstancesPerCommit, 1);
+	int32 NumAdded = 0;
+	for (int32 RuleIndex = 0; RuleIndex < Options.Rules.Num(); ++RuleIndex)
+	{
+		if (Options.Rules[RuleIndex].FoliageType == nullptr) {
+			continue;
+		}
+		
+		FFoliageInfo* FoliageInfo = nullptr;
+		UFoliageType* FoliageType = FoliageActor->AddFoliageType(Options.Rules[RuleIndex].FoliageType, &FoliageInfo);
+		
+		TArray<const FFoliageInstance*> Batch;
+		Batch.Reserve(InstancesPerCommit);
+		for (const TArray<TArray<FFoliageInstance>>& Instances : TaskInstances)
+		{
+			for (const FFoliageInstance& Instance : Instances[RuleIndex])
+			{
+				Batch.Add(&Instance);
+				if (Batch.Num() == InstancesPerCommit)
+				{
+					FoliageInfo->AddInstances(FoliageActor, FoliageType, Batch);
+					NumAdded += Batch.Num();
+					Batch.Reset();
+				}
+			}
+		}
+		
+		if (Batch.Num() > 0)
+		{
+			FoliageInfo->AddInstances(FoliageActor, FoliageType, Batch);
+			NumAdded += Batch.Num();
+		}
+	}
+	
+	return NumAdded;
+}
@@ -1 +1,62 @@
 #include "GISData.h"
+#include "Async/ParallelFor.h"
+#include "CoordinateSystemRegistry.h"
+#include "GDALHelpers.h"
+#include "MapProjection.h"
+
+bool FGISData::GetProjectedCorners(FVector2D& OutUpperLeft, FVector2D& OutLowerRight) const
+{
+	OutUpperLeft = this->UpperLeft;
+	OutLowerRight = this->LowerRight;
+	
+	if (this->CornerType == ECornerCoordinateType::LatLon)
+	{
+		// Use the built-in projections where possible, since they are considerably cheaper than creating a GDAL transformation
+		FMapProjection Projection = FMapProjection::FromWKT(this->ProjectionWKT);
+		if (Projection.IsBuiltIn())
+		{
+			return Projection.GeographicToProjected(this->UpperLeft, OutUpperLeft) &&
+				Projection.GeographicToProjected(this->LowerRight, OutLowerRight);
+		}
+		
+		// Prior to GDAL 3.0, coordinate transformations expect WGS84 coordinates to be in (lon,lat) format instead of (lat,lon)
+		// (See: https://gdal.org/tutorials/osr_api_tut.html#crs-and-axis-order)
+		#if GDAL_VERSION_NUM < GDAL_COMPUTE_VERSION(3,0,0)
+			OutUpperLeft = FVector2D(OutUpperLeft.Y, OutUpperLeft.X);
+			OutLowerRight = FVector2D(OutLowerRight.Y, OutLowerRight.X);
+		#endif
+		
+		FString WGS84_WKT = CoordinateSystemRegistry::GetWKT(4326);
+		FVector TempUL;
+		FVector TempLR;
+		if (!CoordinateSystemRegistry::TransformCoordinate(WGS84_WKT, this->ProjectionWKT, FVector(OutUpperLeft, 0), TempUL) ||
+			!CoordinateSystemRegistry::TransformCoordinate(WGS84_WKT, this->ProjectionWKT, FVector(OutLowerRight, 0), TempLR)) {
+			return false;
+		}
+		
+		OutUpperLeft = FVector2D(TempUL);
+		OutLowerRight = FVector2D(TempLR);
+	}
+	
+	return true;
+}
+
+void FGISData::DecodeHeights(TArray64<float>& OutHeights) const
+{
+	if (this->HeightFormat.IsCompact() == false)
+	{
+		OutHeights = this->HeightBuffer;
+		return;
+	}
+	
+	OutHeights.SetNumUninitialized(this->CompactHeightBuffer.Num());
+	const int64 SamplesPerTask = 1 << 18;
+	int32 NumTasks = (int32)FMath::DivideAndRoundUp<int64>(this->CompactHeightBuffer.Num(), SamplesPerTask);
+	ParallelFor(NumTasks, [&](int32 TaskIndex)
+	{
+		int64 End = FMath::Min(this->CompactHeightBuffer.Num(), (TaskIndex + 1) * SamplesPerTask);
+		for (int64 Index = TaskIndex * SamplesPerTask; Index < End; ++Index) {
+			OutHeights[Index] = this->HeightFormat.Decode(this->CompactHeightBuffer[Index]);
+		}
+	});
+}
@@ -0,0 +1,77 @@
+#include "GeneratedAssetCache.h"
+#include "AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
+#include "UObject/MetaData.h"
+#include "UObject/Package.h"
+
+namespace
+{
+	// The package metadata key that holds the content hash of a generated asset
+	const TCHAR* ContentHashKey = TEXT("GISContentHash");
+}
+
+const FString& GeneratedAssetCache::GetPackagePath()
+{
+	static const FString PackagePath = TEXT("/Game/GISLandscapeData/");
+	return PackagePath;
+}
+
+uint64 GeneratedAssetCache::HashBuffer(const uint8* Data, int64 NumBytes)
+{
+	// Hash each block of the buffer in parallel and then hash the resulting block hashes along with the buffer size
+	const int64 BytesPerTask = 16 * 1024 * 1024;
+	int32 NumTasks = (int32)FMath::DivideAndRoundUp<int64>(NumBytes, BytesPerTask);
+	TArray<uint64> BlockHashes;
+	BlockHashes.SetNumZeroed(NumTasks + 1);
+	BlockHashes[NumTasks] = (uint64)NumBytes;
+	ParallelFor(NumTasks, [&](int32 TaskIndex)
+	{
+		int64 Start = TaskIndex * BytesPerTask;
+		int64 End = FMath::Min(NumBytes, Start + BytesPerTask);
+		BlockHashes[TaskIndex] = CityHash64((const char*)(Data + Start), (uint32)(End - Start));
+	});
+	
+	return CityHash64((const char*)BlockHashes.GetData(), BlockHashes.Num() * sizeof(uint64));
+}
+
+uint64 GeneratedAssetCache::HashString(const FString& Value)
+{
+	FTCHARToUTF8 Converted(*Value);
+	return CityHash64(Converted.Get(), Converted.Length());
+}
+
+FString GeneratedAssetCache::FormatHash(uint64 First, uint64 Second)
+{
+	return FString::Printf(TEXT("%016llx"), CityHash128to64(Uint128_64(First, Second)));
+}
+
+FString GeneratedAssetCache::GetAssetName(const FString& Prefix, const FString& Hash)
+{
+	return FString::Printf(TEXT("%s_%s"), *Prefix, *Hash);
+}
+
+UObject* GeneratedAssetCache::FindAsset(const FString& AssetName, UClass* Class, const FString& Hash)
+{
+	// Consult the asset registry first so that we only attempt to load assets that actually exist
+	FString PackageName = GetPackagePath() + AssetName;
+	FString ObjectPath = FString::Printf(TEXT("%s.%s"), *PackageName, *AssetName);
+	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+	FAssetData AssetData = AssetRegistryModule.Get().GetAssetByObjectPath(FName(*ObjectPath));
+	if (!AssetData.IsValid() || AssetData.AssetClass != Class->GetFName()) {
+		return nullptr;
+	}
+	
+	// Verify that the asset's recorded hash matches, in case an asset with the same name was created by other means
+	UObject* Asset = AssetData.GetAsset();
+	if (Asset == nullptr || Asset->GetOutermost()->GetMetaData()->GetValue(Asset, ContentHashKey) != Hash) {
+		return nullptr;
+	}
+	
+	return Asset;
+}
+
+void GeneratedAssetCache::SetAssetHash(UObject* Asset, const FString& Hash)
+{
+	Asset->GetOutermost()->GetMetaData()->SetValue(Asset, ContentHashKey, *Hash);
+}
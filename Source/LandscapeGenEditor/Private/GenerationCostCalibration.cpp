@@ -0,0 +1,81 @@
+#include "GenerationCostCalibration.h"
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	// The number of observations after which the running averages become exponential moving averages, so that the statistics
+	// follow changes in network conditions and hardware
+	const int32 MaxAverageWeight = 20;
+	
+	FString GetCalibrationPath() {
+		return FPaths::ProjectSavedDir() / TEXT("LandscapeGen") / TEXT("CostCalibration.json");
+	}
+	
+	// Folds an observation into a running average that has the specified number of prior observations
+	float Accumulate(float Average, float Observation, int32 NumObservations) {
+		return Average + (Observation - Average) / (float)FMath::Min(NumObservations + 1, MaxAverageWeight);
+	}
+}
+
+FGenerationCostCalibration FGenerationCostCalibration::Load()
+{
+	FGenerationCostCalibration Calibration;
+	FString CalibrationString;
+	if (FFileHelper::LoadFileToString(CalibrationString, *GetCalibrationPath()))
+	{
+		if (FJsonObjectConverter::JsonObjectStringToUStruct(CalibrationString, &Calibration, 0, 0) == false) {
+			Calibration = FGenerationCostCalibration();
+		}
+	}
+	
+	return Calibration;
+}
+
+bool FGenerationCostCalibration::Save() const
+{
+	FString CalibrationString;
+	if (FJsonObjectConverter::UStructToJsonObjectString(*this, CalibrationString) == false) {
+		return false;
+	}
+	
+	return FFileHelper::SaveStringToFile(CalibrationString, *GetCalibrationPath());
+}
+
+void FGenerationCostCalibration::RecordRetrieval(int32 NumRequests, int64 DownloadedBytes, double Seconds)
+{
+	if (NumRequests <= 0 || DownloadedBytes <= 0 || Seconds <= 0.0) {
+		return;
+	}
+	
+	FGenerationCostCalibration Calibration = FGenerationCostCalibration::Load();
+	Calibration.AverageTileBytes = Accumulate(Calibration.AverageTileBytes, (float)((double)DownloadedBytes / NumRequests), Calibration.NumRetrievals);
+	Calibration.DownloadBytesPerSecond = Accumulate(Calibration.DownloadBytesPerSecond, (float)(DownloadedBytes / Seconds), Calibration.NumRetrievals);
+	Calibration.NumRetrievals++;
+	Calibration.Save();
+}
+
+void FGenerationCostCalibration::RecordGeneration(int64 NumSamples, double Seconds)
+{
+	if (NumSamples <= 0 || Seconds <= 0.0) {
+		return;
+	}
+	
+	FGenerationCostCalibration Calibration = FGenerationCostCalibration::Load();
+	Calibration.GenerationSecondsPerMegasample = Accumulate(Calibration.GenerationSecondsPerMegasample, (float)(Seconds / (NumSamples / 1000000.0)), Calibration.NumGenerations);
+	Calibration.NumGenerations++;
+	Calibration.Save();
+}
+
+int64 FGenerationCostCalibration::EstimateDownloadBytes(int32 NumRequests) const {
+	return (int64)((double)NumRequests * this->AverageTileBytes);
+}
+
+float FGenerationCostCalibration::EstimateDownloadSeconds(int64 DownloadBytes) const {
+	return (float)((double)DownloadBytes / FMath::Max(this->DownloadBytesPerSecond, 1.0f));
+}
+
+float FGenerationCostCalibration::EstimateGenerationSeconds(int64 NumSamples) const {
+	return (float)((NumSamples / 1000000.0) * this->GenerationSecondsPerMegasample);
+}
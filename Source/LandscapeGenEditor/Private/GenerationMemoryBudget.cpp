@@ -0,0 +1,119 @@
+#include "GenerationMemoryBudget.h"
+#include "HAL/PlatformMemory.h"
+
+namespace
+{
+	// Converts a number of bytes to megabytes for logging
+	double ToMB(int64 Bytes) {
+		return (double)Bytes / (1024.0 * 1024.0);
+	}
+}
+
+FGenerationMemoryBudget::FGenerationMemoryBudget(int32 BudgetMB, FLandscapeGenerationMemoryReport& OutReport) :
+	BudgetBytes((int64)FMath::Max(BudgetMB, 0) * 1024 * 1024), Report(OutReport)
+{
+	this->Report = FLandscapeGenerationMemoryReport();
+}
+
+FGenerationMemoryBudget::~FGenerationMemoryBudget()
+{
+	this->EndStage();
+	UE_LOG(LogTemp, Log, TEXT("Landscape generation peak memory usage: %.1lf MB"), ToMB(this->Report.PeakBytes));
+}
+
+bool FGenerationMemoryBudget::CheckStage(const FString& Stage, int64 EstimatedBytes)
+{
+	if (this->BudgetBytes == 0) {
+		return true;
+	}
+	
+	int64 UsedBytes = (int64)FPlatformMemory::GetStats().UsedPhysical;
+	if (UsedBytes + EstimatedBytes <= this->BudgetBytes) {
+		return true;
+	}
+	
+	this->Report.BudgetError = FString::Printf(
+		TEXT("Stage \"%s\" is estimated to allocate %.1lf MB, which would exceed the memory budget of %.1lf MB (%.1lf MB is already in use)"),
+		*Stage, ToMB(EstimatedBytes), ToMB(this->BudgetBytes), ToMB(UsedBytes)
+	);
+	
+	UE_LOG(LogTemp, Log, TEXT("%s"), *this->Report.BudgetError);
+	return false;
+}
+
+bool FGenerationMemoryBudget::BeginStage(const FString& Stage, int64 EstimatedBytes)
+{
+	this->EndStage();
+	if (this->CheckStage(Stage, EstimatedBytes) == false) {
+		return false;
+	}
+	
+	FPlatformMemoryStats Stats = FPlatformMemory::GetStats();
+	FLandscapeGenerationStageMemory& StageMemory = this->Report.Stages.AddDefaulted_GetRef();
+	StageMemory.Stage = Stage;
+	StageMemory.EstimatedBytes = EstimatedBytes;
+	StageMemory.StartBytes = (int64)Stats.UsedPhysical;
+	
+	this->CurrentStage = this->Report.Stages.Num() - 1;
+	this->StartPeakBytes = Stats.PeakUsedPhysical;
+	return true;
+}
+
+void FGenerationMemoryBudget::EndStage()
+{
+	if (this->CurrentStage == INDEX_NONE) {
+		return;
+	}
+	
+	// The process's high-water mark is only attributable to this stage if it rose while the stage ran
+	FPlatformMemoryStats Stats = FPlatformMemory::GetStats();
+	FLandscapeGenerationStageMemory& StageMemory = this->Report.Stages[this->CurrentStage];
+	StageMemory.PeakBytes = (Stats.PeakUsedPhysical > this->StartPeakBytes) ?
+		(int64)Stats.PeakUsedPhysical :
+		FMath::Max(StageMemory.StartBytes, (int64)Stats.UsedPhysical);
+	
+	this->Report.PeakBytes = FMath::Max(this->Report.PeakBytes, StageMemory.PeakBytes);
+	this->CurrentStage = INDEX_NONE;
+	
+	UE_LOG(LogTemp, Log, TEXT("Landscape generation stage \"%s\": estimated %.1lf MB, peak usage %.1lf MB"),
+		*StageMemory.Stage, ToMB(StageMemory.EstimatedBytes), ToMB(StageMemory.PeakBytes));
+}
+
+int64 FGenerationMemoryBudget::EstimateColorTexture(int64 NumPixels)
+{
+	// The BGRA8 texture source, plus the RGBA32F image and compressed output produced when the texture is built
+	return NumPixels * (4 + 16 + 1);
+}
+
+int64 FGenerationMemoryBudget::EstimateHoleFilling(int64 NumSamples)
+{
+	// The filled copy of the heightmap and its validity mask, plus the coarser pyramid levels (a third of the samples in total)
+	return NumSamples * (4 + 1) + (NumSamples * (4 + 1)) / 3;
+}
+
+int64 FGenerationMemoryBudget::EstimateQuantization(int64 NumSamples, bool bHasNoData)
+{
+	// The quantized samples, plus the filled copy of the heightmap that is being quantized (if any)
+	return NumSamples * (2 + (bHasNoData ? 4 : 0));
+}
+
+int64 FGenerationMemoryBudget::EstimateDerivedMaps(int64 NumSamples)
+{
+	// The quantized samples, the BGRA8 normal and G8 slope and ambient occlusion texture sources, plus the RGBA32F image and
+	// compressed output produced when each texture is built (the textures are built one at a time)
+	return NumSamples * (2 + 4 + 1 + 1) + NumSamples * (16 + 1);
+}
+
+int64 FGenerationMemoryBudget::EstimatePaintLayers(int64 NumSamples, int32 NumLayers)
+{
+	// The quantized samples, the warped and aligned copies of the classification raster, and a weightmap for each layer
+	return NumSamples * (2 + 4 + 4 + NumLayers);
+}
+
+int64 FGenerationMemoryBudget::EstimateImport(int64 NumSamples, int32 NumLayers)
+{
+	// The quantized samples and weightmaps passed to the landscape, the source and platform data of its BGRA8 heightmap textures and
+	// its RGBA8 weightmap textures (each with a full mip chain), and the collision heights
+	int64 NumWeightmapTextures = FMath::DivideAndRoundUp(NumLayers, 4);
+	return NumSamples * (2 + NumLayers) + ((NumSamples * 4 * 2 * 4) / 3) * (1 + NumWeightmapTextures) + NumSamples * 2;
+}
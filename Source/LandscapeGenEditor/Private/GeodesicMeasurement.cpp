@@ -0,0 +1,64 @@
+#include "GeodesicMeasurement.h"
+#include "CoordinateSystemRegistry.h"
+#include "GDALHelpers.h"
+
+namespace
+{
+	// The mean radius of the Earth in metres
+	const double EarthRadius = 6371008.8;
+}
+
+FGeodesicMeasurement::FGeodesicMeasurement(const FString& InWKT) : WKT(InWKT), Projection(FMapProjection::FromWKT(InWKT))
+{
+	if (this->Projection.IsBuiltIn() == false) {
+		this->WGS84_WKT = CoordinateSystemRegistry::GetWKT(4326);
+	}
+}
+
+bool FGeodesicMeasurement::MeasureDistance(double X1, double Y1, double X2, double Y2, double& OutMetres) const
+{
+	double Latitude1;
+	double Longitude1;
+	double Latitude2;
+	double Longitude2;
+	if (this->ProjectedToGeographic(X1, Y1, Latitude1, Longitude1) == false || this->ProjectedToGeographic(X2, Y2, Latitude2, Longitude2) == false) {
+		return false;
+	}
+	
+	OutMetres = GreatCircleDistance(Latitude1, Longitude1, Latitude2, Longitude2);
+	return true;
+}
+
+double FGeodesicMeasurement::GreatCircleDistance(double Latitude1, double Longitude1, double Latitude2, double Longitude2)
+{
+	double Lat1 = FMath::DegreesToRadians(Latitude1);
+	double Lat2 = FMath::DegreesToRadians(Latitude2);
+	double SinHalfLat = sin((Lat2 - Lat1) * 0.5);
+	double SinHalfLon = sin(FMath::DegreesToRadians(Longitude2 - Longitude1) * 0.5);
+	double Haversine = SinHalfLat * SinHalfLat + cos(Lat1) * cos(Lat2) * SinHalfLon * SinHalfLon;
+	return 2.0 * EarthRadius * asin(FMath::Min(sqrt(Haversine), 1.0));
+}
+
+bool FGeodesicMeasurement::ProjectedToGeographic(double X, double Y, double& OutLatitude, double& OutLongitude) const
+{
+	if (this->Projection.IsBuiltIn()) {
+		return this->Projection.ProjectedToGeographic(X, Y, OutLatitude, OutLongitude);
+	}
+	
+	// (The registry transforms single precision coordinates, which is accurate enough for the long baselines that are measured)
+	FVector Transformed;
+	if (CoordinateSystemRegistry::TransformCoordinate(this->WKT, this->WGS84_WKT, FVector(X, Y, 0.0f), Transformed) == false) {
+		return false;
+	}
+	
+	// Prior to GDAL 3.0, coordinate transformations produce WGS84 coordinates in (lon,lat) format instead of (lat,lon)
+	#if GDAL_VERSION_NUM < GDAL_COMPUTE_VERSION(3,0,0)
+		OutLatitude = Transformed.Y;
+		OutLongitude = Transformed.X;
+	#else
+		OutLatitude = Transformed.X;
+		OutLongitude = Transformed.Y;
+	#endif
+	
+	return true;
+}
@@ -0,0 +1,189 @@
+#include "HeightmapHoleFilling.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// The number of rows processed by each parallel task
+	const int32 RowsPerTask = 64;
+	
+	// Represents a single level of the push-pull pyramid, with a validity mask for each sample
+	struct FPyramidLevel
+	{
+		uint32 SizeX;
+		uint32 SizeY;
+		TArray64<float> Values;
+		TArray64<uint8> Valid;
+	};
+	
+	// Runs the supplied function for each row of a raster, processing blocks of rows in parallel
+	template <typename RowFunction>
+	void ParallelForRows(uint32 NumRows, RowFunction Function)
+	{
+		int32 NumTasks = FMath::DivideAndRoundUp<int32>(NumRows, RowsPerTask);
+		ParallelFor(NumTasks, [&](int32 TaskIndex)
+		{
+			uint32 RowEnd = FMath::Min<uint32>(NumRows, (TaskIndex + 1) * RowsPerTask);
+			for (uint32 Row = TaskIndex * RowsPerTask; Row < RowEnd; ++Row) {
+				Function(Row);
+			}
+		});
+	}
+	
+	// Pull phase: downsamples a level by averaging the valid samples in each 2x2 block
+	void PullLevel(const FPyramidLevel& Fine, FPyramidLevel& Coarse)
+	{
+		Coarse.SizeX = FMath::DivideAndRoundUp<uint32>(Fine.SizeX, 2);
+		Coarse.SizeY = FMath::DivideAndRoundUp<uint32>(Fine.SizeY, 2);
+		Coarse.Values.SetNumUninitialized((int64)Coarse.SizeX * Coarse.SizeY);
+		Coarse.Valid.SetNumUninitialized((int64)Coarse.SizeX * Coarse.SizeY);
+		
+		ParallelForRows(Coarse.SizeY, [&](uint32 Y)
+		{
+			for (uint32 X = 0; X < Coarse.SizeX; ++X)
+			{
+				float Sum = 0.0f;
+				int32 Count = 0;
+				for (uint32 FineY = Y * 2; FineY < FMath::Min(Y * 2 + 2, Fine.SizeY); ++FineY)
+				{
+					for (uint32 FineX = X * 2; FineX < FMath::Min(X * 2 + 2, Fine.SizeX); ++FineX)
+					{
+						int64 FineIndex = (int64)FineY * Fine.SizeX + FineX;
+						if (Fine.Valid[FineIndex])
+						{
+							Sum += Fine.Values[FineIndex];
+							Count++;
+						}
+					}
+				}
+				
+				int64 CoarseIndex = (int64)Y * Coarse.SizeX + X;
+				Coarse.Values[CoarseIndex] = (Count > 0) ? (Sum / Count) : 0.0f;
+				Coarse.Valid[CoarseIndex] = (Count > 0) ? 1 : 0;
+			}
+		});
+	}
+	
+	// Push phase: fills the invalid samples of a level by bilinearly upsampling the (fully populated) coarser level
+	void PushLevel(const FPyramidLevel& Coarse, FPyramidLevel& Fine)
+	{
+		ParallelForRows(Fine.SizeY, [&](uint32 Y)
+		{
+			// Compute the vertical sampling position in the coarse level (coarse sample centres lie between fine sample pairs)
+			float CoarseY = FMath::Clamp(Y * 0.5f - 0.25f, 0.0f, (float)(Coarse.SizeY - 1));
+			uint32 Y0 = (uint32)CoarseY;
+			uint32 Y1 = FMath::Min(Y0 + 1, Coarse.SizeY - 1);
+			float FracY = CoarseY - Y0;
+			
+			for (uint32 X = 0; X < Fine.SizeX; ++X)
+			{
+				int64 FineIndex = (int64)Y * Fine.SizeX + X;
+				if (Fine.Valid[FineIndex]) {
+					continue;
+				}
+				
+				float CoarseX = FMath::Clamp(X * 0.5f - 0.25f, 0.0f, (float)(Coarse.SizeX - 1));
+				uint32 X0 = (uint32)CoarseX;
+				uint32 X1 = FMath::Min(X0 + 1, Coarse.SizeX - 1);
+				float FracX = CoarseX - X0;
+				
+				float Top = FMath::Lerp(Coarse.Values[(int64)Y0 * Coarse.SizeX + X0], Coarse.Values[(int64)Y0 * Coarse.SizeX + X1], FracX);
+				float Bottom = FMath::Lerp(Coarse.Values[(int64)Y1 * Coarse.SizeX + X0], Coarse.Values[(int64)Y1 * Coarse.SizeX + X1], FracX);
+				Fine.Values[FineIndex] = FMath::Lerp(Top, Bottom, FracY);
+				Fine.Valid[FineIndex] = 1;
+			}
+		});
+	}
+}
+
+bool HeightmapHoleFilling::ComputeValidRange(const TArray64<float>& Heights, float NoDataValue, float& OutMin, float& OutMax)
+{
+	// Compute the range of each block of samples in parallel and then combine the results
+	const int64 SamplesPerTask = 1 << 20;
+	int32 NumTasks = (int32)FMath::DivideAndRoundUp<int64>(Heights.Num(), SamplesPerTask);
+	TArray<float> BlockMin;
+	TArray<float> BlockMax;
+	BlockMin.Init(TNumericLimits<float>::Max(), NumTasks);
+	BlockMax.Init(TNumericLimits<float>::Lowest(), NumTasks);
+	
+	ParallelFor(NumTasks, [&](int32 TaskIndex)
+	{
+		float Min = TNumericLimits<float>::Max();
+		float Max = TNumericLimits<float>::Lowest();
+		int64 End = FMath::Min(Heights.Num(), (TaskIndex + 1) * SamplesPerTask);
+		for (int64 Index = TaskIndex * SamplesPerTask; Index < End; ++Index)
+		{
+			float Sample = Heights[Index];
+			if (IsValidSample(Sample, NoDataValue))
+			{
+				Min = FMath::Min(Min, Sample);
+				Max = FMath::Max(Max, Sample);
+			}
+		}
+		
+		BlockMin[TaskIndex] = Min;
+		BlockMax[TaskIndex] = Max;
+	});
+	
+	OutMin = TNumericLimits<float>::Max();
+	OutMax = TNumericLimits<float>::Lowest();
+	for (int32 TaskIndex = 0; TaskIndex < NumTasks; ++TaskIndex)
+	{
+		OutMin = FMath::Min(OutMin, BlockMin[TaskIndex]);
+		OutMax = FMath::Max(OutMax, BlockMax[TaskIndex]);
+	}
+	
+	return (OutMin <= OutMax);
+}
+
+int64 HeightmapHoleFilling::FillHoles(TArray64<float>& Heights, uint32 SizeX, uint32 SizeY, float NoDataValue)
+{
+	check(Heights.Num() == (int64)SizeX * SizeY)
+	
+	// Build the validity mask for the full resolution level and count the holes
+	FPyramidLevel Base;
+	Base.SizeX = SizeX;
+	Base.SizeY = SizeY;
+	Base.Values = MoveTemp(Heights);
+	Base.Valid.SetNumUninitialized(Base.Values.Num());
+	
+	TArray<int64> RowHoles;
+	RowHoles.SetNumZeroed(SizeY);
+	ParallelForRows(SizeY, [&](uint32 Y)
+	{
+		for (int64 Index = (int64)Y * SizeX; Index < (int64)(Y + 1) * SizeX; ++Index)
+		{
+			Base.Valid[Index] = IsValidSample(Base.Values[Index], NoDataValue) ? 1 : 0;
+			RowHoles[Y] += (1 - Base.Valid[Index]);
+		}
+	});
+	
+	int64 NumHoles = 0;
+	for (int64 Holes : RowHoles) {
+		NumHoles += Holes;
+	}
+	
+	// Nothing needs to be filled if there are no holes, and nothing can be filled if there are no valid samples
+	if (NumHoles == 0 || NumHoles == Base.Values.Num())
+	{
+		Heights = MoveTemp(Base.Values);
+		return (NumHoles == 0) ? 0 : -1;
+	}
+	
+	// Pull phase: build the pyramid of averaged valid samples, stopping once a level contains no holes
+	TArray<FPyramidLevel> Levels;
+	Levels.Add(MoveTemp(Base));
+	while (Levels.Last().Valid.Contains(0) && (Levels.Last().SizeX > 1 || Levels.Last().SizeY > 1))
+	{
+		FPyramidLevel Coarse;
+		PullLevel(Levels.Last(), Coarse);
+		Levels.Add(MoveTemp(Coarse));
+	}
+	
+	// Push phase: propagate interpolated values from the coarsest level back down to the full resolution level
+	for (int32 Level = Levels.Num() - 2; Level >= 0; --Level) {
+		PushLevel(Levels[Level + 1], Levels[Level]);
+	}
+	
+	Heights = MoveTemp(Levels[0].Values);
+	return NumHoles;
+}
@@ -0,0 +1,83 @@
+#include "HeightmapQuantization.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// The number of samples processed by each parallel task
+	const int64 SamplesPerTask = 1 << 18;
+	
+	// Quantizes a buffer of samples that are converted to heights in metres by the supplied decoding function
+	template <typename SampleType, typename DecodeFunction>
+	void QuantizeSamples(const TArray64<SampleType>& Samples, DecodeFunction Decode, float Min, float Max, TArray<uint16>& OutSamples)
+	{
+		check(Samples.Num() <= MAX_int32)
+		OutSamples.SetNumUninitialized((int32)Samples.Num());
+		
+		// A flat heightmap maps every sample to zero
+		const float Range = Max - Min;
+		const float Scale = (Range > 0.0f) ? ((float)MAX_uint16 / Range) : 0.0f;
+		
+		// Quantize each block of samples in parallel (each block writes to a disjoint region of the output)
+		int32 NumTasks = (int32)FMath::DivideAndRoundUp<int64>(Samples.Num(), SamplesPerTask);
+		ParallelFor(NumTasks, [&](int32 TaskIndex)
+		{
+			const SampleType* Src = Samples.GetData();
+			uint16* Dest = OutSamples.GetData();
+			int64 End = FMath::Min(Samples.Num(), (TaskIndex + 1) * SamplesPerTask);
+			for (int64 Index = TaskIndex * SamplesPerTask; Index < End; ++Index)
+			{
+				float Scaled = (Decode(Src[Index]) - Min) * Scale + 0.5f;
+				Dest[Index] = (FMath::IsNaN(Scaled) ? 0 : (uint16)FMath::Clamp(Scaled, 0.0f, (float)MAX_uint16));
+			}
+		});
+	}
+}
+
+void HeightmapQuantization::Quantize(const TArray64<float>& Heights, float Min, float Max, TArray<uint16>& OutSamples)
+{
+	QuantizeSamples(Heights, [](float Height) { return Height; }, Min, Max, OutSamples);
+}
+
+void HeightmapQuantization::QuantizeCompact(const TArray64<uint16>& Samples, const FGISHeightFormat& Format, float Min, float Max, TArray<uint16>& OutSamples)
+{
+	QuantizeSamples(Samples, [&Format](uint16 Sample) { return Format.Decode(Sample); }, Min, Max, OutSamples);
+}
+
+bool HeightmapQuantization::ComputeCompactRange(const TArray64<uint16>& Samples, const FGISHeightFormat& Format, float& OutMin, float& OutMax)
+{
+	// Compute the range of each block of samples in parallel and then combine the results
+	int32 NumTasks = (int32)FMath::DivideAndRoundUp<int64>(Samples.Num(), SamplesPerTask);
+	TArray<float> BlockMin;
+	TArray<float> BlockMax;
+	BlockMin.Init(TNumericLimits<float>::Max(), NumTasks);
+	BlockMax.Init(TNumericLimits<float>::Lowest(), NumTasks);
+	
+	ParallelFor(NumTasks, [&](int32 TaskIndex)
+	{
+		float Min = TNumericLimits<float>::Max();
+		float Max = TNumericLimits<float>::Lowest();
+		int64 End = FMath::Min(Samples.Num(), (TaskIndex + 1) * SamplesPerTask);
+		for (int64 Index = TaskIndex * SamplesPerTask; Index < End; ++Index)
+		{
+			float Height = Format.Decode(Samples[Index]);
+			if (FMath::IsNaN(Height) == false)
+			{
+				Min = FMath::Min(Min, Height);
+				Max = FMath::Max(Max, Height);
+			}
+		}
+		
+		BlockMin[TaskIndex] = Min;
+		BlockMax[TaskIndex] = Max;
+	});
+	
+	OutMin = TNumericLimits<float>::Max();
+	OutMax = TNumericLimits<float>::Lowest();
+	for (int32 TaskIndex = 0; TaskIndex < NumTasks; ++TaskIndex)
+	{
+		OutMin = FMath::Min(OutMin, BlockMin[TaskIndex]);
+		OutMax = FMath::Max(OutMax, BlockMax[TaskIndex]);
+	}
+	
+	return (OutMin <= OutMax);
+}
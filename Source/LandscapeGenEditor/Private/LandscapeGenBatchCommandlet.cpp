@@ -0,0 +1,472 @@
+#include "LandscapeGenBatchCommandlet.h"
+#include "LandscapeGenerationBPFL.h"
+#include "Landscape.h"
+
+#include "AssetRegistryModule.h"
+#include "Containers/Ticker.h"
+#include "Dom/JsonObject.h"
+#include "EditorLoadingAndSavingUtils.h"
+#include "Engine/World.h"
+#include "FileHelpers.h"
+#include "HAL/ThreadManager.h"
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	// Computes the number of bytes held by the buffers of a GIS data object
+	int64 GetDataBytes(const FGISData& Data)
+	{
+		return Data.GetHeightBytes() + (int64)Data.ColorBuffer.Num() * sizeof(uint8);
+	}
+}
+
+void ULandscapeGenBatchJob::HandleRetrievalSuccess(const FString& InError, const FGISData& InData)
+{
+	// Data sources may report completion more than once, so only record the first result
+	if (this->State != ELandscapeGenBatchJobState::Retrieving) {
+		return;
+	}
+	
+	this->RetrievalEndTime = FPlatformTime::Seconds();
+	this->Data = InData;
+	this->DataBytes = GetDataBytes(InData);
+	this->RetrievedBytes = this->DataBytes;
+	this->State = ELandscapeGenBatchJobState::Retrieved;
+	UE_LOG(LogTemp, Display, TEXT("[%s] Data retrieval completed in %.2lf seconds"), *this->Name, this->RetrievalEndTime - this->RetrievalStartTime);
+}
+
+void ULandscapeGenBatchJob::HandleRetrievalFailure(const FString& InError, const FGISData& InData)
+{
+	// Data sources may report more than one failure, so only record the first result
+	if (this->State != ELandscapeGenBatchJobState::Retrieving) {
+		return;
+	}
+	
+	this->RetrievalEndTime = FPlatformTime::Seconds();
+	this->DataBytes = 0;
+	this->Error = InError;
+	this->State = ELandscapeGenBatchJobState::Failed;
+	UE_LOG(LogTemp, Error, TEXT("[%s] Data retrieval failed: %s"), *this->Name, *InError);
+}
+
+ULandscapeGenBatchCommandlet::ULandscapeGenBatchCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 ULandscapeGenBatchCommandlet::Main(const FString& Params)
+{
+	// Parse our command-line parameters
+	FString ManifestPath;
+	if (FParse::Value(*Params, TEXT("Manifest="), ManifestPath) == false)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Usage: -run=LandscapeGenBatch -Manifest=<manifest.json> [-Report=<report.json>] [-DryRun]"));
+		return 1;
+	}
+	
+	const bool bDryRun = FParse::Param(*Params, TEXT("DryRun"));
+	FString ReportPath = FPaths::ProjectSavedDir() / TEXT("LandscapeGen") / (bDryRun ? TEXT("BatchPlan.json") : TEXT("BatchReport.json"));
+	FParse::Value(*Params, TEXT("Report="), ReportPath);
+	
+	// Parse the manifest and create the data sources for each job
+	FString ManifestError;
+	if (this->ParseManifest(ManifestPath, ManifestError) == false)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to parse batch manifest %s: %s"), *ManifestPath, *ManifestError);
+		return 1;
+	}
+	
+	// Plan the jobs without performing any work if this is a dry run
+	if (bDryRun)
+	{
+		int32 NumFailed = 0;
+		if (this->WritePlanReport(ReportPath, NumFailed) == false)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write batch plan to %s"), *ReportPath);
+			return 1;
+		}
+		
+		UE_LOG(LogTemp, Display, TEXT("Planned %d landscape generation jobs (%d would fail)"), this->Jobs.Num(), NumFailed);
+		return (NumFailed > 0) ? 1 : 0;
+	}
+	
+	UE_LOG(LogTemp, Display, TEXT("Processing %d landscape generation jobs"), this->Jobs.Num());
+	double BatchStartTime = FPlatformTime::Seconds();
+	double LastTickTime = BatchStartTime;
+	int32 NextJobToStart = 0;
+	
+	while (true)
+	{
+		// Determine how much work is currently in flight
+		int32 InFlightJobs = 0;
+		int64 InFlightBytes = 0;
+		ULandscapeGenBatchJob* ReadyJob = nullptr;
+		for (ULandscapeGenBatchJob* Job : this->Jobs)
+		{
+			if (Job->State == ELandscapeGenBatchJobState::Retrieving || Job->State == ELandscapeGenBatchJobState::Retrieved)
+			{
+				InFlightJobs++;
+				InFlightBytes += Job->DataBytes;
+			}
+			
+			if (Job->State == ELandscapeGenBatchJobState::Retrieved && ReadyJob == nullptr) {
+				ReadyJob = Job;
+			}
+		}
+		
+		// Start retrieval for upcoming jobs while we are within our limits, so that their data is retrieved while the
+		// current job is being generated (the limit is clamped to at least one job, so the batch can always make progress)
+		while (NextJobToStart < this->Jobs.Num() && InFlightJobs < this->MaxInFlightRetrievals)
+		{
+			// A job's data does not exist until its retrieval completes, so charge the estimated peak memory of the retrieval
+			// against the limit when it starts (planning is performed only once per job, since it may open datasets)
+			ULandscapeGenBatchJob* Job = this->Jobs[NextJobToStart];
+			if (Job->EstimatedDataBytes < 0) {
+				Job->EstimatedDataBytes = FMath::Max(Cast<IGISDataSource>(Job->DataSource)->PlanRetrieval().PeakMemoryBytes, (int64)0);
+			}
+			
+			if (InFlightJobs > 0 && InFlightBytes + Job->EstimatedDataBytes > this->MaxInFlightBytes) {
+				break;
+			}
+			
+			this->StartRetrieval(Job);
+			NextJobToStart++;
+			InFlightJobs++;
+			InFlightBytes += Job->DataBytes;
+		}
+		
+		// Generate the landscape for the oldest job whose data is ready
+		if (ReadyJob != nullptr)
+		{
+			this->GenerateAndSave(ReadyJob);
+			continue;
+		}
+		
+		// Stop once every job has either completed or failed
+		bool AllJobsFinished = (NextJobToStart >= this->Jobs.Num());
+		for (ULandscapeGenBatchJob* Job : this->Jobs) {
+			AllJobsFinished &= (Job->State == ELandscapeGenBatchJobState::Completed || Job->State == ELandscapeGenBatchJobState::Failed);
+		}
+		
+		if (AllJobsFinished) {
+			break;
+		}
+		
+		// Pump the engine so that asynchronous retrieval callbacks are delivered
+		double Now = FPlatformTime::Seconds();
+		this->TickPendingWork(Now - LastTickTime);
+		LastTickTime = Now;
+		FPlatformProcess::Sleep(0.005f);
+	}
+	
+	double TotalSeconds = FPlatformTime::Seconds() - BatchStartTime;
+	int32 NumFailed = this->Jobs.FilterByPredicate([](ULandscapeGenBatchJob* Job) { return Job->State == ELandscapeGenBatchJobState::Failed; }).Num();
+	UE_LOG(LogTemp, Display, TEXT("Batch completed in %.2lf seconds (%d succeeded, %d failed)"), TotalSeconds, this->Jobs.Num() - NumFailed, NumFailed);
+	
+	if (this->WriteReport(ReportPath, TotalSeconds) == false) {
+		UE_LOG(LogTemp, Error, TEXT("Failed to write batch report to %s"), *ReportPath);
+	}
+	
+	return (NumFailed > 0) ? 1 : 0;
+}
+
+bool ULandscapeGenBatchCommandlet::ParseManifest(const FString& ManifestPath, FString& OutError)
+{
+	// Attempt to load and parse the manifest JSON
+	FString ManifestString;
+	if (FFileHelper::LoadFileToString(ManifestString, *ManifestPath) == false)
+	{
+		OutError = TEXT("Failed to read the manifest file");
+		return false;
+	}
+	
+	TSharedPtr<FJsonObject> Manifest;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ManifestString);
+	if (FJsonSerializer::Deserialize(Reader, Manifest) == false || !Manifest.IsValid())
+	{
+		OutError = TEXT("The manifest is not a valid JSON object");
+		return false;
+	}
+	
+	// Retrieve the batch limits
+	int32 MaxInFlightMemoryMB = 0;
+	Manifest->TryGetNumberField(TEXT("MaxInFlightRetrievals"), this->MaxInFlightRetrievals);
+	if (Manifest->TryGetNumberField(TEXT("MaxInFlightMemoryMB"), MaxInFlightMemoryMB)) {
+		this->MaxInFlightBytes = (int64)MaxInFlightMemoryMB * 1024 * 1024;
+	}
+	
+	this->MaxInFlightRetrievals = FMath::Max(this->MaxInFlightRetrievals, 1);
+	
+	const TArray<TSharedPtr<FJsonValue>>* JobValues = nullptr;
+	if (Manifest->TryGetArrayField(TEXT("Jobs"), JobValues) == false || JobValues->Num() == 0)
+	{
+		OutError = TEXT("The manifest does not contain any jobs");
+		return false;
+	}
+	
+	for (const TSharedPtr<FJsonValue>& JobValue : *JobValues)
+	{
+		const TSharedPtr<FJsonObject>* JobObject = nullptr;
+		if (JobValue->TryGetObject(JobObject) == false)
+		{
+			OutError = TEXT("Each job must be a JSON object");
+			return false;
+		}
+		
+		ULandscapeGenBatchJob* Job = NewObject<ULandscapeGenBatchJob>(this);
+		if ((*JobObject)->TryGetStringField(TEXT("Name"), Job->Name) == false || (*JobObject)->TryGetStringField(TEXT("Map"), Job->MapPath) == false)
+		{
+			OutError = TEXT("Each job must specify a Name and a Map");
+			return false;
+		}
+		
+		if (FPackageName::IsValidLongPackageName(Job->MapPath) == false)
+		{
+			OutError = FString::Printf(TEXT("Job %s specifies an invalid map package path: %s"), *Job->Name, *Job->MapPath);
+			return false;
+		}
+		
+		// Retrieve the optional scale factors
+		const TArray<TSharedPtr<FJsonValue>>* ScaleValues = nullptr;
+		if ((*JobObject)->TryGetArrayField(TEXT("Scale"), ScaleValues) && ScaleValues->Num() == 3) {
+			Job->Scale3D = FVector((*ScaleValues)[0]->AsNumber(), (*ScaleValues)[1]->AsNumber(), (*ScaleValues)[2]->AsNumber());
+		}
+		
+		// Retrieve the optional generation options
+		const TSharedPtr<FJsonObject>* OptionsObject = nullptr;
+		if ((*JobObject)->TryGetObjectField(TEXT("Options"), OptionsObject))
+		{
+			if (FJsonObjectConverter::JsonObjectToUStruct(OptionsObject->ToSharedRef(), &Job->Options) == false)
+			{
+				OutError = FString::Printf(TEXT("Failed to apply the generation options for job %s"), *Job->Name);
+				return false;
+			}
+		}
+		
+		// Create the data source from its class and populate its properties
+		const TSharedPtr<FJsonObject>* SourceObject = nullptr;
+		FString SourceClassPath;
+		if ((*JobObject)->TryGetObjectField(TEXT("DataSource"), SourceObject) == false || (*SourceObject)->TryGetStringField(TEXT("Class"), SourceClassPath) == false)
+		{
+			OutError = FString::Printf(TEXT("Job %s must specify a DataSource with a Class"), *Job->Name);
+			return false;
+		}
+		
+		UClass* SourceClass = LoadClass<UObject>(nullptr, *SourceClassPath);
+		if (SourceClass == nullptr || SourceClass->ImplementsInterface(UGISDataSource::StaticClass()) == false)
+		{
+			OutError = FString::Printf(TEXT("Job %s specifies a data source class that does not implement IGISDataSource: %s"), *Job->Name, *SourceClassPath);
+			return false;
+		}
+		
+		Job->DataSource = NewObject<UObject>(Job, SourceClass);
+		
+		const TSharedPtr<FJsonObject>* PropertiesObject = nullptr;
+		if ((*SourceObject)->TryGetObjectField(TEXT("Properties"), PropertiesObject))
+		{
+			if (FJsonObjectConverter::JsonObjectToUStruct(PropertiesObject->ToSharedRef(), SourceClass, Job->DataSource) == false)
+			{
+				OutError = FString::Printf(TEXT("Failed to apply the data source properties for job %s"), *Job->Name);
+				return false;
+			}
+		}
+		
+		this->Jobs.Add(Job);
+	}
+	
+	return true;
+}
+
+void ULandscapeGenBatchCommandlet::StartRetrieval(ULandscapeGenBatchJob* Job)
+{
+	UE_LOG(LogTemp, Display, TEXT("[%s] Starting data retrieval"), *Job->Name);
+	
+	FGISDataSourceDelegate OnSuccess;
+	FGISDataSourceDelegate OnFailure;
+	OnSuccess.AddDynamic(Job, &ULandscapeGenBatchJob::HandleRetrievalSuccess);
+	OnFailure.AddDynamic(Job, &ULandscapeGenBatchJob::HandleRetrievalFailure);
+	
+	Job->State = ELandscapeGenBatchJobState::Retrieving;
+	Job->DataBytes = Job->EstimatedDataBytes;
+	Job->RetrievalStartTime = FPlatformTime::Seconds();
+	Cast<IGISDataSource>(Job->DataSource)->RetrieveData(OnSuccess, OnFailure);
+}
+
+void ULandscapeGenBatchCommandlet::GenerateAndSave(ULandscapeGenBatchJob* Job)
+{
+	UE_LOG(LogTemp, Display, TEXT("[%s] Generating landscape"), *Job->Name);
+	Job->GenerationStartTime = FPlatformTime::Seconds();
+	
+	// Create a new world to hold the generated landscape
+	UPackage* MapPackage = CreatePackage(nullptr, *Job->MapPath);
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*FPackageName::GetShortName(Job->MapPath)), MapPackage);
+	World->SetFlags(RF_Public | RF_Standalone);
+	FAssetRegistryModule::AssetCreated(World);
+	
+	ALandscape* Landscape = ULandscapeGenerationBPFL::GenerateLandscapeFromGISDataWithMemoryReport(World, Job->Name, Job->Data, Job->Scale3D, Job->Options, Job->MemoryReport);
+	Job->GenerationSeconds = FPlatformTime::Seconds() - Job->GenerationStartTime;
+	
+	// Release the retrieved data as soon as it has been consumed
+	Job->Data = FGISData();
+	Job->DataBytes = 0;
+	
+	if (Landscape == nullptr)
+	{
+		Job->Error = Job->MemoryReport.BudgetError.IsEmpty() ? TEXT("Landscape generation failed") : Job->MemoryReport.BudgetError;
+		Job->State = ELandscapeGenBatchJobState::Failed;
+		UE_LOG(LogTemp, Error, TEXT("[%s] Landscape generation failed"), *Job->Name);
+	}
+	else
+	{
+		// Save the map along with the texture and material assets that were created for the landscape
+		double SaveStartTime = FPlatformTime::Seconds();
+		MapPackage->MarkPackageDirty();
+		
+		TArray<UPackage*> PackagesToSave;
+		FEditorFileUtils::GetDirtyContentPackages(PackagesToSave);
+		PackagesToSave.AddUnique(MapPackage);
+		
+		if (UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, true))
+		{
+			Job->State = ELandscapeGenBatchJobState::Completed;
+		}
+		else
+		{
+			Job->Error = TEXT("Failed to save one or more packages");
+			Job->State = ELandscapeGenBatchJobState::Failed;
+			UE_LOG(LogTemp, Error, TEXT("[%s] Failed to save one or more packages"), *Job->Name);
+		}
+		
+		Job->SaveSeconds = FPlatformTime::Seconds() - SaveStartTime;
+		UE_LOG(LogTemp, Display, TEXT("[%s] Generated in %.2lf seconds, saved in %.2lf seconds"), *Job->Name, Job->GenerationSeconds, Job->SaveSeconds);
+	}
+	
+	// Tear down the world and reclaim the memory used by the job
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	World->ClearFlags(RF_Public | RF_Standalone);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void ULandscapeGenBatchCommandlet::TickPendingWork(float DeltaTime)
+{
+	FTicker::GetCoreTicker().Tick(DeltaTime);
+	FThreadManager::Get().Tick();
+	FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+}
+
+bool ULandscapeGenBatchCommandlet::WriteReport(const FString& ReportPath, double TotalSeconds) const
+{
+	TArray<TSharedPtr<FJsonValue>> JobReports;
+	for (const ULandscapeGenBatchJob* Job : this->Jobs)
+	{
+		TSharedPtr<FJsonObject> JobReport = MakeShared<FJsonObject>();
+		JobReport->SetStringField(TEXT("Name"), Job->Name);
+		JobReport->SetStringField(TEXT("Map"), Job->MapPath);
+		JobReport->SetBoolField(TEXT("Succeeded"), Job->State == ELandscapeGenBatchJobState::Completed);
+		JobReport->SetStringField(TEXT("Error"), Job->Error);
+		JobReport->SetNumberField(TEXT("RetrievalSeconds"), Job->RetrievalEndTime - Job->RetrievalStartTime);
+		JobReport->SetNumberField(TEXT("QueuedSeconds"), (Job->GenerationStartTime > 0.0) ? (Job->GenerationStartTime - Job->RetrievalEndTime) : 0.0);
+		JobReport->SetNumberField(TEXT("GenerationSeconds"), Job->GenerationSeconds);
+		JobReport->SetNumberField(TEXT("SaveSeconds"), Job->SaveSeconds);
+		JobReport->SetNumberField(TEXT("RetrievedMB"), (double)Job->RetrievedBytes / (1024.0 * 1024.0));
+		JobReport->SetNumberField(TEXT("PeakMemoryMB"), (double)Job->MemoryReport.PeakBytes / (1024.0 * 1024.0));
+		
+		// Report the estimated and observed memory usage of each generation stage
+		TArray<TSharedPtr<FJsonValue>> StageReports;
+		for (const FLandscapeGenerationStageMemory& Stage : Job->MemoryReport.Stages)
+		{
+			TSharedPtr<FJsonObject> StageReport = MakeShared<FJsonObject>();
+			StageReport->SetStringField(TEXT("Stage"), Stage.Stage);
+			StageReport->SetNumberField(TEXT("EstimatedMB"), (double)Stage.EstimatedBytes / (1024.0 * 1024.0));
+			StageReport->SetNumberField(TEXT("StartMB"), (double)Stage.StartBytes / (1024.0 * 1024.0));
+			StageReport->SetNumberField(TEXT("PeakMB"), (double)Stage.PeakBytes / (1024.0 * 1024.0));
+			StageReports.Add(MakeShared<FJsonValueObject>(StageReport));
+		}
+		
+		JobReport->SetArrayField(TEXT("MemoryStages"), StageReports);
+		JobReports.Add(MakeShared<FJsonValueObject>(JobReport));
+	}
+	
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetNumberField(TEXT("TotalSeconds"), TotalSeconds);
+	Report->SetArrayField(TEXT("Jobs"), JobReports);
+	
+	FString ReportString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportString);
+	if (FJsonSerializer::Serialize(Report, Writer) == false) {
+		return false;
+	}
+	
+	return FFileHelper::SaveStringToFile(ReportString, *ReportPath);
+}
+
+bool ULandscapeGenBatchCommandlet::WritePlanReport(const FString& ReportPath, int32& OutNumFailed) const
+{
+	OutNumFailed = 0;
+	double TotalSeconds = 0.0;
+	TArray<TSharedPtr<FJsonValue>> JobReports;
+	for (const ULandscapeGenBatchJob* Job : this->Jobs)
+	{
+		FGISRetrievalPlan RetrievalPlan = Cast<IGISDataSource>(Job->DataSource)->PlanRetrieval();
+		FLandscapeGenerationPlan GenerationPlan = ULandscapeGenerationBPFL::PlanLandscapeGeneration(RetrievalPlan, Job->Options);
+		if (!GenerationPlan.Error.IsEmpty())
+		{
+			OutNumFailed++;
+			UE_LOG(LogTemp, Error, TEXT("[%s] %s"), *Job->Name, *GenerationPlan.Error);
+		}
+		
+		TSharedPtr<FJsonObject> JobReport = MakeShared<FJsonObject>();
+		JobReport->SetStringField(TEXT("Name"), Job->Name);
+		JobReport->SetStringField(TEXT("Map"), Job->MapPath);
+		JobReport->SetStringField(TEXT("Error"), GenerationPlan.Error);
+		JobReport->SetNumberField(TEXT("Tiles"), RetrievalPlan.NumTiles);
+		JobReport->SetNumberField(TEXT("Requests"), RetrievalPlan.NumRequests);
+		JobReport->SetNumberField(TEXT("DownloadMB"), (double)RetrievalPlan.ExpectedDownloadBytes / (1024.0 * 1024.0));
+		JobReport->SetNumberField(TEXT("HeightSizeX"), RetrievalPlan.HeightSizeX);
+		JobReport->SetNumberField(TEXT("HeightSizeY"), RetrievalPlan.HeightSizeY);
+		JobReport->SetNumberField(TEXT("NumComponentsX"), GenerationPlan.NumComponentsX);
+		JobReport->SetNumberField(TEXT("NumComponentsY"), GenerationPlan.NumComponentsY);
+		JobReport->SetNumberField(TEXT("ComponentSizeQuads"), GenerationPlan.ComponentSizeQuads);
+		JobReport->SetNumberField(TEXT("RetrievalPeakMemoryMB"), (double)RetrievalPlan.PeakMemoryBytes / (1024.0 * 1024.0));
+		JobReport->SetNumberField(TEXT("GenerationPeakMemoryMB"), (double)GenerationPlan.PeakMemoryBytes / (1024.0 * 1024.0));
+		JobReport->SetNumberField(TEXT("EstimatedRetrievalSeconds"), RetrievalPlan.EstimatedSeconds);
+		JobReport->SetNumberField(TEXT("EstimatedGenerationSeconds"), GenerationPlan.EstimatedSeconds);
+		
+		// Report the estimated memory usage of each generation stage
+		TArray<TSharedPtr<FJsonValue>> StageReports;
+		for (const FLandscapeGenerationStageMemory& Stage : GenerationPlan.Stages)
+		{
+			TSharedPtr<FJsonObject> StageReport = MakeShared<FJsonObject>();
+			StageReport->SetStringField(TEXT("Stage"), Stage.Stage);
+			StageReport->SetNumberField(TEXT("EstimatedMB"), (double)Stage.EstimatedBytes / (1024.0 * 1024.0));
+			StageReports.Add(MakeShared<FJsonValueObject>(StageReport));
+		}
+		
+		JobReport->SetArrayField(TEXT("MemoryStages"), StageReports);
+		JobReports.Add(MakeShared<FJsonValueObject>(JobReport));
+		TotalSeconds += RetrievalPlan.EstimatedSeconds + GenerationPlan.EstimatedSeconds;
+	}
+	
+	// The total assumes that retrieval and generation do not overlap, so it is an upper bound for the pipelined batch
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetNumberField(TEXT("EstimatedTotalSeconds"), TotalSeconds);
+	Report->SetArrayField(TEXT("Jobs"), JobReports);
+	
+	FString ReportString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportString);
+	if (FJsonSerializer::Serialize(Report, Writer) == false) {
+		return false;
+	}
+	
+	return FFileHelper::SaveStringToFile(ReportString, *ReportPath);
+}
@@ -1,16 +1,16 @@
 #include "LandscapeGeneration.h"
-#include "UnrealGDAL.h"
+#include "CoordinateSystemRegistry.h"
 
 #define LOCTEXT_NAMESPACE "FLandscapeGenerationModule"
 
-void FLandscapeGenerationModule::StartupModule()
+// GDAL is initialised on first use rather than at startup (see FLandscapeGenRuntimeModule::EnsureGDALInitialized())
+void FLandscapeGenerationModule::StartupModule() {}
+
+void FLandscapeGenerationModule::ShutdownModule()
 {
-	FUnrealGDALModule* UnrealGDAL = FModuleManager::Get().LoadModulePtr<FUnrealGDALModule>("UnrealGDAL");
-	UnrealGDAL->InitGDAL();
+	CoordinateSystemRegistry::Reset();
 }
 
-void FLandscapeGenerationModule::ShutdownModule() {}
-
 #undef LOCTEXT_NAMESPACE
 
 IMPLEMENT_MODULE(FLandscapeGenerationModule, LandscapeGenEditor)
\ No newline at end of file
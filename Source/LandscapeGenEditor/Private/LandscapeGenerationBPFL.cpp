@@ -1,10 +1,22 @@
 #include "LandscapeGenerationBPFL.h"
 #include "Landscape.h"
 #include "LandscapeEdit.h"
+#include "LandscapeLayerInfoObject.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformMemory.h"
 
 #include "GDALHelpers.h"
+#include "GeodesicMeasurement.h"
+#include "GeneratedAssetCache.h"
+#include "GenerationCostCalibration.h"
+#include "GenerationMemoryBudget.h"
 #include "GISDataComponent.h"
+#include "HeightmapHoleFilling.h"
+#include "HeightmapQuantization.h"
 #include "LandscapeConstraints.h"
+#include "ParallelLandscapeImport.h"
+#include "RasterAlignment.h"
+#include "TerrainDerivatives.h"
 
 #include "AssetRegistryModule.h"
 #include "AssetToolsModule.h"
@@ -13,6 +25,7 @@
 
 #include "Factories/MaterialFactoryNew.h"
 #include "Materials/MaterialInstanceDynamic.h"
+#include "Materials/MaterialExpressionLandscapeLayerBlend.h"
 #include "Materials/MaterialExpressionLandscapeLayerCoords.h"
 #include "Materials/MaterialExpressionDivide.h"
 #include "Materials/MaterialExpressionMultiply.h"
@@ -20,187 +33,438 @@
 #include "Materials/MaterialExpressionScalarParameter.h"
 #include "Materials/MaterialExpressionTextureSampleParameter2D.h"
 
-#include <vector>
+#include <limits>
 
-ALandscape* ULandscapeGenerationBPFL::GenerateLandscapeFromGISData(
-	const UObject* WorldContext, const FString& LandscapeName, const FGISData& GISData, const FVector& Scale3D)
+namespace
 {
-	// Check that we can allocate GISData in one texture
-	if (
-		GISData.HeightBufferX > LandscapeConstraints::MaxRasterSizeX() ||
-		GISData.HeightBufferY > LandscapeConstraints::MaxRasterSizeY() ||
-		GISData.ColorBufferX > LandscapeConstraints::MaxRasterSizeX() ||
-		GISData.ColorBufferY > LandscapeConstraints::MaxRasterSizeY()
-	) {
-		UE_LOG(LogTemp, Log, TEXT("Textures too large to allocate in single landscape"));
-		return nullptr;
-	}
-	
-	auto ColorBuffer = GISData.ColorBuffer;
+	// The number of quads along each side of the generated landscape components
+	const int32 LandscapeComponentSizeQuads = 255;
 	
-	// Textures need to be in BGRA format, so reorder the raster channels if the input data is in another format
-	if (GISData.PixelFormat != EPixelFormat::PF_B8G8R8A8)
+	// Creates the layer info assets for the specified paint layers and fills their weightmaps in parallel from a land cover
+	// classification raster, which is resampled to the dimensions of the heightmap since weightmaps share the landscape's vertex grid
+	bool CreatePaintLayers(const FGISData& GISData, const FVector2D& UpperLeft, const FVector2D& LowerRight,
+		const FLandscapeGenerationOptions& Options, TArray<FLandscapeImportLayerInfo>& OutLayers)
 	{
-		// Determine the correct mapping from source channel order to destination channel order
-		// (Note that these are 1-indexed to remain consistent with the way GDAL 1-indexes raster bands)
-		std::vector<uint32> ChannelMapping;
-		switch (GISData.PixelFormat)
+		TArray64<int32> Classes;
+		int32 SizeX = GISData.HeightBufferX;
+		int32 SizeY = GISData.HeightBufferY;
+		FString Error = RasterAlignment::ReadAlignedBand<int32>(
+			Options.ClassificationRasterPath, GISData.ProjectionWKT, UpperLeft, LowerRight, TEXT("mode"), Classes, SizeX, SizeY
+		);
+		
+		if (!Error.IsEmpty())
 		{
-		case EPixelFormat::PF_R8G8B8A8:
-			ChannelMapping = {3,2,1,4};
-			break;
-		default:
-			UE_LOG(LogTemp, Log, TEXT("Unsupported pixel format for colour data"));
-			return nullptr;
+			UE_LOG(LogTemp, Log, TEXT("%s"), *Error);
+			return false;
 		}
 		
-		mergetiff::RasterData<uint8> dataWrapper(ColorBuffer.GetData(), 4, GISData.ColorBufferY, GISData.ColorBufferX, true);
-		GDALDatasetRef datasetWrapper = mergetiff::DatasetManagement::wrapRasterData(dataWrapper);
-		TArray<uint8> remapped;
-		mergetiff::RasterData<uint8> remappedRD = GDALHelpers::AllocateAndWrap<uint8>(remapped, 4, GISData.ColorBufferY, GISData.ColorBufferX, 255);
+		// Map each class value to the index of the layer that paints it
+		TMap<int32, int32> LayerForClass;
+		for (int32 LayerIndex = 0; LayerIndex < Options.PaintLayers.Num(); ++LayerIndex)
+		{
+			for (int32 ClassValue : Options.PaintLayers[LayerIndex].ClassValues) {
+				LayerForClass.Add(ClassValue, LayerIndex);
+			}
+		}
 		
-		if (mergetiff::RasterIO::readDataset(datasetWrapper, remappedRD, ChannelMapping) == false)
+		OutLayers.Reset();
+		for (const FLandCoverPaintLayer& PaintLayer : Options.PaintLayers)
 		{
-			UE_LOG(LogTemp, Log, TEXT("Failed to remap channels for the colour data"));
-			return nullptr;
+			FLandscapeImportLayerInfo& Layer = OutLayers.Emplace_GetRef(PaintLayer.LayerName);
+			Layer.LayerData.SetNumZeroed((int32)Classes.Num());
+		}
+		
+		// Fill each block of samples in parallel, giving full weight to the layer for each sample's class
+		// (Samples whose class is not painted by any layer are assigned to the first layer so that the weights always sum to one)
+		const int64 SamplesPerTask = 1 << 18;
+		int32 NumTasks = (int32)FMath::DivideAndRoundUp<int64>(Classes.Num(), SamplesPerTask);
+		ParallelFor(NumTasks, [&](int32 TaskIndex)
+		{
+			int64 End = FMath::Min(Classes.Num(), (TaskIndex + 1) * SamplesPerTask);
+			for (int64 Index = TaskIndex * SamplesPerTask; Index < End; ++Index)
+			{
+				const int32* LayerIndex = LayerForClass.Find(Classes[Index]);
+				OutLayers[(LayerIndex != nullptr) ? *LayerIndex : 0].LayerData[Index] = 255;
+			}
+		});
+		
+		// Create a layer info asset for each layer, sharing the layer info assets created by previous runs for the same layer names
+		// (Layer info objects only identify a layer, so sharing them between landscapes also allows the layers to blend consistently)
+		FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+		for (FLandscapeImportLayerInfo& Layer : OutLayers)
+		{
+			FString Hash = GeneratedAssetCache::FormatHash(GeneratedAssetCache::HashString(Layer.LayerName.ToString()));
+			FString Prefix = GeneratedAssetCache::GetAssetName(FString::Printf(TEXT("LI_%s"), *Layer.LayerName.ToString()), Hash);
+			Layer.LayerInfo = GeneratedAssetCache::FindAsset<ULandscapeLayerInfoObject>(Prefix, Hash);
+			if (Layer.LayerInfo != nullptr) {
+				continue;
+			}
+			
+			FString PackageName = GeneratedAssetCache::GetPackagePath();
+			FString Name;
+			AssetToolsModule.Get().CreateUniqueAssetName(PackageName, Prefix, PackageName, Name);
+			
+			UPackage* Package = CreatePackage(NULL, *PackageName);
+			Package->FullyLoad();
+			
+			Layer.LayerInfo = NewObject<ULandscapeLayerInfoObject>(Package, *Name, RF_Public | RF_Standalone | RF_Transactional);
+			Layer.LayerInfo->LayerName = Layer.LayerName;
+			GeneratedAssetCache::SetAssetHash(Layer.LayerInfo, Hash);
+			
+			FAssetRegistryModule::AssetCreated(Layer.LayerInfo);
+			Package->SetDirtyFlag(true);
 		}
 		
-		ColorBuffer = remapped;
+		return true;
 	}
 	
-	// Save colour texture to UAsset
-	FString PackageName = TEXT("/Game/GISLandscapeData/");
-	
-	// Get unique asset name
-	FString Name;
-	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
-	AssetToolsModule.Get().CreateUniqueAssetName(PackageName, FString::Printf(TEXT("T_%s_GISTexture"), *LandscapeName), PackageName, Name);
+	// Computes the ground distance in metres between the samples of the heightmap along each axis, measured across the middle of the
+	// landscape so that projections whose units are not ground metres (such as Web Mercator) produce correct slopes
+	// (Falls back to the projected sample spacing if the coordinates cannot be converted to WGS84)
+	FVector2D ComputeMetresPerSample(const FGISData& GISData, const FVector2D& UpperLeft, const FVector2D& LowerRight)
+	{
+		FVector2D ProjectedSpacing = (LowerRight - UpperLeft).GetAbs() / FVector2D(GISData.HeightBufferX, GISData.HeightBufferY);
+		FVector2D Centre = (UpperLeft + LowerRight) * 0.5f;
+		FGeodesicMeasurement Measurement(GISData.ProjectionWKT);
+		double Width;
+		double Height;
+		if (Measurement.MeasureDistance(UpperLeft.X, Centre.Y, LowerRight.X, Centre.Y, Width) == false ||
+			Measurement.MeasureDistance(Centre.X, UpperLeft.Y, Centre.X, LowerRight.Y, Height) == false) {
+			return ProjectedSpacing;
+		}
+		
+		return FVector2D(Width / GISData.HeightBufferX, Height / GISData.HeightBufferY);
+	}
 	
-	// Create package
-	UPackage* Package = CreatePackage(NULL, *PackageName);
-	Package->FullyLoad();
+	// Creates a texture asset whose source is allocated without any initial data, so that it can be filled in place
+	UTexture2D* CreateEmptyTexture(UTextureFactory* TextureFactory, const FString& Prefix, const FString& Hash, int32 SizeX, int32 SizeY, ETextureSourceFormat Format)
+	{
+		FString PackageName = GeneratedAssetCache::GetPackagePath();
+		FString Name;
+		FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+		AssetToolsModule.Get().CreateUniqueAssetName(PackageName, Prefix, PackageName, Name);
+		
+		UPackage* Package = CreatePackage(NULL, *PackageName);
+		Package->FullyLoad();
+		
+		UTexture2D* Texture = (UTexture2D*)TextureFactory->CreateTexture2D(Package, *Name, RF_Public | RF_Standalone | RF_Transactional);
+		if (Texture != nullptr) {
+			Texture->Source.Init(SizeX, SizeY, /*NumSlices=*/ 1, /*NumMips=*/ 1, Format, nullptr);
+		}
+		
+		return Texture;
+	}
 	
-	UTexture2D* ColorTexture;
+	// Builds a texture whose source has been filled and registers it with the asset cache
+	void FinishTexture(UTextureFactory* TextureFactory, UTexture2D* Texture, const FString& Hash, TextureCompressionSettings Compression, TextureGroup LODGroup)
+	{
+		Texture->CompressionSettings = Compression;
+		Texture->LODGroup = LODGroup;
+		Texture->MipGenSettings = TMGS_NoMipmaps;
+		Texture->SRGB = false;
+		
+		GEditor->GetEditorSubsystem<UImportSubsystem>()->BroadcastAssetPostImport(TextureFactory, Texture);
+		Texture->PostEditChange();
+		
+		GeneratedAssetCache::SetAssetHash(Texture, Hash);
+		FAssetRegistryModule::AssetCreated(Texture);
+		Texture->GetOutermost()->SetDirtyFlag(true);
+	}
 	
-	UTextureFactory* TextureFactory = NewObject<UTextureFactory>();
-	TextureFactory->AddToRoot();
+	// Creates the normal, slope and ambient occlusion textures for the quantized heightmap, computing the maps directly into the
+	// texture sources (textures created by a previous run are reused if the heightmap and parameters are unchanged, and only the
+	// textures missing from the cache are created and computed)
+	bool CreateDerivedMapTextures(const FString& LandscapeName, const TArray<uint16>& HeightSamples, int32 SizeX, int32 SizeY,
+		const FVector2D& MetresPerSample, float MetresPerStep, float OcclusionRadius, UTexture2D*& OutNormalMap, UTexture2D*& OutSlopeMap,
+		UTexture2D*& OutOcclusionMap)
+	{
+		FString Hash = GeneratedAssetCache::FormatHash(
+			GeneratedAssetCache::HashBuffer((const uint8*)HeightSamples.GetData(), (int64)HeightSamples.Num() * sizeof(uint16)),
+			GeneratedAssetCache::HashString(FString::Printf(TEXT("%d,%d,%f,%f,%f,%f"), SizeX, SizeY, MetresPerSample.X, MetresPerSample.Y, MetresPerStep, OcclusionRadius))
+		);
+		
+		FString NormalPrefix = GeneratedAssetCache::GetAssetName(FString::Printf(TEXT("T_%s_Normal"), *LandscapeName), Hash);
+		FString SlopePrefix = GeneratedAssetCache::GetAssetName(FString::Printf(TEXT("T_%s_Slope"), *LandscapeName), Hash);
+		FString OcclusionPrefix = GeneratedAssetCache::GetAssetName(FString::Printf(TEXT("T_%s_AO"), *LandscapeName), Hash);
+		OutNormalMap = GeneratedAssetCache::FindAsset<UTexture2D>(NormalPrefix, Hash);
+		OutSlopeMap = GeneratedAssetCache::FindAsset<UTexture2D>(SlopePrefix, Hash);
+		OutOcclusionMap = GeneratedAssetCache::FindAsset<UTexture2D>(OcclusionPrefix, Hash);
+		if (OutNormalMap != nullptr && OutSlopeMap != nullptr && OutOcclusionMap != nullptr) {
+			return true;
+		}
+		
+		UTextureFactory* TextureFactory = NewObject<UTextureFactory>();
+		TextureFactory->AddToRoot();
+		
+		// Create only the textures that are missing from the cache, so that a partially-cached set does not leave duplicates behind
+		UTexture2D* NewNormalMap = (OutNormalMap == nullptr) ? CreateEmptyTexture(TextureFactory, NormalPrefix, Hash, SizeX, SizeY, ETextureSourceFormat::TSF_BGRA8) : nullptr;
+		UTexture2D* NewSlopeMap = (OutSlopeMap == nullptr) ? CreateEmptyTexture(TextureFactory, SlopePrefix, Hash, SizeX, SizeY, ETextureSourceFormat::TSF_G8) : nullptr;
+		UTexture2D* NewOcclusionMap = (OutOcclusionMap == nullptr) ? CreateEmptyTexture(TextureFactory, OcclusionPrefix, Hash, SizeX, SizeY, ETextureSourceFormat::TSF_G8) : nullptr;
+		OutNormalMap = (OutNormalMap != nullptr) ? OutNormalMap : NewNormalMap;
+		OutSlopeMap = (OutSlopeMap != nullptr) ? OutSlopeMap : NewSlopeMap;
+		OutOcclusionMap = (OutOcclusionMap != nullptr) ? OutOcclusionMap : NewOcclusionMap;
+		if (OutNormalMap == nullptr || OutSlopeMap == nullptr || OutOcclusionMap == nullptr)
+		{
+			TextureFactory->RemoveFromRoot();
+			UE_LOG(LogTemp, Log, TEXT("Failed to create the derived terrain map textures"));
+			return false;
+		}
+		
+		// Compute only the maps for the newly-created textures
+		TerrainDerivatives::ComputeMaps(
+			HeightSamples, SizeX, SizeY, MetresPerSample, MetresPerStep, OcclusionRadius,
+			(NewNormalMap != nullptr) ? NewNormalMap->Source.LockMip(0) : nullptr,
+			(NewSlopeMap != nullptr) ? NewSlopeMap->Source.LockMip(0) : nullptr,
+			(NewOcclusionMap != nullptr) ? NewOcclusionMap->Source.LockMip(0) : nullptr
+		);
+		
+		// Build the textures one at a time, since each build allocates a floating-point copy of its source
+		if (NewNormalMap != nullptr)
+		{
+			NewNormalMap->Source.UnlockMip(0);
+			FinishTexture(TextureFactory, NewNormalMap, Hash, TC_Normalmap, TEXTUREGROUP_WorldNormalMap);
+		}
+		
+		if (NewSlopeMap != nullptr)
+		{
+			NewSlopeMap->Source.UnlockMip(0);
+			FinishTexture(TextureFactory, NewSlopeMap, Hash, TC_Grayscale, TEXTUREGROUP_World);
+		}
+		
+		if (NewOcclusionMap != nullptr)
+		{
+			NewOcclusionMap->Source.UnlockMip(0);
+			FinishTexture(TextureFactory, NewOcclusionMap, Hash, TC_Grayscale, TEXTUREGROUP_World);
+		}
+		
+		TextureFactory->RemoveFromRoot();
+		return true;
+	}
+}
+
+ALandscape* ULandscapeGenerationBPFL::GenerateLandscapeFromGISData(
+	const UObject* WorldContext, const FString& LandscapeName, const FGISData& GISData, const FVector& Scale3D)
+{
+	return GenerateLandscapeFromGISDataWithOptions(WorldContext, LandscapeName, GISData, Scale3D, FLandscapeGenerationOptions());
+}
+
+ALandscape* ULandscapeGenerationBPFL::GenerateLandscapeFromGISDataWithOptions(
+	const UObject* WorldContext, const FString& LandscapeName, const FGISData& GISData, const FVector& Scale3D, const FLandscapeGenerationOptions& Options)
+{
+	FLandscapeGenerationMemoryReport Report;
+	return GenerateLandscapeFromGISDataWithMemoryReport(WorldContext, LandscapeName, GISData, Scale3D, Options, Report);
+}
+
+ALandscape* ULandscapeGenerationBPFL::GenerateLandscapeFromGISDataWithMemoryReport(
+	const UObject* WorldContext, const FString& LandscapeName, const FGISData& GISData, const FVector& Scale3D,
+	const FLandscapeGenerationOptions& Options, FLandscapeGenerationMemoryReport& OutReport)
+{
+	const double StartTime = FPlatformTime::Seconds();
 	
-	ColorTexture = (UTexture2D*)TextureFactory->CreateTexture2D(
-		Package, *Name, RF_Public | RF_Standalone | RF_Transactional);
+	// The colour path is skipped entirely if it has been disabled or the data source did not retrieve any colour data
+	// (Paint layers also replace the colour texture, since the layered material generated from them provides the landscape's colour)
+	const bool bImportPaintLayers = (Options.PaintLayers.Num() > 0 && !Options.ClassificationRasterPath.IsEmpty());
+	const bool bGenerateColor = (!bImportPaintLayers && Options.bGenerateColorTexture && GISData.ColorBuffer.Num() > 0);
 	
-	if (ColorTexture)
+	if (GISData.HasHeightData() == false)
 	{
-		ColorTexture->Source.Init(
-			GISData.ColorBufferX,
-			GISData.ColorBufferY,
-			/*NumSlices=*/ 1,
-			/*NumMips=*/ 1,
-			ETextureSourceFormat::TSF_BGRA8,
-			ColorBuffer.GetData()
-		);
-		ColorTexture->CompressionSettings = TC_Default;
-		ColorTexture->LODGroup = TEXTUREGROUP_World;
-		ColorTexture->MipGenSettings = TMGS_NoMipmaps;
+		UE_LOG(LogTemp, Log, TEXT("Landscape generation requires heightmap data"));
+		return nullptr;
 	}
 	
-	GEditor->GetEditorSubsystem<UImportSubsystem>()->BroadcastAssetPostImport(TextureFactory, ColorTexture);
+	// Check that we can allocate GISData in one texture
+	if (
+		GISData.HeightBufferX > LandscapeConstraints::MaxRasterSizeX() ||
+		GISData.HeightBufferY > LandscapeConstraints::MaxRasterSizeY() ||
+		(bGenerateColor && GISData.ColorBufferX > LandscapeConstraints::MaxRasterSizeX()) ||
+		(bGenerateColor && GISData.ColorBufferY > LandscapeConstraints::MaxRasterSizeY())
+	) {
+		UE_LOG(LogTemp, Log, TEXT("Textures too large to allocate in single landscape"));
+		return nullptr;
+	}
 	
-	ColorTexture->PostEditChange();
-	TextureFactory->RemoveFromRoot();
+	// Check the estimated allocations of every stage against the memory budget before performing any work, so that jobs which
+	// cannot fit are refused immediately rather than after the earlier stages have run
+	FGenerationMemoryBudget Budget(Options.MemoryBudgetMB, OutReport);
+	const int64 NumSamples = (int64)GISData.HeightBufferX * GISData.HeightBufferY;
+	const int32 NumLayers = bImportPaintLayers ? Options.PaintLayers.Num() : 0;
+	const int64 ColorTextureBytes = FGenerationMemoryBudget::EstimateColorTexture((int64)GISData.ColorBufferX * GISData.ColorBufferY);
+	const int64 HoleFillingBytes = FGenerationMemoryBudget::EstimateHoleFilling(NumSamples);
+	const int64 QuantizationBytes = FGenerationMemoryBudget::EstimateQuantization(NumSamples, GISData.bHeightHasNoData);
+	const int64 DerivedMapsBytes = FGenerationMemoryBudget::EstimateDerivedMaps(NumSamples);
+	const int64 PaintLayersBytes = FGenerationMemoryBudget::EstimatePaintLayers(NumSamples, NumLayers);
+	const int64 ImportBytes = FGenerationMemoryBudget::EstimateImport(NumSamples, NumLayers);
+	if (
+		(bGenerateColor && !Budget.CheckStage(TEXT("ColorTexture"), ColorTextureBytes)) ||
+		(GISData.bHeightHasNoData && !Budget.CheckStage(TEXT("HoleFilling"), HoleFillingBytes)) ||
+		!Budget.CheckStage(TEXT("Quantization"), QuantizationBytes) ||
+		(Options.bGenerateDerivedMaps && !Budget.CheckStage(TEXT("DerivedMaps"), DerivedMapsBytes)) ||
+		(bImportPaintLayers && !Budget.CheckStage(TEXT("PaintLayers"), PaintLayersBytes)) ||
+		!Budget.CheckStage(TEXT("Import"), ImportBytes)
+	) {
+		return nullptr;
+	}
 	
-	FAssetRegistryModule::AssetCreated(ColorTexture);
-	Package->SetDirtyFlag(true);
+	// Save colour texture to UAsset
+	UTexture2D* ColorTexture = nullptr;
+	if (bGenerateColor)
+	{
+		if (Budget.BeginStage(TEXT("ColorTexture"), ColorTextureBytes) == false) {
+			return nullptr;
+		}
+		
+		ColorTexture = CreateColorTexture(LandscapeName, GISData);
+		if (ColorTexture == nullptr) {
+			return nullptr;
+		}
+	}
 	
 	// Setup heightmap for landscape
 	TMap<FGuid, TArray<uint16>> HeightmapDataPerLayers;
 	TMap<FGuid, TArray<FLandscapeImportLayerInfo>> MaterialLayerDataPerLayer;
 	
-	mergetiff::RasterData<float> floatRasterData(const_cast<float*>(GISData.HeightBuffer.GetData()), 1, GISData.HeightBufferY, GISData.HeightBufferX, true);
-	GDALDatasetRef floatDataset = mergetiff::DatasetManagement::datasetFromRaster(floatRasterData);
-	
-	// Get scale min and maxes in meters as float
-	auto MinMax = GDALHelpers::ComputeRasterMinMax(floatDataset, 1);
-	
-	check(MinMax)
-	
-	// Convert meters in float to uint16 for Unreal while maximizing height sample resolution
-	GDALDatasetRef uint16Dataset = GDALHelpers::Translate(floatDataset, GDALHelpers::UniqueMemFilename(),
-		GDALHelpers::ParseGDALTranslateOptions({
-			TEXT("-ot"),
-			TEXT("UInt16"),
-			TEXT("-scale"),
-			FString::Printf(TEXT("%lf"), MinMax->Min),
-			FString::Printf(TEXT("%lf"), MinMax->Max),
-			FString::Printf(TEXT("%d"), 0),
-			FString::Printf(TEXT("%d"), MAX_uint16)
-			})
-	);
+	// If the heightmap contains nodata samples then fill the holes in a copy of the data so they don't distort the height range
+	// (Compact height samples are decoded into the copy, since the filled values do not generally fall on the compact sample grid)
+	const TArray64<float>* HeightBuffer = &GISData.HeightBuffer;
+	TArray64<float> FilledHeightBuffer;
+	if (GISData.bHeightHasNoData)
+	{
+		if (Budget.BeginStage(TEXT("HoleFilling"), HoleFillingBytes) == false) {
+			return nullptr;
+		}
+		
+		GISData.DecodeHeights(FilledHeightBuffer);
+		if (HeightmapHoleFilling::FillHoles(FilledHeightBuffer, GISData.HeightBufferX, GISData.HeightBufferY, GISData.HeightNoDataValue) < 0)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Heightmap does not contain any valid height values"));
+			return nullptr;
+		}
+		
+		HeightBuffer = &FilledHeightBuffer;
+	}
 	
-	TArray<uint16> HeightGDAL;
+	// Compact height samples without any holes are consumed directly, without expanding them to floats
+	const bool bQuantizeCompact = (GISData.HeightFormat.IsCompact() && !GISData.bHeightHasNoData);
 	
-	// Create a buffer to hold the heightmap data and wrap it in a RasterData object
-	mergetiff::RasterData<uint16> heightmapData = GDALHelpers::AllocateAndWrap<uint16>(HeightGDAL, 1, GISData.HeightBufferY, GISData.HeightBufferX, 0);
+	// Get scale min and maxes in meters as float, computing the range of each block of samples in parallel
+	// (Any nodata samples have been filled at this point, so only NaN samples are excluded)
+	float MinHeight;
+	float MaxHeight;
+	bool bHasValidRange = bQuantizeCompact ?
+		HeightmapQuantization::ComputeCompactRange(GISData.CompactHeightBuffer, GISData.HeightFormat, MinHeight, MaxHeight) :
+		HeightmapHoleFilling::ComputeValidRange(*HeightBuffer, std::numeric_limits<float>::quiet_NaN(), MinHeight, MaxHeight);
 	
-	// Attempt to read the heightmap data into our buffer
-	if (mergetiff::RasterIO::readDataset(uint16Dataset, heightmapData, { 1 }) == false) {
-		UE_LOG(LogTemp, Log, TEXT("Failed to read the data from the heightmap"));
+	if (bHasValidRange == false)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Heightmap does not contain any valid height values"));
 		return nullptr;
 	}
 	
+	if (Budget.BeginStage(TEXT("Quantization"), QuantizationBytes) == false) {
+		return nullptr;
+	}
+	
+	// Convert meters in float to uint16 for Unreal while maximizing height sample resolution, quantizing blocks of samples in parallel
+	TArray<uint16> HeightSamples;
+	if (bQuantizeCompact) {
+		HeightmapQuantization::QuantizeCompact(GISData.CompactHeightBuffer, GISData.HeightFormat, MinHeight, MaxHeight, HeightSamples);
+	}
+	else {
+		HeightmapQuantization::Quantize(*HeightBuffer, MinHeight, MaxHeight, HeightSamples);
+	}
+	
+	// Release the filled copy of the heightmap (if any) now that it has been quantized
+	FilledHeightBuffer.Empty();
+	
 	// Store corner coordinates projected if not already
-	FVector2D UpperLeft = GISData.UpperLeft;
-	FVector2D LowerRight = GISData.LowerRight;
+	FVector2D UpperLeft;
+	FVector2D LowerRight;
+	if (GISData.GetProjectedCorners(UpperLeft, LowerRight) == false)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Failed to convert the corner coordinates to the projected coordinate system"));
+		return nullptr;
+	}
 	
-	if (GISData.CornerType == ECornerCoordinateType::LatLon)
+	// Compute the derived terrain maps from the quantized heightmap if requested, measuring slopes in ground metres
+	UTexture2D* NormalMap = nullptr;
+	UTexture2D* SlopeMap = nullptr;
+	UTexture2D* OcclusionMap = nullptr;
+	if (Options.bGenerateDerivedMaps)
 	{
-		// Prior to GDAL 3.0, coordinate transformations expect WGS84 coordinates to be in (lon,lat) format instead of (lat,lon)
-		// (See: https://gdal.org/tutorials/osr_api_tut.html#crs-and-axis-order)
-		#if GDAL_VERSION_NUM < GDAL_COMPUTE_VERSION(3,0,0)
-			UpperLeft = FVector2D(UpperLeft.Y, UpperLeft.X);
-			LowerRight = FVector2D(LowerRight.Y, LowerRight.X);
-		#endif
-		
-		FString WGS84_WKT = GDALHelpers::WktFromEPSG(4326);
-		OGRCoordinateTransformationRef CoordTransform = GDALHelpers::CreateCoordinateTransform(WGS84_WKT, GISData.ProjectionWKT);
-		
-		FVector TempUL;
-		check(GDALHelpers::TransformCoordinate(CoordTransform, FVector(UpperLeft, 0), TempUL));
-		UpperLeft = FVector2D(TempUL);
+		if (Budget.BeginStage(TEXT("DerivedMaps"), DerivedMapsBytes) == false) {
+			return nullptr;
+		}
 		
-		FVector TempLR;
-		check(GDALHelpers::TransformCoordinate(CoordTransform, FVector(LowerRight, 0), TempLR));
-		LowerRight = FVector2D(TempLR);
+		FVector2D MetresPerSample = ComputeMetresPerSample(GISData, UpperLeft, LowerRight);
+		float MetresPerStep = (MaxHeight - MinHeight) / (float)MAX_uint16;
+		if (CreateDerivedMapTextures(LandscapeName, HeightSamples, GISData.HeightBufferX, GISData.HeightBufferY, MetresPerSample,
+			MetresPerStep, Options.AmbientOcclusionRadius, NormalMap, SlopeMap, OcclusionMap) == false) {
+			return nullptr;
+		}
 	}
 	
-	check(GDALHelpers::SetRasterCorners(uint16Dataset, UpperLeft, LowerRight))
+	// Import the land cover classes as paint layer weightmaps if requested
+	TArray<FLandscapeImportLayerInfo> PaintLayers;
+	if (bImportPaintLayers)
+	{
+		if (Budget.BeginStage(TEXT("PaintLayers"), PaintLayersBytes) == false || CreatePaintLayers(GISData, UpperLeft, LowerRight, Options, PaintLayers) == false) {
+			return nullptr;
+		}
+	}
+	
+	if (Budget.BeginStage(TEXT("Import"), ImportBytes) == false) {
+		return nullptr;
+	}
 	
 	// Make the scale factor for X Y by calculating metres per pixel
 	// Make Z scale factor as Unreals default heighmap range is -255cm to 255cm over a 0 to max_uint16 range
-	FVector ScaleVector = Scale3D * 100 * FVector((LowerRight - UpperLeft).GetAbs() / FVector2D(GISData.HeightBufferX, GISData.HeightBufferY), (MinMax->Max - MinMax->Min) / 512.0);
+	FVector ScaleVector = Scale3D * 100 * FVector((LowerRight - UpperLeft).GetAbs() / FVector2D(GISData.HeightBufferX, GISData.HeightBufferY), (MaxHeight - MinHeight) / 512.0);
 	
 	ALandscape* Landscape = WorldContext->GetWorld()->SpawnActor<ALandscape>();
 	
 	// Setup landscape configuration
-	Landscape->ComponentSizeQuads = 255;
-	Landscape->SubsectionSizeQuads = 255;
+	Landscape->ComponentSizeQuads = LandscapeComponentSizeQuads;
+	Landscape->SubsectionSizeQuads = LandscapeComponentSizeQuads;
 	Landscape->NumSubsections = 1;
 	Landscape->SetLandscapeGuid(FGuid::NewGuid());
 	
-	// Build new material for landscape
-	Landscape->LandscapeMaterial = GenerateUnlitLandscapeMaterial(LandscapeName, FString::Printf(TEXT("%s.%s"), *PackageName, *Name), FMath::CeilToInt(GISData.HeightBufferX / 255), FMath::CeilToInt(GISData.HeightBufferY / 255), 255);
+	// Use the supplied material if there is one, otherwise build new unlit material for landscape from the colour texture
+	if (Options.LandscapeMaterial != nullptr) {
+		Landscape->LandscapeMaterial = Options.LandscapeMaterial;
+	}
+	else if (bImportPaintLayers) {
+		Landscape->LandscapeMaterial = GenerateLayeredLandscapeMaterial(LandscapeName, Options.PaintLayers, FMath::Abs(LowerRight.X - UpperLeft.X) / GISData.HeightBufferX);
+	}
+	else if (ColorTexture != nullptr) {
+		Landscape->LandscapeMaterial = GenerateUnlitLandscapeMaterial(LandscapeName, ColorTexture->GetPathName(), FMath::CeilToInt(GISData.HeightBufferX / 255), FMath::CeilToInt(GISData.HeightBufferY / 255), 255);
+	}
 	
 	Landscape->CreateLandscapeInfo();
 	Landscape->SetActorTransform(FTransform(FQuat::Identity, FVector(), ScaleVector));
 	
-	// Generate LandscapeActor from heightmap
-	HeightmapDataPerLayers.Add(FGuid(), HeightGDAL);
-	MaterialLayerDataPerLayer.Add(FGuid(), TArray<FLandscapeImportLayerInfo>());
+	// Build the landscape components from the heightmap, preparing the heightmap textures of the components in parallel
+	// (Paint layers are imported through the engine's serial import, which also allocates and fills the components' weightmaps)
+	if (bImportPaintLayers == false) {
+		ParallelLandscapeImport::ImportHeightmap(Landscape, HeightSamples, GISData.HeightBufferX, GISData.HeightBufferY);
+	}
+	else
+	{
+		HeightmapDataPerLayers.Add(FGuid(), MoveTemp(HeightSamples));
+		MaterialLayerDataPerLayer.Add(FGuid(), MoveTemp(PaintLayers));
+		
+		Landscape->Import(Landscape->GetLandscapeGuid(), 0, 0, GISData.HeightBufferX - 1,
+			GISData.HeightBufferY - 1, Landscape->NumSubsections, Landscape->SubsectionSizeQuads, HeightmapDataPerLayers,
+			TEXT("NONE"), MaterialLayerDataPerLayer, ELandscapeImportAlphamapType::Additive
+		);
+		
+		// Register the paint layers with the landscape so that they appear in the landscape paint tools
+		for (const FLandscapeImportLayerInfo& Layer : MaterialLayerDataPerLayer[FGuid()]) {
+			Landscape->EditorLayerSettings.Add(FLandscapeEditorLayerSettings(Layer.LayerInfo));
+		}
+	}
 	
-	// Build in engine only function for taking height buffer and generating landscape components
-	Landscape->Import(Landscape->GetLandscapeGuid(), 0, 0, GISData.HeightBufferX - 1,
-		GISData.HeightBufferY - 1, Landscape->NumSubsections, Landscape->SubsectionSizeQuads, HeightmapDataPerLayers,
-		TEXT("NONE"), MaterialLayerDataPerLayer, ELandscapeImportAlphamapType::Layered
-	);
+	// Release the quantized samples now that the heightmap textures have been filled
+	HeightSamples.Empty();
 	
 	// Translate Landscape so that lowest point is 0 in WorldSpace
 	FVector LandscapeOrigin;
@@ -223,26 +487,299 @@ ALandscape* ULandscapeGenerationBPFL::GenerateLandscapeFromGISData(
 	// Fill GIS data into the component
 	GISDataComponent->UpperLeft = UpperLeft;
 	GISDataComponent->LowerRight = LowerRight;
-	GISDataComponent->SetGeoTransforms(uint16Dataset);
-	GISDataComponent->WKT = GISData.ProjectionWKT;
+	GISDataComponent->SetGeoTransforms(UpperLeft, LowerRight, GISData.HeightBufferX, GISData.HeightBufferY);
+	GISDataComponent->SetWKT(GISData.ProjectionWKT);
 	GISDataComponent->NumPixelsX = GISData.HeightBufferX;
 	GISDataComponent->NumPixelsY = GISData.HeightBufferY;
+	GISDataComponent->NormalMap = NormalMap;
+	GISDataComponent->SlopeMap = SlopeMap;
+	GISDataComponent->AmbientOcclusionMap = OcclusionMap;
+	GISDataComponent->UpdateSpatialIndex();
 	
 	Landscape->CreateLandscapeInfo();
 	Landscape->SetActorLabel(LandscapeName);
 	
+	// Record the duration of generation so that future plans can estimate it
+	FGenerationCostCalibration::RecordGeneration(NumSamples, FPlatformTime::Seconds() - StartTime);
 	return Landscape;
 }
 
+FLandscapeGenerationPlan ULandscapeGenerationBPFL::PlanLandscapeGeneration(const FGISRetrievalPlan& RetrievalPlan, const FLandscapeGenerationOptions& Options)
+{
+	FLandscapeGenerationPlan Plan;
+	if (!RetrievalPlan.Error.IsEmpty())
+	{
+		Plan.Error = RetrievalPlan.Error;
+		return Plan;
+	}
+	
+	// Mirror the checks that generation performs before doing any work
+	const bool bImportPaintLayers = (Options.PaintLayers.Num() > 0 && !Options.ClassificationRasterPath.IsEmpty());
+	const bool bGenerateColor = (!bImportPaintLayers && Options.bGenerateColorTexture && RetrievalPlan.ColorSizeX > 0 && RetrievalPlan.ColorSizeY > 0);
+	if (RetrievalPlan.HeightSizeX <= 0 || RetrievalPlan.HeightSizeY <= 0)
+	{
+		Plan.Error = TEXT("Landscape generation requires heightmap data");
+		return Plan;
+	}
+	
+	if (
+		RetrievalPlan.HeightSizeX > LandscapeConstraints::MaxRasterSizeX() ||
+		RetrievalPlan.HeightSizeY > LandscapeConstraints::MaxRasterSizeY() ||
+		(bGenerateColor && RetrievalPlan.ColorSizeX > LandscapeConstraints::MaxRasterSizeX()) ||
+		(bGenerateColor && RetrievalPlan.ColorSizeY > LandscapeConstraints::MaxRasterSizeY())
+	) {
+		Plan.Error = TEXT("Textures too large to allocate in single landscape");
+		return Plan;
+	}
+	
+	// The landscape is imported with one subsection per component, covering the quads between the heightmap samples
+	Plan.ComponentSizeQuads = LandscapeComponentSizeQuads;
+	Plan.NumComponentsX = FMath::DivideAndRoundUp(FMath::Max(RetrievalPlan.HeightSizeX - 1, 1), LandscapeComponentSizeQuads);
+	Plan.NumComponentsY = FMath::DivideAndRoundUp(FMath::Max(RetrievalPlan.HeightSizeY - 1, 1), LandscapeComponentSizeQuads);
+	
+	// Estimate the allocations of each stage that generation will run, in the order that they run
+	const int64 NumSamples = (int64)RetrievalPlan.HeightSizeX * RetrievalPlan.HeightSizeY;
+	const int32 NumLayers = bImportPaintLayers ? Options.PaintLayers.Num() : 0;
+	TArray<TPair<FString, int64>> Stages;
+	if (bGenerateColor) {
+		Stages.Add(TPair<FString, int64>(TEXT("ColorTexture"), FGenerationMemoryBudget::EstimateColorTexture((int64)RetrievalPlan.ColorSizeX * RetrievalPlan.ColorSizeY)));
+	}
+	if (RetrievalPlan.bHeightMayHaveNoData) {
+		Stages.Add(TPair<FString, int64>(TEXT("HoleFilling"), FGenerationMemoryBudget::EstimateHoleFilling(NumSamples)));
+	}
+	Stages.Add(TPair<FString, int64>(TEXT("Quantization"), FGenerationMemoryBudget::EstimateQuantization(NumSamples, RetrievalPlan.bHeightMayHaveNoData)));
+	if (Options.bGenerateDerivedMaps) {
+		Stages.Add(TPair<FString, int64>(TEXT("DerivedMaps"), FGenerationMemoryBudget::EstimateDerivedMaps(NumSamples)));
+	}
+	if (bImportPaintLayers) {
+		Stages.Add(TPair<FString, int64>(TEXT("PaintLayers"), FGenerationMemoryBudget::EstimatePaintLayers(NumSamples, NumLayers)));
+	}
+	Stages.Add(TPair<FString, int64>(TEXT("Import"), FGenerationMemoryBudget::EstimateImport(NumSamples, NumLayers)));
+	
+	// The retrieved data remains resident throughout generation, so it contributes to the peak of every stage
+	int64 LargestStageBytes = 0;
+	for (const TPair<FString, int64>& Stage : Stages)
+	{
+		FLandscapeGenerationStageMemory& StageMemory = Plan.Stages.AddDefaulted_GetRef();
+		StageMemory.Stage = Stage.Key;
+		StageMemory.EstimatedBytes = Stage.Value;
+		LargestStageBytes = FMath::Max(LargestStageBytes, Stage.Value);
+	}
+	
+	Plan.PeakMemoryBytes = RetrievalPlan.GetDataBytes() + LargestStageBytes;
+	Plan.EstimatedSeconds = FGenerationCostCalibration::Load().EstimateGenerationSeconds(NumSamples);
+	
+	// Check the peak against the memory budget (if any), given the memory that is already in use
+	const int64 BudgetBytes = (int64)FMath::Max(Options.MemoryBudgetMB, 0) * 1024 * 1024;
+	const int64 UsedBytes = (int64)FPlatformMemory::GetStats().UsedPhysical;
+	if (BudgetBytes > 0 && UsedBytes + Plan.PeakMemoryBytes > BudgetBytes)
+	{
+		Plan.Error = FString::Printf(
+			TEXT("Generation is estimated to use %.1lf MB at its peak, which would exceed the memory budget of %.1lf MB (%.1lf MB is already in use)"),
+			(double)Plan.PeakMemoryBytes / (1024.0 * 1024.0), (double)BudgetBytes / (1024.0 * 1024.0), (double)UsedBytes / (1024.0 * 1024.0)
+		);
+	}
+	
+	return Plan;
+}
+
+UTexture2D* ULandscapeGenerationBPFL::CreateColorTexture(const FString& LandscapeName, const FGISData& GISData)
+{
+	// Reuse the texture created by a previous run if the colour data is unchanged
+	FString Hash = GeneratedAssetCache::FormatHash(
+		GeneratedAssetCache::HashBuffer(GISData.ColorBuffer.GetData(), GISData.ColorBuffer.Num()),
+		GeneratedAssetCache::HashString(FString::Printf(TEXT("%d,%d,%d"), GISData.ColorBufferX, GISData.ColorBufferY, (int32)GISData.PixelFormat))
+	);
+	
+	FString Prefix = GeneratedAssetCache::GetAssetName(FString::Printf(TEXT("T_%s_GISTexture"), *LandscapeName), Hash);
+	if (UTexture2D* ExistingTexture = GeneratedAssetCache::FindAsset<UTexture2D>(Prefix, Hash)) {
+		return ExistingTexture;
+	}
+	
+	// Textures need to be in BGRA format, so check that the channels of the input data can be reordered before creating any assets
+	if (GISData.PixelFormat != EPixelFormat::PF_B8G8R8A8 && GISData.PixelFormat != EPixelFormat::PF_R8G8B8A8)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Unsupported pixel format for colour data"));
+		return nullptr;
+	}
+	
+	FString PackageName = GeneratedAssetCache::GetPackagePath();
+	
+	// Get unique asset name
+	FString Name;
+	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+	AssetToolsModule.Get().CreateUniqueAssetName(PackageName, Prefix, PackageName, Name);
+	
+	// Create package
+	UPackage* Package = CreatePackage(NULL, *PackageName);
+	Package->FullyLoad();
+	
+	UTexture2D* ColorTexture;
+	
+	UTextureFactory* TextureFactory = NewObject<UTextureFactory>();
+	TextureFactory->AddToRoot();
+	
+	ColorTexture = (UTexture2D*)TextureFactory->CreateTexture2D(
+		Package, *Name, RF_Public | RF_Standalone | RF_Transactional);
+	
+	if (ColorTexture)
+	{
+		// Allocate the texture source without any initial data and fill it directly from the colour buffer in blocks of pixels,
+		// swapping the red and blue channels of RGBA data as we go
+		// (This avoids holding intermediate copies of the colour data, which run to gigabytes for the largest landscapes)
+		ColorTexture->Source.Init(
+			GISData.ColorBufferX,
+			GISData.ColorBufferY,
+			/*NumSlices=*/ 1,
+			/*NumMips=*/ 1,
+			ETextureSourceFormat::TSF_BGRA8,
+			nullptr
+		);
+		
+		const uint8* Source = GISData.ColorBuffer.GetData();
+		uint8* Dest = ColorTexture->Source.LockMip(0);
+		const bool bSwapRedBlue = (GISData.PixelFormat == EPixelFormat::PF_R8G8B8A8);
+		const int64 NumPixels = (int64)GISData.ColorBufferX * GISData.ColorBufferY;
+		const int64 PixelsPerTask = 1 << 18;
+		int32 NumTasks = (int32)FMath::DivideAndRoundUp<int64>(NumPixels, PixelsPerTask);
+		ParallelFor(NumTasks, [&](int32 TaskIndex)
+		{
+			int64 Start = TaskIndex * PixelsPerTask;
+			int64 End = FMath::Min(NumPixels, Start + PixelsPerTask);
+			if (bSwapRedBlue == false)
+			{
+				FMemory::Memcpy(Dest + Start * 4, Source + Start * 4, (End - Start) * 4);
+				return;
+			}
+			
+			for (int64 Pixel = Start; Pixel < End; ++Pixel)
+			{
+				Dest[Pixel * 4 + 0] = Source[Pixel * 4 + 2];
+				Dest[Pixel * 4 + 1] = Source[Pixel * 4 + 1];
+				Dest[Pixel * 4 + 2] = Source[Pixel * 4 + 0];
+				Dest[Pixel * 4 + 3] = Source[Pixel * 4 + 3];
+			}
+		});
+		
+		ColorTexture->Source.UnlockMip(0);
+		ColorTexture->CompressionSettings = TC_Default;
+		ColorTexture->LODGroup = TEXTUREGROUP_World;
+		ColorTexture->MipGenSettings = TMGS_NoMipmaps;
+	}
+	
+	else
+	{
+		TextureFactory->RemoveFromRoot();
+		UE_LOG(LogTemp, Log, TEXT("Failed to create the colour texture"));
+		return nullptr;
+	}
+	
+	GEditor->GetEditorSubsystem<UImportSubsystem>()->BroadcastAssetPostImport(TextureFactory, ColorTexture);
+	
+	ColorTexture->PostEditChange();
+	TextureFactory->RemoveFromRoot();
+	
+	GeneratedAssetCache::SetAssetHash(ColorTexture, Hash);
+	FAssetRegistryModule::AssetCreated(ColorTexture);
+	Package->SetDirtyFlag(true);
+	
+	return ColorTexture;
+}
+
+UMaterial* ULandscapeGenerationBPFL::GenerateLayeredLandscapeMaterial(
+	const FString& LandscapeName, const TArray<FLandCoverPaintLayer>& PaintLayers, float MetresPerQuad)
+{
+	// Reuse the material created by a previous run if the layers and their parameters are unchanged
+	FString Parameters = FString::Printf(TEXT("%f"), MetresPerQuad);
+	for (const FLandCoverPaintLayer& Layer : PaintLayers) {
+		Parameters += FString::Printf(TEXT(";%s,%s,%f"), *Layer.LayerName.ToString(), *GetPathNameSafe(Layer.DetailTexture), Layer.TileSize);
+	}
+	
+	FString Hash = GeneratedAssetCache::FormatHash(GeneratedAssetCache::HashString(Parameters));
+	FString Prefix = GeneratedAssetCache::GetAssetName(FString::Printf(TEXT("M_%s_Layered"), *LandscapeName), Hash);
+	if (UMaterial* ExistingMaterial = GeneratedAssetCache::FindAsset<UMaterial>(Prefix, Hash)) {
+		return ExistingMaterial;
+	}
+	
+	FString PackageName = GeneratedAssetCache::GetPackagePath();
+	
+	// Get unique name
+	FString Name;
+	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+	AssetToolsModule.Get().CreateUniqueAssetName(PackageName, Prefix, PackageName, Name);
+	
+	// Create package
+	UPackage* Package = CreatePackage(NULL, *PackageName);
+	Package->FullyLoad();
+	
+	// Create an unreal material asset
+	auto MaterialFactory = NewObject<UMaterialFactoryNew>();
+	UMaterial* UnrealMaterial = (UMaterial*)MaterialFactory->FactoryCreateNew(UMaterial::StaticClass(), Package, *Name, RF_Standalone | RF_Public, NULL, GWarn);
+	
+	auto LayerBlend = NewObject<UMaterialExpressionLandscapeLayerBlend>(UnrealMaterial);
+	UnrealMaterial->Expressions.Add(LayerBlend);
+	
+	for (const FLandCoverPaintLayer& Layer : PaintLayers)
+	{
+		FLayerBlendInput Input;
+		Input.LayerName = Layer.LayerName;
+		Input.BlendType = LB_WeightBlend;
+		Input.ConstLayerInput = FVector(0.5f);
+		
+		// Tile the detail texture at its real-world size (layer coordinates are measured in landscape quads)
+		if (Layer.DetailTexture != nullptr)
+		{
+			auto LayerCoords = NewObject<UMaterialExpressionLandscapeLayerCoords>(UnrealMaterial);
+			LayerCoords->MappingScale = FMath::Max(Layer.TileSize / MetresPerQuad, KINDA_SMALL_NUMBER);
+			UnrealMaterial->Expressions.Add(LayerCoords);
+			
+			auto Texture = NewObject<UMaterialExpressionTextureSampleParameter2D>(UnrealMaterial);
+			Texture->Texture = Layer.DetailTexture;
+			Texture->ParameterName = FName(*FString::Printf(TEXT("%s_Detail"), *Layer.LayerName.ToString()));
+			Texture->SamplerType = SAMPLERTYPE_Color;
+			Texture->Coordinates.Connect(0, LayerCoords);
+			UnrealMaterial->Expressions.Add(Texture);
+			
+			Input.LayerInput.Connect(0, Texture);
+		}
+		
+		LayerBlend->Layers.Add(Input);
+	}
+	
+	UnrealMaterial->BaseColor.Expression = LayerBlend;
+	
+	// let the material update itself if necessary
+	UnrealMaterial->PreEditChange(NULL);
+	UnrealMaterial->PostEditChange();
+	
+	UnrealMaterial->UpdateCachedExpressionData();
+	
+	GeneratedAssetCache::SetAssetHash(UnrealMaterial, Hash);
+	FAssetRegistryModule::AssetCreated(UnrealMaterial);
+	Package->SetDirtyFlag(true);
+	
+	return UnrealMaterial;
+}
+
 UMaterial* ULandscapeGenerationBPFL::GenerateUnlitLandscapeMaterial(const FString& LandscapeName,
 	const FString& TexturePath, const int32& NumComponentsX, const int32& NumComponentsY, const int32& NumQuads)
 {
-	FString PackageName = "/Game/GISLandscapeData/";
+	// Reuse the material created by a previous run if the texture and parameters are unchanged
+	FString Hash = GeneratedAssetCache::FormatHash(GeneratedAssetCache::HashString(
+		FString::Printf(TEXT("%s,%d,%d,%d"), *TexturePath, NumComponentsX, NumComponentsY, NumQuads)
+	));
+	
+	FString Prefix = GeneratedAssetCache::GetAssetName(FString::Printf(TEXT("M_%s_Unlit"), *LandscapeName), Hash);
+	if (UMaterial* ExistingMaterial = GeneratedAssetCache::FindAsset<UMaterial>(Prefix, Hash)) {
+		return ExistingMaterial;
+	}
+	
+	FString PackageName = GeneratedAssetCache::GetPackagePath();
 	
 	// Get unique name
 	FString Name;
 	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
-	AssetToolsModule.Get().CreateUniqueAssetName(PackageName, FString::Printf(TEXT("M_%s_Unlit"), *LandscapeName), PackageName, Name);
+	AssetToolsModule.Get().CreateUniqueAssetName(PackageName, Prefix, PackageName, Name);
 	
 	UMaterial* UnrealMaterial;
 	
@@ -298,6 +835,7 @@ UMaterial* ULandscapeGenerationBPFL::GenerateUnlitLandscapeMaterial(const FStrin
 	
 	UnrealMaterial->UpdateCachedExpressionData();
 	
+	GeneratedAssetCache::SetAssetHash(UnrealMaterial, Hash);
 	FAssetRegistryModule::AssetCreated(UnrealMaterial);
 	Package->SetDirtyFlag(true);
 	
@@ -0,0 +1,72 @@
+#include "LandscapeSurface.h"
+#include "Landscape.h"
+#include "LandscapeDataAccess.h"
+#include "LandscapeEdit.h"
+#include "LandscapeInfo.h"
+#include "GISDataComponent.h"
+
+bool FLandscapeSurface::ReadFromLandscape(ALandscape* Landscape)
+{
+	UGISDataComponent* GISDataComponent = (Landscape != nullptr) ? Landscape->FindComponentByClass<UGISDataComponent>() : nullptr;
+	ULandscapeInfo* LandscapeInfo = (Landscape != nullptr) ? Landscape->GetLandscapeInfo() : nullptr;
+	if (GISDataComponent == nullptr || LandscapeInfo == nullptr || GISDataComponent->GetInvGeoTransform().Num() != 6) {
+		return false;
+	}
+	
+	int32 MaxX;
+	int32 MaxY;
+	if (LandscapeInfo->GetLandscapeExtent(this->MinX, this->MinY, MaxX, MaxY) == false) {
+		return false;
+	}
+	
+	this->SizeX = MaxX - this->MinX + 1;
+	this->SizeY = MaxY - this->MinY + 1;
+	this->Heights.SetNumZeroed(this->SizeX * this->SizeY);
+	FLandscapeEditDataInterface LandscapeEdit(LandscapeInfo);
+	LandscapeEdit.GetHeightDataFast(this->MinX, this->MinY, MaxX, MaxY, this->Heights.GetData(), 0);
+	
+	this->WKT = GISDataComponent->WKT;
+	this->UpperLeft = GISDataComponent->UpperLeft;
+	this->LowerRight = GISDataComponent->LowerRight;
+	this->InvGeoTransform = GISDataComponent->GetInvGeoTransform();
+	this->Transform = Landscape->GetActorTransform();
+	return true;
+}
+
+FVector FLandscapeSurface::ProjectedToWorld(double X, double Y) const
+{
+	FVector2D Vertex = this->ProjectedToVertex(X, Y);
+	return this->Transform.TransformPosition(FVector(Vertex, this->SampleLocalHeight(Vertex.X, Vertex.Y)));
+}
+
+FVector FLandscapeSurface::GetNormal(double X, double Y) const
+{
+	// Compute the normal from central differences of the surface one vertex either side of the specified location
+	FVector2D Vertex = this->ProjectedToVertex(X, Y);
+	FVector Left = this->Transform.TransformPosition(FVector(Vertex.X - 1.0f, Vertex.Y, this->SampleLocalHeight(Vertex.X - 1.0f, Vertex.Y)));
+	FVector Right = this->Transform.TransformPosition(FVector(Vertex.X + 1.0f, Vertex.Y, this->SampleLocalHeight(Vertex.X + 1.0f, Vertex.Y)));
+	FVector Up = this->Transform.TransformPosition(FVector(Vertex.X, Vertex.Y - 1.0f, this->SampleLocalHeight(Vertex.X, Vertex.Y - 1.0f)));
+	FVector Down = this->Transform.TransformPosition(FVector(Vertex.X, Vertex.Y + 1.0f, this->SampleLocalHeight(Vertex.X, Vertex.Y + 1.0f)));
+	return FVector::CrossProduct(Right - Left, Down - Up).GetSafeNormal();
+}
+
+FVector2D FLandscapeSurface::ProjectedToVertex(double X, double Y) const
+{
+	return FVector2D(
+		this->InvGeoTransform[0] + X * this->InvGeoTransform[1] + Y * this->InvGeoTransform[2],
+		this->InvGeoTransform[3] + X * this->InvGeoTransform[4] + Y * this->InvGeoTransform[5]
+	);
+}
+
+float FLandscapeSurface::SampleLocalHeight(double X, double Y) const
+{
+	X = FMath::Clamp(X - this->MinX, 0.0, (double)(this->SizeX - 1));
+	Y = FMath::Clamp(Y - this->MinY, 0.0, (double)(this->SizeY - 1));
+	int32 X0 = FMath::FloorToInt(X);
+	int32 Y0 = FMath::FloorToInt(Y);
+	int32 X1 = FMath::Min(X0 + 1, this->SizeX - 1);
+	int32 Y1 = FMath::Min(Y0 + 1, this->SizeY - 1);
+	float Top = FMath::Lerp((float)this->Heights[Y0 * this->SizeX + X0], (float)this->Heights[Y0 * this->SizeX + X1], (float)(X - X0));
+	float Bottom = FMath::Lerp((float)this->Heights[Y1 * this->SizeX + X0], (float)this->Heights[Y1 * this->SizeX + X1], (float)(X - X0));
+	return (FMath::Lerp(Top, Bottom, (float)(Y - Y0)) - LandscapeDataAccess::MidValue) * LANDSCAPE_ZSCALE;
+}
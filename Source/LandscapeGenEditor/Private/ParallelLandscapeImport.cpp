@@ -0,0 +1,118 @@
+#include "ParallelLandscapeImport.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Texture2D.h"
+#include "Landscape.h"
+#include "LandscapeComponent.h"
+#include "LandscapeDataAccess.h"
+#include "LandscapeInfo.h"
+
+namespace
+{
+	// Returns the quantized height of the specified vertex, clamping the vertex to the edges of the heightmap
+	FORCEINLINE uint16 GetSample(const TArray<uint16>& HeightSamples, int32 SizeX, int32 SizeY, int32 X, int32 Y) {
+		return HeightSamples[FMath::Clamp(Y, 0, SizeY - 1) * SizeX + FMath::Clamp(X, 0, SizeX - 1)];
+	}
+	
+	// Computes the normal of the landscape at the specified vertex in the landscape's scaled local space, using the central
+	// differences of the neighbouring heights (or one-sided differences at the edges of the heightmap)
+	FVector ComputeNormal(const TArray<uint16>& HeightSamples, int32 SizeX, int32 SizeY, int32 X, int32 Y, const FVector& Scale)
+	{
+		int32 Left = FMath::Clamp(X - 1, 0, SizeX - 1);
+		int32 Right = FMath::Clamp(X + 1, 0, SizeX - 1);
+		int32 Up = FMath::Clamp(Y - 1, 0, SizeY - 1);
+		int32 Down = FMath::Clamp(Y + 1, 0, SizeY - 1);
+		
+		float DeltaX = LandscapeDataAccess::GetLocalHeight(GetSample(HeightSamples, SizeX, SizeY, Right, Y)) - LandscapeDataAccess::GetLocalHeight(GetSample(HeightSamples, SizeX, SizeY, Left, Y));
+		float DeltaY = LandscapeDataAccess::GetLocalHeight(GetSample(HeightSamples, SizeX, SizeY, X, Down)) - LandscapeDataAccess::GetLocalHeight(GetSample(HeightSamples, SizeX, SizeY, X, Up));
+		float SlopeX = (Right > Left) ? (DeltaX * Scale.Z) / ((Right - Left) * Scale.X) : 0.0f;
+		float SlopeY = (Down > Up) ? (DeltaY * Scale.Z) / ((Down - Up) * Scale.Y) : 0.0f;
+		return FVector(-SlopeX, -SlopeY, 1.0f).GetSafeNormal();
+	}
+}
+
+void ParallelLandscapeImport::ImportHeightmap(ALandscape* Landscape, const TArray<uint16>& HeightSamples, int32 SizeX, int32 SizeY)
+{
+	check(Landscape->NumSubsections == 1 && Landscape->LandscapeComponents.Num() == 0)
+	check((int64)SizeX * SizeY == HeightSamples.Num())
+	
+	const int32 ComponentSizeQuads = Landscape->ComponentSizeQuads;
+	const int32 ComponentSizeVerts = ComponentSizeQuads + 1;
+	const int32 NumComponentsX = FMath::DivideAndRoundUp(FMath::Max(SizeX - 1, 1), ComponentSizeQuads);
+	const int32 NumComponentsY = FMath::DivideAndRoundUp(FMath::Max(SizeY - 1, 1), ComponentSizeQuads);
+	const int32 TextureSize = FMath::RoundUpToPowerOfTwo(ComponentSizeVerts);
+	const FVector Scale = Landscape->GetRootComponent()->GetRelativeScale3D();
+	
+	// Create the components and their heightmap textures on the game thread, since objects cannot be created by worker threads
+	// (Each component receives its own heightmap texture, whose mips are locked so that the worker threads can fill them)
+	TArray<ULandscapeComponent*> Components;
+	TArray<TArray<FColor*>> MipData;
+	for (int32 ComponentY = 0; ComponentY < NumComponentsY; ++ComponentY)
+	{
+		for (int32 ComponentX = 0; ComponentX < NumComponentsX; ++ComponentX)
+		{
+			ULandscapeComponent* Component = NewObject<ULandscapeComponent>(Landscape, NAME_None, RF_Transactional);
+			Landscape->LandscapeComponents.Add(Component);
+			Component->Init(ComponentX * ComponentSizeQuads, ComponentY * ComponentSizeQuads, ComponentSizeQuads, Landscape->NumSubsections, Landscape->SubsectionSizeQuads);
+			Component->SetupAttachment(Landscape->GetRootComponent());
+			Component->UpdatedSharedPropertiesFromActor();
+			
+			UTexture2D* Heightmap = Landscape->CreateLandscapeTexture(TextureSize, TextureSize, TEXTUREGROUP_Terrain_Heightmap, TSF_BGRA8);
+			Component->SetHeightmap(Heightmap);
+			Component->HeightmapScaleBias = FVector4(1.0f / TextureSize, 1.0f / TextureSize, 0.0f, 0.0f);
+			
+			TArray<FColor*>& Mips = MipData.AddDefaulted_GetRef();
+			for (int32 Mip = 0; Mip < Heightmap->Source.GetNumMips(); ++Mip) {
+				Mips.Add((FColor*)Heightmap->Source.LockMip(Mip));
+			}
+			
+			Components.Add(Component);
+		}
+	}
+	
+	// Fill the heights and normals of each component and generate its mips in parallel (each component writes only to its own texture)
+	// (Heights are packed into the red and green channels and the X and Y components of the normal into the blue and alpha channels)
+	ParallelFor(Components.Num(), [&](int32 ComponentIndex)
+	{
+		ULandscapeComponent* Component = Components[ComponentIndex];
+		FColor* Texels = MipData[ComponentIndex][0];
+		for (int32 Y = 0; Y < ComponentSizeVerts; ++Y)
+		{
+			for (int32 X = 0; X < ComponentSizeVerts; ++X)
+			{
+				int32 VertexX = Component->SectionBaseX + X;
+				int32 VertexY = Component->SectionBaseY + Y;
+				uint16 Height = GetSample(HeightSamples, SizeX, SizeY, VertexX, VertexY);
+				FVector Normal = ComputeNormal(HeightSamples, SizeX, SizeY, VertexX, VertexY, Scale);
+				
+				FColor& Texel = Texels[Y * TextureSize + X];
+				Texel.R = Height >> 8;
+				Texel.G = Height & 255;
+				Texel.B = FMath::RoundToInt(127.5f * (Normal.X + 1.0f));
+				Texel.A = FMath::RoundToInt(127.5f * (Normal.Y + 1.0f));
+			}
+		}
+		
+		Component->GenerateHeightmapMips(MipData[ComponentIndex]);
+	});
+	
+	for (ULandscapeComponent* Component : Components)
+	{
+		UTexture2D* Heightmap = Component->GetHeightmap();
+		for (int32 Mip = 0; Mip < Heightmap->Source.GetNumMips(); ++Mip) {
+			Heightmap->Source.UnlockMip(Mip);
+		}
+		
+		Heightmap->PostEditChange();
+	}
+	
+	// Register the components with the landscape, then build their bounds, material instances and collision
+	Landscape->CreateLandscapeInfo();
+	Landscape->RegisterAllComponents();
+	for (ULandscapeComponent* Component : Components)
+	{
+		Component->UpdateCachedBounds();
+		Component->UpdateBounds();
+		Component->UpdateMaterialInstances();
+		Component->UpdateCollisionData(true);
+	}
+}
@@ -0,0 +1,196 @@
+#include "TerrainDerivatives.h"
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+
+namespace
+{
+	// The number of rows processed by each parallel task
+	const int32 RowsPerTask = 64;
+	
+	// The number of samples of padding on either side of each row of heights, so that the stencils can read the neighbours of the
+	// edge samples and four-wide vector loads never read past the end of a row
+	const int32 RowPadding = 4;
+	
+	// Converts a row of quantized samples to heights in metres, replicating the edge samples into the padding
+	void LoadRow(const uint16* Samples, int32 SizeX, float MetresPerStep, float* OutRow)
+	{
+		for (int32 X = 0; X < SizeX; ++X) {
+			OutRow[RowPadding + X] = Samples[X] * MetresPerStep;
+		}
+		
+		for (int32 Pad = 0; Pad < RowPadding; ++Pad)
+		{
+			OutRow[Pad] = OutRow[RowPadding];
+			OutRow[RowPadding + SizeX + Pad] = OutRow[RowPadding + SizeX - 1];
+		}
+	}
+	
+	// Computes the sum of the quantized samples within the specified radius of each sample of a row, clamped to the edges of the row
+	void ComputeWindowSums(const uint16* Samples, int32 SizeX, int32 Radius, TArray<uint32>& Prefix, TArray<uint32>& OutSums)
+	{
+		Prefix[0] = 0;
+		for (int32 X = 0; X < SizeX; ++X) {
+			Prefix[X + 1] = Prefix[X] + Samples[X];
+		}
+		
+		for (int32 X = 0; X < SizeX; ++X) {
+			OutSums[X] = Prefix[FMath::Min(X + Radius, SizeX - 1) + 1] - Prefix[FMath::Max(X - Radius, 0)];
+		}
+	}
+	
+	// Maps a value in the range [-1,1] to [0,255]
+	FORCEINLINE uint8 EncodeSigned(float Value) {
+		return (uint8)FMath::Clamp(FMath::RoundToInt((Value * 0.5f + 0.5f) * 255.0f), 0, 255);
+	}
+	
+	// Maps a value in the range [0,1] to [0,255]
+	FORCEINLINE uint8 EncodeUnsigned(float Value) {
+		return (uint8)FMath::Clamp(FMath::RoundToInt(Value * 255.0f), 0, 255);
+	}
+	
+	// Computes the normals and slope angles of a block of rows from the central differences of the heights around each sample
+	void ComputeNormalsAndSlope(const TArray<uint16>& Samples, int32 SizeX, int32 SizeY, const FVector2D& MetresPerSample, float MetresPerStep,
+		int32 StartRow, int32 EndRow, uint8* OutNormals, uint8* OutSlope)
+	{
+		// Keep the rows above, at and below the current row, clamping at the top and bottom edges of the heightmap
+		const int32 PaddedSizeX = SizeX + RowPadding * 2;
+		TArray<float> Rows;
+		Rows.SetNumUninitialized(PaddedSizeX * 3);
+		float* Above = Rows.GetData();
+		float* Current = Above + PaddedSizeX;
+		float* Below = Current + PaddedSizeX;
+		LoadRow(&Samples[FMath::Max(StartRow - 1, 0) * SizeX], SizeX, MetresPerStep, Above);
+		LoadRow(&Samples[StartRow * SizeX], SizeX, MetresPerStep, Current);
+		
+		const VectorRegister InvTwoDX = VectorSetFloat1(1.0f / (2.0f * MetresPerSample.X));
+		const VectorRegister InvTwoDY = VectorSetFloat1(1.0f / (2.0f * MetresPerSample.Y));
+		const VectorRegister One = VectorOne();
+		for (int32 Row = StartRow; Row < EndRow; ++Row)
+		{
+			LoadRow(&Samples[FMath::Min(Row + 1, SizeY - 1) * SizeX], SizeX, MetresPerStep, Below);
+			
+			for (int32 X = 0; X < SizeX; X += 4)
+			{
+				// The normal of the surface z = h(x,y) is the normalised vector (-dh/dx, -dh/dy, 1)
+				const float* Centre = Current + RowPadding + X;
+				VectorRegister GradX = VectorMultiply(VectorSubtract(VectorLoad(Centre + 1), VectorLoad(Centre - 1)), InvTwoDX);
+				VectorRegister GradY = VectorMultiply(VectorSubtract(VectorLoad(Below + RowPadding + X), VectorLoad(Above + RowPadding + X)), InvTwoDY);
+				VectorRegister InvLength = VectorReciprocalSqrtAccurate(VectorMultiplyAdd(GradX, GradX, VectorMultiplyAdd(GradY, GradY, One)));
+				
+				float NormalX[4];
+				float NormalY[4];
+				float NormalZ[4];
+				VectorStore(VectorNegate(VectorMultiply(GradX, InvLength)), NormalX);
+				VectorStore(VectorNegate(VectorMultiply(GradY, InvLength)), NormalY);
+				VectorStore(InvLength, NormalZ);
+				
+				int32 NumLanes = FMath::Min(4, SizeX - X);
+				for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+				{
+					int64 Index = (int64)Row * SizeX + X + Lane;
+					if (OutNormals != nullptr)
+					{
+						OutNormals[Index * 4 + 0] = EncodeSigned(NormalZ[Lane]);
+						OutNormals[Index * 4 + 1] = EncodeSigned(NormalY[Lane]);
+						OutNormals[Index * 4 + 2] = EncodeSigned(NormalX[Lane]);
+						OutNormals[Index * 4 + 3] = 255;
+					}
+					
+					if (OutSlope != nullptr)
+					{
+						float Slope = FMath::Atan2(FMath::Sqrt(NormalX[Lane] * NormalX[Lane] + NormalY[Lane] * NormalY[Lane]), NormalZ[Lane]);
+						OutSlope[Index] = EncodeUnsigned(FMath::RadiansToDegrees(Slope) / 90.0f);
+					}
+				}
+			}
+			
+			// Rotate the rows so that the current row becomes the row above and the row below becomes the current row
+			float* Previous = Above;
+			Above = Current;
+			Current = Below;
+			Below = Previous;
+		}
+	}
+	
+	// Computes the ambient occlusion of a block of rows from the mean height of the square window of samples around each sample
+	// (The window sums are maintained incrementally as the window slides down the rows, so the cost is independent of the radius)
+	void ComputeOcclusion(const TArray<uint16>& Samples, int32 SizeX, int32 SizeY, float MetresPerStep, int32 Radius, float RadiusMetres,
+		int32 StartRow, int32 EndRow, uint8* OutOcclusion)
+	{
+		TArray<uint32> Prefix;
+		TArray<uint32> RowSums;
+		TArray<uint32> WindowSums;
+		Prefix.SetNumUninitialized(SizeX + 1);
+		RowSums.SetNumUninitialized(SizeX);
+		WindowSums.SetNumZeroed(SizeX);
+		
+		for (int32 Row = FMath::Max(StartRow - Radius, 0); Row <= FMath::Min(StartRow + Radius, SizeY - 1); ++Row)
+		{
+			ComputeWindowSums(&Samples[Row * SizeX], SizeX, Radius, Prefix, RowSums);
+			for (int32 X = 0; X < SizeX; ++X) {
+				WindowSums[X] += RowSums[X];
+			}
+		}
+		
+		for (int32 Row = StartRow; Row < EndRow; ++Row)
+		{
+			// Slide the window down to the current row
+			if (Row > StartRow)
+			{
+				if (Row + Radius < SizeY)
+				{
+					ComputeWindowSums(&Samples[(Row + Radius) * SizeX], SizeX, Radius, Prefix, RowSums);
+					for (int32 X = 0; X < SizeX; ++X) {
+						WindowSums[X] += RowSums[X];
+					}
+				}
+				
+				if (Row - Radius - 1 >= 0)
+				{
+					ComputeWindowSums(&Samples[(Row - Radius - 1) * SizeX], SizeX, Radius, Prefix, RowSums);
+					for (int32 X = 0; X < SizeX; ++X) {
+						WindowSums[X] -= RowSums[X];
+					}
+				}
+			}
+			
+			// Terrain that lies below the mean height of its surroundings is occluded by the cosine of the mean elevation angle of the
+			// surrounding terrain, while terrain at or above the mean height is unoccluded
+			int32 NumRows = FMath::Min(Row + Radius, SizeY - 1) - FMath::Max(Row - Radius, 0) + 1;
+			for (int32 X = 0; X < SizeX; ++X)
+			{
+				int32 NumColumns = FMath::Min(X + Radius, SizeX - 1) - FMath::Max(X - Radius, 0) + 1;
+				int64 Index = (int64)Row * SizeX + X;
+				float Mean = (float)WindowSums[X] / (float)(NumRows * NumColumns);
+				float Elevation = FMath::Max(Mean - (float)Samples[Index], 0.0f) * MetresPerStep / RadiusMetres;
+				OutOcclusion[Index] = EncodeUnsigned(FMath::InvSqrt(1.0f + Elevation * Elevation));
+			}
+		}
+	}
+}
+
+void TerrainDerivatives::ComputeMaps(const TArray<uint16>& Samples, int32 SizeX, int32 SizeY, const FVector2D& MetresPerSample,
+	float MetresPerStep, float OcclusionRadius, uint8* OutNormals, uint8* OutSlope, uint8* OutOcclusion)
+{
+	check((int64)SizeX * SizeY == Samples.Num())
+	
+	// Convert the occlusion radius to samples, measuring it along the axis with the finer sample spacing
+	float SampleSpacing = FMath::Max(FMath::Min(MetresPerSample.X, MetresPerSample.Y), KINDA_SMALL_NUMBER);
+	int32 Radius = FMath::Clamp(FMath::RoundToInt(OcclusionRadius / SampleSpacing), 1, MaxOcclusionRadiusSamples);
+	float RadiusMetres = Radius * SampleSpacing;
+	
+	// Process each block of rows in parallel (each block writes to a disjoint region of the outputs)
+	int32 NumTasks = FMath::DivideAndRoundUp(SizeY, RowsPerTask);
+	ParallelFor(NumTasks, [&](int32 TaskIndex)
+	{
+		int32 StartRow = TaskIndex * RowsPerTask;
+		int32 EndRow = FMath::Min(StartRow + RowsPerTask, SizeY);
+		if (OutNormals != nullptr || OutSlope != nullptr) {
+			ComputeNormalsAndSlope(Samples, SizeX, SizeY, MetresPerSample, MetresPerStep, StartRow, EndRow, OutNormals, OutSlope);
+		}
+		
+		if (OutOcclusion != nullptr) {
+			ComputeOcclusion(Samples, SizeX, SizeY, MetresPerStep, Radius, RadiusMetres, StartRow, EndRow, OutOcclusion);
+		}
+	});
+}
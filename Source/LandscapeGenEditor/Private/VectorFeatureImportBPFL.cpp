@@ -0,0 +1,409 @@
+#include "VectorFeatureImportBPFL.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Components/SplineComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Landscape.h"
+
+#include "GDALHeaders.h"
+#include "GDALHelpers.h"
+#include "LandscapeGenRuntime.h"
+#include "LandscapeSurface.h"
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+	// The world space geometry extracted from a batch of features
+	struct FVectorFeatureBatch
+	{
+		TArray<FTransform> PointInstances;
+		TArray<FTransform> PolygonInstances;
+		TArray<TArray<FVector>> Splines;
+		TArray<bool> SplineClosedLoops;
+		FString Error;
+	};
+	
+	// Holds a copy of the import options along with the values required by the worker threads
+	struct FVectorFeatureImportRequest
+	{
+		FString DatasetPath;
+		FVectorFeatureImportOptions Options;
+		FBox PolygonMeshBounds;
+	};
+	
+	struct FCoordinateTransformationDeleter
+	{
+		void operator()(OGRCoordinateTransformation* Transformation) const {
+			OGRCoordinateTransformation::DestroyCT(Transformation);
+		}
+	};
+	
+	struct FFeatureDeleter
+	{
+		void operator()(OGRFeature* Feature) const {
+			OGRFeature::DestroyFeature(Feature);
+		}
+	};
+	
+	struct FGeometryDeleter
+	{
+		void operator()(OGRGeometry* Geometry) const {
+			OGRGeometryFactory::destroyGeometry(Geometry);
+		}
+	};
+	
+	struct FSpatialReferenceDeleter
+	{
+		void operator()(OGRSpatialReference* SpatialReference) const {
+			SpatialReference->Release();
+		}
+	};
+	
+	// The geometry and attributes of a feature that has been read from the dataset but not yet transformed
+	struct FPendingFeature
+	{
+		std::unique_ptr<OGRGeometry, FGeometryDeleter> Geometry;
+		GIntBig FeatureID;
+		float Height;
+	};
+	
+	// A batch of features that have been read from the dataset, along with a copy of the layer's coordinate system (if any)
+	struct FPendingFeatureBatch
+	{
+		std::vector<FPendingFeature> Features;
+		std::unique_ptr<OGRSpatialReference, FSpatialReferenceDeleter> LayerSRS;
+	};
+	
+	// Opens a vector dataset and selects the requested layer, applying the attribute filter
+	OGRLayer* OpenLayer(const FVectorFeatureImportRequest& Request, GDALDatasetRef& Dataset, FString& Error)
+	{
+		FLandscapeGenRuntimeModule::EnsureGDALInitialized();
+		Dataset = GDALDatasetRef((GDALDataset*)GDALOpenEx(TCHAR_TO_UTF8(*Request.DatasetPath), GDAL_OF_VECTOR | GDAL_OF_READONLY, nullptr, nullptr, nullptr));
+		if (!Dataset)
+		{
+			Error = FString::Printf(TEXT("Failed to open vector dataset \"%s\""), *Request.DatasetPath);
+			return nullptr;
+		}
+		
+		OGRLayer* Layer = Request.Options.LayerName.IsEmpty() ? Dataset->GetLayer(0) : Dataset->GetLayerByName(TCHAR_TO_UTF8(*Request.Options.LayerName));
+		if (Layer == nullptr)
+		{
+			Error = FString::Printf(TEXT("Failed to open layer \"%s\" of vector dataset \"%s\""), *Request.Options.LayerName, *Request.DatasetPath);
+			return nullptr;
+		}
+		
+		if (!Request.Options.AttributeFilter.IsEmpty() && Layer->SetAttributeFilter(TCHAR_TO_UTF8(*Request.Options.AttributeFilter)) != OGRERR_NONE)
+		{
+			Error = FString::Printf(TEXT("Invalid attribute filter \"%s\""), *Request.Options.AttributeFilter);
+			return nullptr;
+		}
+		
+		return Layer;
+	}
+	
+	// Extracts the world space geometry from a single feature geometry (recursing into geometry collections)
+	void ExtractGeometry(const FVectorFeatureImportRequest& Request, const FLandscapeSurface& Surface, const OGRGeometry* Geometry, GIntBig FeatureID, float Height, FVectorFeatureBatch& Batch)
+	{
+		const FVectorFeatureImportOptions& Options = Request.Options;
+		FRandomStream Random((int32)FeatureID);
+		
+		switch (wkbFlatten(Geometry->getGeometryType()))
+		{
+			case wkbPoint:
+			{
+				if (Options.PointMesh != nullptr)
+				{
+					const OGRPoint* Point = static_cast<const OGRPoint*>(Geometry);
+					FRotator Rotation(0.0f, Options.bRandomYaw ? Random.FRandRange(0.0f, 360.0f) : 0.0f, 0.0f);
+					Batch.PointInstances.Add(FTransform(Rotation, Surface.ProjectedToWorld(Point->getX(), Point->getY())));
+				}
+				
+				break;
+			}
+			
+			case wkbLineString:
+			{
+				const OGRLineString* Line = static_cast<const OGRLineString*>(Geometry);
+				if (Line->getNumPoints() < 2) {
+					break;
+				}
+				
+				if (Options.bCreateSplines)
+				{
+					TArray<FVector>& Spline = Batch.Splines.AddDefaulted_GetRef();
+					Batch.SplineClosedLoops.Add(false);
+					for (int Index = 0; Index < Line->getNumPoints(); ++Index) {
+						Spline.Add(Surface.ProjectedToWorld(Line->getX(Index), Line->getY(Index)));
+					}
+				}
+				
+				// Place instances at regular intervals along the line, oriented along the direction of each segment
+				if (Options.PointMesh != nullptr && Options.LineInstanceSpacing > 0.0f)
+				{
+					// (The offset of the next instance carries over from one segment to the next, so spacing is continuous around vertices)
+					double Offset = 0.0;
+					for (int Index = 1; Index < Line->getNumPoints(); ++Index)
+					{
+						FVector2D Start(Line->getX(Index - 1), Line->getY(Index - 1));
+						FVector2D End(Line->getX(Index), Line->getY(Index));
+						double Length = FVector2D::Distance(Start, End);
+						FVector Direction = Surface.ProjectedToWorld(End.X, End.Y) - Surface.ProjectedToWorld(Start.X, Start.Y);
+						FRotator Rotation(0.0f, Direction.Rotation().Yaw, 0.0f);
+						for (; Offset < Length; Offset += Options.LineInstanceSpacing)
+						{
+							FVector2D Location = FMath::Lerp(Start, End, (float)(Offset / Length));
+							Batch.PointInstances.Add(FTransform(Rotation, Surface.ProjectedToWorld(Location.X, Location.Y)));
+						}
+						
+						Offset -= Length;
+					}
+				}
+				
+				break;
+			}
+			
+			case wkbPolygon:
+			{
+				const OGRLinearRing* Ring = static_cast<const OGRPolygon*>(Geometry)->getExteriorRing();
+				if (Ring == nullptr || Ring->getNumPoints() < 3) {
+					break;
+				}
+				
+				// Project the outer ring, omitting the closing point since splines are closed loops
+				TArray<FVector> Points;
+				FBox Bounds(ForceInit);
+				for (int Index = 0; Index < Ring->getNumPoints() - 1; ++Index)
+				{
+					Points.Add(Surface.ProjectedToWorld(Ring->getX(Index), Ring->getY(Index)));
+					Bounds += Points.Last();
+				}
+				
+				// Scale the polygon mesh to fit the footprint, resting its base on the lowest point of the outer ring
+				if (Options.PolygonMesh != nullptr)
+				{
+					FVector MeshSize = Request.PolygonMeshBounds.GetSize().ComponentMax(FVector(KINDA_SMALL_NUMBER));
+					FVector Scale(Bounds.GetSize().X / MeshSize.X, Bounds.GetSize().Y / MeshSize.Y, (Height * 100.0f) / MeshSize.Z);
+					FVector MeshCentre = Request.PolygonMeshBounds.GetCenter() * Scale;
+					FVector Location(Bounds.GetCenter().X - MeshCentre.X, Bounds.GetCenter().Y - MeshCentre.Y, Bounds.Min.Z - Request.PolygonMeshBounds.Min.Z * Scale.Z);
+					Batch.PolygonInstances.Add(FTransform(FQuat::Identity, Location, Scale));
+				}
+				
+				if (Options.bCreateSplines)
+				{
+					Batch.Splines.Add(MoveTemp(Points));
+					Batch.SplineClosedLoops.Add(true);
+				}
+				
+				break;
+			}
+			
+			case wkbMultiPoint:
+			case wkbMultiLineString:
+			case wkbMultiPolygon:
+			case wkbGeometryCollection:
+			{
+				const OGRGeometryCollection* Collection = static_cast<const OGRGeometryCollection*>(Geometry);
+				for (int Index = 0; Index < Collection->getNumGeometries(); ++Index) {
+					ExtractGeometry(Request, Surface, Collection->getGeometryRef(Index), FeatureID, Height, Batch);
+				}
+				
+				break;
+			}
+			
+			default:
+				break;
+		}
+	}
+	
+	// Transforms and extracts the geometry of a batch of features that have already been read from the dataset
+	// (Each batch creates its own coordinate transformation from its own copy of the layer's coordinate system, since neither can be
+	// shared between threads)
+	void ImportBatch(const FVectorFeatureImportRequest& Request, const FLandscapeSurface& Surface, FPendingFeatureBatch& Pending, FVectorFeatureBatch& Batch)
+	{
+		// Create the transformation from the layer's coordinate system to the landscape's (layers without one are assumed to match the landscape)
+		OGRSpatialReference LandscapeSRS;
+		if (LandscapeSRS.SetFromUserInput(TCHAR_TO_UTF8(*Surface.GetWKT())) != OGRERR_NONE)
+		{
+			Batch.Error = TEXT("Failed to parse the projected coordinate system of the landscape");
+			return;
+		}
+		
+		#if GDAL_VERSION_NUM >= GDAL_COMPUTE_VERSION(3,0,0)
+			LandscapeSRS.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+		#endif
+		
+		std::unique_ptr<OGRCoordinateTransformation, FCoordinateTransformationDeleter> Transformation;
+		if (Pending.LayerSRS)
+		{
+			Transformation.reset(OGRCreateCoordinateTransformation(Pending.LayerSRS.get(), &LandscapeSRS));
+			if (!Transformation)
+			{
+				Batch.Error = TEXT("Failed to create the transformation from the coordinate system of the layer to that of the landscape");
+				return;
+			}
+		}
+		
+		for (FPendingFeature& Feature : Pending.Features)
+		{
+			if (Transformation && Feature.Geometry->transform(Transformation.get()) != OGRERR_NONE) {
+				continue;
+			}
+			
+			ExtractGeometry(Request, Surface, Feature.Geometry.get(), Feature.FeatureID, Feature.Height, Batch);
+		}
+		
+		// Release the source geometry as soon as it has been extracted
+		Pending.Features.clear();
+	}
+	
+	// Creates a hierarchical instanced static mesh component holding the specified instances
+	void CreateInstances(AActor* Actor, UStaticMesh* Mesh, const TArray<FVectorFeatureBatch>& Batches, TArray<FTransform> FVectorFeatureBatch::*Instances)
+	{
+		UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(Actor, NAME_None, RF_Transactional);
+		Component->SetStaticMesh(Mesh);
+		Component->bAutoRebuildTreeOnInstanceChanges = false;
+		Component->SetupAttachment(Actor->GetRootComponent());
+		Component->RegisterComponent();
+		Actor->AddInstanceComponent(Component);
+		
+		// Add all of the instances before building the cluster tree once, rather than rebuilding it for each instance
+		for (const FVectorFeatureBatch& Batch : Batches)
+		{
+			for (const FTransform& Instance : Batch.*Instances) {
+				Component->AddInstanceWorldSpace(Instance);
+			}
+		}
+		
+		Component->BuildTreeIfOutdated(false, true);
+	}
+}
+
+AActor* UVectorFeatureImportBPFL::ImportVectorFeatures(
+	const UObject* WorldContext, ALandscape* Landscape, const FString& DatasetPath, const FVectorFeatureImportOptions& Options)
+{
+	// Read the landscape's heightmap so that the worker threads can drape features over the landscape without performing traces
+	FLandscapeSurface Surface;
+	if (Surface.ReadFromLandscape(Landscape) == false)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Vector feature import requires a landscape generated from GIS data"));
+		return nullptr;
+	}
+	
+	FVectorFeatureImportRequest Request;
+	Request.DatasetPath = DatasetPath;
+	Request.Options = Options;
+	Request.Options.FeaturesPerBatch = FMath::Max(Options.FeaturesPerBatch, 1);
+	Request.PolygonMeshBounds = (Options.PolygonMesh != nullptr) ? Options.PolygonMesh->GetBoundingBox() : FBox(ForceInit);
+	
+	GDALDatasetRef Dataset;
+	FString Error;
+	OGRLayer* Layer = OpenLayer(Request, Dataset, Error);
+	if (Layer == nullptr)
+	{
+		UE_LOG(LogTemp, Log, TEXT("%s"), *Error);
+		return nullptr;
+	}
+	
+	// Read the features in a single sequential pass over the layer, since seeking is expensive for many formats (GeoJSON files are
+	// parsed in full whenever they are opened, and SQL-based formats such as GeoPackage seek by scanning), and transform and extract
+	// each round of batches in parallel (reading in rounds bounds the number of untransformed geometries held at once)
+	const int32 BatchesPerRound = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1) * 2;
+	const OGRSpatialReference* LayerSRS = Layer->GetSpatialRef();
+	int HeightField = Options.HeightAttribute.IsEmpty() ? -1 : Layer->GetLayerDefn()->GetFieldIndex(TCHAR_TO_UTF8(*Options.HeightAttribute));
+	TArray<FVectorFeatureBatch> Batches;
+	bool bReadAllFeatures = false;
+	Layer->ResetReading();
+	while (bReadAllFeatures == false)
+	{
+		std::vector<FPendingFeatureBatch> Round;
+		while (bReadAllFeatures == false && (int32)Round.size() < BatchesPerRound)
+		{
+			Round.emplace_back();
+			FPendingFeatureBatch& Pending = Round.back();
+			Pending.Features.reserve(Request.Options.FeaturesPerBatch);
+			while ((int32)Pending.Features.size() < Request.Options.FeaturesPerBatch)
+			{
+				std::unique_ptr<OGRFeature, FFeatureDeleter> Feature(Layer->GetNextFeature());
+				if (!Feature)
+				{
+					bReadAllFeatures = true;
+					break;
+				}
+				
+				float Height = Options.DefaultPolygonHeight;
+				if (HeightField >= 0 && Feature->IsFieldSetAndNotNull(HeightField)) {
+					Height = Feature->GetFieldAsDouble(HeightField);
+				}
+				
+				std::unique_ptr<OGRGeometry, FGeometryDeleter> Geometry(Feature->StealGeometry());
+				if (Geometry) {
+					Pending.Features.push_back({ MoveTemp(Geometry), Feature->GetFID(), Height });
+				}
+			}
+			
+			if (LayerSRS != nullptr) {
+				Pending.LayerSRS.reset(LayerSRS->Clone());
+			}
+		}
+		
+		int32 FirstBatch = Batches.Num();
+		Batches.SetNum(FirstBatch + (int32)Round.size());
+		ParallelFor((int32)Round.size(), [&](int32 Index)
+		{
+			ImportBatch(Request, Surface, Round[Index], Batches[FirstBatch + Index]);
+		});
+	}
+	
+	Dataset.reset();
+	
+	for (const FVectorFeatureBatch& Batch : Batches)
+	{
+		if (!Batch.Error.IsEmpty())
+		{
+			UE_LOG(LogTemp, Log, TEXT("%s"), *Batch.Error);
+			return nullptr;
+		}
+	}
+	
+	// Spawn an actor to hold the imported features
+	AActor* Actor = WorldContext->GetWorld()->SpawnActor<AActor>();
+	USceneComponent* Root = NewObject<USceneComponent>(Actor, TEXT("Root"), RF_Transactional);
+	Actor->SetRootComponent(Root);
+	Root->RegisterComponent();
+	Actor->AddInstanceComponent(Root);
+	Actor->SetActorLabel(FString::Printf(TEXT("%s_%s"), *Landscape->GetActorLabel(), Options.LayerName.IsEmpty() ? *FPaths::GetBaseFilename(DatasetPath) : *Options.LayerName));
+	
+	if (Options.PointMesh != nullptr) {
+		CreateInstances(Actor, Options.PointMesh, Batches, &FVectorFeatureBatch::PointInstances);
+	}
+	
+	if (Options.PolygonMesh != nullptr) {
+		CreateInstances(Actor, Options.PolygonMesh, Batches, &FVectorFeatureBatch::PolygonInstances);
+	}
+	
+	for (const FVectorFeatureBatch& Batch : Batches)
+	{
+		for (int32 Index = 0; Index < Batch.Splines.Num(); ++Index)
+		{
+			USplineComponent* Spline = NewObject<USplineComponent>(Actor, NAME_None, RF_Transactional);
+			Spline->SetupAttachment(Root);
+			Spline->RegisterComponent();
+			Actor->AddInstanceComponent(Spline);
+			
+			// Features are polylines, so use linear segments rather than smoothing between the vertices
+			Spline->SetSplinePoints(Batch.Splines[Index], ESplineCoordinateSpace::World, false);
+			for (int32 Point = 0; Point < Batch.Splines[Index].Num(); ++Point) {
+				Spline->SetSplinePointType(Point, ESplinePointType::Linear, false);
+			}
+			
+			Spline->SetClosedLoop(Batch.SplineClosedLoops[Index], false);
+			Spline->UpdateSpline();
+		}
+	}
+	
+	return Actor;
+}
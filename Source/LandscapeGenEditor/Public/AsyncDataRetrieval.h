@@ -25,6 +25,32 @@ public:
 	
 	virtual void Activate();
 	
+	// Releases the action once retrieval has finished, cancelling the retrieval first if it is still in flight
+	virtual void SetReadyToDestroy() override;
+	
+	// Cancels the retrieval and releases its resources, notifying the failure delegate with a cancellation error
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Retrieval")
+	void Cancel();
+	
+	// Returns the progress of the retrieval in the range [0,1]
+	UFUNCTION(BlueprintPure, Category = "LandscapeGen|Retrieval")
+	float GetProgress() const;
+	
+	// Determines whether the retrieval is still in flight
+	UFUNCTION(BlueprintPure, Category = "LandscapeGen|Retrieval")
+	bool IsRunning() const;
+	
 private:
+	
+	UFUNCTION()
+	void HandleSuccess(const FString& Error, const FGISData& Data);
+	
+	UFUNCTION()
+	void HandleFailure(const FString& Error, const FGISData& Data);
+	
+	UPROPERTY()
 	TScriptInterface<IGISDataSource> DataSource;
+	
+	bool bRunning = false;
+	bool bFinished = false;
 };
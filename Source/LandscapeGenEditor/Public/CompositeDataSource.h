@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GISDataSource.h"
+#include "CompositeDataSource.generated.h"
+
+// A data source that retrieves heightmap data from one data source and colour data from another, running both retrievals concurrently
+// and then aligning the colour data to the projected coordinate system and extents of the heightmap data
+UCLASS(Blueprintable)
+class LANDSCAPEGENEDITOR_API UCompositeDataSource : public UObject, public IGISDataSource
+{
+	GENERATED_BODY()
+	
+	public:
+		
+		virtual void RetrieveData(FGISDataSourceDelegate OnSuccess, FGISDataSourceDelegate OnFailure);
+		
+		// Cancels the retrievals for both underlying data sources
+		virtual void CancelRetrieval() override;
+		
+		// Returns the average progress of the retrievals for both underlying data sources
+		virtual float GetRetrievalProgress() const override;
+		
+		// Combines the plans of both underlying data sources, whose retrievals run concurrently
+		virtual FGISRetrievalPlan PlanRetrieval() const override;
+		
+		// The data source that provides the heightmap data (its colour data is discarded, so set its Channels to HeightOnly where supported)
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		TScriptInterface<IGISDataSource> HeightSource;
+		
+		// The data source that provides the colour data (its heightmap data is discarded, so set its Channels to ColorOnly where supported)
+		UPROPERTY(BlueprintReadWrite, meta=(ExposeOnSpawn="true"))
+		TScriptInterface<IGISDataSource> ColorSource;
+	
+	private:
+		
+		UFUNCTION()
+		void HandleHeightSuccess(const FString& Error, const FGISData& Data);
+		
+		UFUNCTION()
+		void HandleHeightFailure(const FString& Error, const FGISData& Data);
+		
+		UFUNCTION()
+		void HandleColorSuccess(const FString& Error, const FGISData& Data);
+		
+		UFUNCTION()
+		void HandleColorFailure(const FString& Error, const FGISData& Data);
+		
+		// Cancels whichever retrieval is still in flight and notifies the failure delegate
+		void FailRetrieval(const FString& Error);
+		
+		// Aligns the colour data to the heightmap data on a worker thread once both retrievals have completed
+		void CombineResults();
+		
+		FGISDataSourceDelegate OnSuccess;
+		FGISDataSourceDelegate OnFailure;
+		
+		// The data received from each of the underlying data sources
+		FGISData HeightData;
+		FGISData ColorData;
+		
+		bool bRunning = false;
+		bool bHeightReceived = false;
+		bool bColorReceived = false;
+		
+		// Incremented for each retrieval so that alignment results for a cancelled retrieval can be discarded
+		int32 RetrievalID = 0;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// A thread-safe registry of the coordinate systems used by the plugin, which resolves EPSG codes to WKT and parses coordinate
+// system definitions into OGR spatial references only once, and caches the coordinate transformations between them
+// (GDAL is initialised on first use, so sessions that never touch GIS data never initialise it)
+class LANDSCAPEGENEDITOR_API CoordinateSystemRegistry
+{
+public:
+	
+	// Returns the WKT representation of the specified EPSG code, or an empty string if the code is not recognised
+	static FString GetWKT(int32 EPSGCode);
+	
+	// Determines whether two coordinate system definitions (in any format accepted by OGRSpatialReference::SetFromUserInput())
+	// describe the same coordinate system
+	static bool IsSameCoordinateSystem(const FString& First, const FString& Second);
+	
+	// Transforms a coordinate between two coordinate systems, returning false if the transformation fails
+	// (Coordinate transformations cannot be shared between threads, so a transformation is cached for each calling thread)
+	static bool TransformCoordinate(const FString& Source, const FString& Target, const FVector& Coordinate, FVector& OutTransformed);
+	
+	// Releases all cached spatial references and transformations
+	static void Reset();
+};
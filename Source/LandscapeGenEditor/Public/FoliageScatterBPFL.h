@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "FoliageScatterBPFL.generated.h"
+
+class ALandscape;
+class UFoliageType;
+
+// Specifies the foliage scattered over the areas of a land cover raster that are assigned to a given class
+USTRUCT(BlueprintType)
+struct LANDSCAPEGENEDITOR_API FLandCoverFoliageRule
+{
+	GENERATED_BODY()
+	
+	// The land cover class value (e.g. 10 for "Tree cover" in ESA WorldCover)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	int32 ClassValue = 0;
+	
+	// The foliage type to scatter (its scale, random yaw, normal alignment and Z offset settings are respected)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	UFoliageType* FoliageType = nullptr;
+	
+	// The average number of instances per hectare
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float DensityPerHectare = 100.0f;
+};
+
+// Options controlling the scattering of foliage from a land cover raster
+USTRUCT(BlueprintType)
+struct LANDSCAPEGENEDITOR_API FLandCoverScatterOptions
+{
+	GENERATED_BODY()
+	
+	// The path to the land cover classification raster (the class values are read from the first band)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FString ClassificationRasterPath;
+	
+	// The path to an optional density map raster, whose first band (in the range [0,1]) scales the density of all rules
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FString DensityMapPath;
+	
+	// The foliage to scatter for each land cover class (multiple rules may share a class)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	TArray<FLandCoverFoliageRule> Rules;
+	
+	// The seed for instance placement, so that repeated runs produce the same result
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	int32 Seed = 0;
+	
+	// The number of instances committed to the foliage system at once
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	int32 InstancesPerCommit = 100000;
+};
+
+UCLASS()
+class LANDSCAPEGENEDITOR_API UFoliageScatterBPFL : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	
+	// Scatters foliage over a landscape generated from GIS data according to a land cover classification raster, which is warped
+	// to the landscape's projected coordinate system and extents (instance transforms are computed in parallel), returning the
+	// number of instances that were added (or -1 if an error occurred)
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Foliage")
+	static int32 ScatterFoliageFromLandCover(const UObject* WorldContext, ALandscape* Landscape, const FLandCoverScatterOptions& Options);
+};
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Math/Float16.h"
 #include "Math/Vector2D.h"
 #include "GISData.generated.h"
 
+#include <limits>
+
 
 UENUM(BlueprintType)
 enum ECornerCoordinateType
@@ -16,20 +19,120 @@ enum ECornerCoordinateType
 };
 
 
+// The raster data that a data source should retrieve (skipped channels are left empty in the retrieved data)
+UENUM(BlueprintType)
+enum class EGISDataChannels : uint8
+{
+	HeightAndColor  UMETA(DisplayName = "Height and Colour"),
+	HeightOnly      UMETA(DisplayName = "Height Only"),
+	ColorOnly       UMETA(DisplayName = "Colour Only"),
+};
+
+
+// The representations that heightmap samples may be stored in
+UENUM(BlueprintType)
+enum class EGISHeightEncoding : uint8
+{
+	// 32-bit floating-point heights in metres
+	Float32  UMETA(DisplayName = "32-bit Float"),
+	
+	// 16-bit unsigned integers that are mapped linearly to heights in metres by an offset and scale
+	UInt16   UMETA(DisplayName = "16-bit Integer"),
+	
+	// 16-bit floating-point heights in metres
+	// (Half floats have a precision of 0.5m between 512m and 1024m, and this doubles with each power of two, so this is only suitable
+	// for low-lying terrain)
+	Float16  UMETA(DisplayName = "16-bit Float"),
+};
+
+
+// Describes how heightmap samples are stored, and converts between compact samples and heights in metres
+USTRUCT(BlueprintType)
+struct LANDSCAPEGENEDITOR_API FGISHeightFormat
+{
+	GENERATED_BODY()
+	
+	// The representation of each height sample
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	EGISHeightEncoding Encoding = EGISHeightEncoding::Float32;
+	
+	// For UInt16 samples, the height in metres represented by a sample of zero and the height step between consecutive samples
+	// (The defaults cover heights from -500m to 12606.8m in steps of 0.2m, which spans all terrain on Earth)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float Offset = -500.0f;
+	
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float Scale = 0.2f;
+	
+	// Determines whether samples are stored in one of the 16-bit encodings
+	bool IsCompact() const {
+		return (this->Encoding != EGISHeightEncoding::Float32);
+	}
+	
+	// Encodes a height in metres as a compact sample (NaN is encoded as nodata, and UInt16 samples are clamped to the valid range)
+	// (The maximum UInt16 sample is reserved to represent nodata)
+	FORCEINLINE uint16 Encode(float Height) const
+	{
+		if (FMath::IsNaN(Height)) {
+			return (this->Encoding == EGISHeightEncoding::Float16) ? 0x7E00 : MAX_uint16;
+		}
+		
+		if (this->Encoding == EGISHeightEncoding::Float16) {
+			return FFloat16(Height).Encoded;
+		}
+		
+		return (uint16)FMath::Clamp(FMath::RoundToInt((Height - this->Offset) / this->Scale), 0, MAX_uint16 - 1);
+	}
+	
+	// Decodes a compact sample to a height in metres (nodata samples are decoded as NaN)
+	FORCEINLINE float Decode(uint16 Sample) const
+	{
+		if (this->Encoding == EGISHeightEncoding::Float16)
+		{
+			// Half floats with an all-ones exponent represent infinities and NaNs, which we treat as nodata
+			if ((Sample & 0x7C00) == 0x7C00) {
+				return std::numeric_limits<float>::quiet_NaN();
+			}
+			
+			FFloat16 Half;
+			Half.Encoded = Sample;
+			return Half.GetFloat();
+		}
+		
+		return (Sample == MAX_uint16) ? std::numeric_limits<float>::quiet_NaN() : (this->Offset + Sample * this->Scale);
+	}
+};
+
+
 USTRUCT(BlueprintType)
 struct LANDSCAPEGENEDITOR_API FGISData
 {
 	GENERATED_BODY()
 	
-	// The buffer of raw heightmap values (in metres) and the heightmap raster dimensions
+	// The buffer of raw heightmap values (in metres) and the heightmap raster dimensions (empty if height data was not requested)
+	// (The raster buffers use 64-bit sizes so that rasters above 2^31 samples do not overflow, which means they cannot be exposed to
+	// Blueprints, since TArray64 is not supported by the reflection system)
+	TArray64<float> HeightBuffer;
+	uint32 HeightBufferX = 0, HeightBufferY = 0;
+	
+	// The format of the heightmap samples, and the buffer that holds them when they use one of the compact encodings
+	// (Compact samples are stored instead of the raw heightmap values, halving the memory used by the heightmap, and nodata samples
+	// are always decoded as NaN)
+	UPROPERTY(BlueprintReadWrite)
+	FGISHeightFormat HeightFormat;
+	TArray64<uint16> CompactHeightBuffer;
+	
+	// Specifies whether the heightmap buffer contains nodata samples that need to be filled prior to landscape generation
 	UPROPERTY(BlueprintReadWrite)
-	TArray<float> HeightBuffer;
-	uint32 HeightBufferX, HeightBufferY;
+	bool bHeightHasNoData = false;
 	
-	// The buffer of colour values and the colour raster dimensions
+	// The value used to represent nodata samples in the heightmap buffer (NaN samples are always treated as nodata)
 	UPROPERTY(BlueprintReadWrite)
-	TArray<uint8> ColorBuffer;
-	uint32 ColorBufferX, ColorBufferY;
+	float HeightNoDataValue = 0.0f;
+	
+	// The buffer of colour values and the colour raster dimensions (empty if colour data was not requested)
+	TArray64<uint8> ColorBuffer;
+	uint32 ColorBufferX = 0, ColorBufferY = 0;
 	
 	UPROPERTY(BlueprintReadWrite)
 	TEnumAsByte<EPixelFormat> PixelFormat = EPixelFormat::PF_B8G8R8A8;
@@ -49,4 +152,20 @@ struct LANDSCAPEGENEDITOR_API FGISData
 	// The coordinate of the lower-right corner of the raster data
 	UPROPERTY(BlueprintReadWrite)
 	FVector2D LowerRight;
+	
+	// Retrieves the corner coordinates in the projected coordinate system of the raster data, converting them from WGS84 if required
+	bool GetProjectedCorners(FVector2D& OutUpperLeft, FVector2D& OutLowerRight) const;
+	
+	// Determines whether the data holds heightmap samples in any format
+	bool HasHeightData() const {
+		return (this->HeightBuffer.Num() > 0 || this->CompactHeightBuffer.Num() > 0);
+	}
+	
+	// Returns the number of bytes held by the heightmap buffers
+	int64 GetHeightBytes() const {
+		return this->HeightBuffer.Num() * sizeof(float) + this->CompactHeightBuffer.Num() * sizeof(uint16);
+	}
+	
+	// Decodes the heightmap samples to heights in metres, decoding blocks of compact samples in parallel
+	void DecodeHeights(TArray64<float>& OutHeights) const;
 };
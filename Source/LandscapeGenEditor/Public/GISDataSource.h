@@ -6,6 +6,64 @@
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGISDataSourceDelegate, const FString&, Error, const FGISData&, Data);
 
+// The estimated cost of a data retrieval, which is computed without performing any of the retrieval work
+USTRUCT(BlueprintType)
+struct LANDSCAPEGENEDITOR_API FGISRetrievalPlan
+{
+	GENERATED_BODY()
+	
+	// The number of tiles that will be read, and the number of those that will be requested over the network
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 NumTiles = 0;
+	
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 NumRequests = 0;
+	
+	// The expected number of bytes downloaded over the network
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int64 ExpectedDownloadBytes = 0;
+	
+	// The dimensions of the retrieved heightmap and colour rasters (zero for any channel that is not retrieved)
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 HeightSizeX = 0;
+	
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 HeightSizeY = 0;
+	
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 ColorSizeX = 0;
+	
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 ColorSizeY = 0;
+	
+	// The format that the retrieved heights will be stored in
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	FGISHeightFormat HeightFormat;
+	
+	// Specifies whether the retrieved heightmap may contain nodata samples that will need to be filled during generation
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	bool bHeightMayHaveNoData = false;
+	
+	// The estimated peak memory allocated by the retrieval (including the buffers of the retrieved data)
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int64 PeakMemoryBytes = 0;
+	
+	// The estimated duration of the retrieval, calibrated from the throughput of previous retrievals
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float EstimatedSeconds = 0.0f;
+	
+	// The error that the retrieval would fail with before performing any work, or an empty string if the request is valid
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	FString Error;
+	
+	// Returns the number of bytes held by the buffers of the retrieved data
+	int64 GetDataBytes() const
+	{
+		int64 HeightSampleBytes = this->HeightFormat.IsCompact() ? sizeof(uint16) : sizeof(float);
+		return (int64)this->HeightSizeX * this->HeightSizeY * HeightSampleBytes + (int64)this->ColorSizeX * this->ColorSizeY * sizeof(FColor);
+	}
+};
+
 UINTERFACE(Blueprintable)
 class UGISDataSource : public UInterface
 {
@@ -19,4 +77,20 @@ class LANDSCAPEGENEDITOR_API IGISDataSource
 	public:
 		
 		virtual void RetrieveData(FGISDataSourceDelegate OnSuccess, FGISDataSourceDelegate OnFailure) = 0;
+		
+		// Cancels any in-flight data retrieval and releases the buffers it holds
+		// (Neither delegate will be invoked for a retrieval that has been cancelled)
+		virtual void CancelRetrieval() {}
+		
+		// Returns the progress of the in-flight data retrieval in the range [0,1]
+		virtual float GetRetrievalProgress() const { return 0.0f; }
+		
+		// Estimates the cost of retrieving the data with the current settings without performing any of the work
+		// (Request validation and size checks that would cause the retrieval to fail are reported in the plan's error)
+		virtual FGISRetrievalPlan PlanRetrieval() const
+		{
+			FGISRetrievalPlan Plan;
+			Plan.Error = TEXT("This data source does not support planning");
+			return Plan;
+		}
 };
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Allows generated assets to be reused when they are regenerated from identical inputs, rather than creating duplicate assets
+// (Each generated asset is named after a hash of its inputs and records that hash in its package metadata)
+class GeneratedAssetCache
+{
+public:
+	
+	// The path of the package directory holding generated assets
+	static LANDSCAPEGENEDITOR_API const FString& GetPackagePath();
+	
+	// Computes a content hash of a buffer, hashing blocks of the buffer in parallel
+	static LANDSCAPEGENEDITOR_API uint64 HashBuffer(const uint8* Data, int64 NumBytes);
+	
+	// Computes a content hash of a string holding the parameters used to generate an asset
+	static LANDSCAPEGENEDITOR_API uint64 HashString(const FString& Value);
+	
+	// Combines two content hashes and formats the result for use in asset names and metadata
+	static LANDSCAPEGENEDITOR_API FString FormatHash(uint64 First, uint64 Second = 0);
+	
+	// Returns the name of the generated asset with the specified prefix and content hash
+	static LANDSCAPEGENEDITOR_API FString GetAssetName(const FString& Prefix, const FString& Hash);
+	
+	// Retrieves the generated asset with the specified name if it exists, is of the specified class and records the specified hash
+	static LANDSCAPEGENEDITOR_API UObject* FindAsset(const FString& AssetName, UClass* Class, const FString& Hash);
+	
+	template <typename T>
+	static T* FindAsset(const FString& AssetName, const FString& Hash) {
+		return Cast<T>(FindAsset(AssetName, T::StaticClass(), Hash));
+	}
+	
+	// Records the content hash of a newly generated asset in its package metadata
+	static LANDSCAPEGENEDITOR_API void SetAssetHash(UObject* Asset, const FString& Hash);
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenerationCostCalibration.generated.h"
+
+// The throughput observed by previous retrievals and generations, which calibrates the time estimates of retrieval and generation
+// plans (the statistics are running averages that are persisted to the project's Saved directory)
+USTRUCT()
+struct LANDSCAPEGENEDITOR_API FGenerationCostCalibration
+{
+	GENERATED_BODY()
+	
+	// The average number of bytes downloaded per tile request
+	UPROPERTY()
+	float AverageTileBytes = 64.0f * 1024.0f;
+	
+	// The average download throughput of a whole retrieval (including the effect of concurrent requests)
+	UPROPERTY()
+	float DownloadBytesPerSecond = 4.0f * 1024.0f * 1024.0f;
+	
+	// The average time taken to generate a landscape per million heightmap samples
+	UPROPERTY()
+	float GenerationSecondsPerMegasample = 1.0f;
+	
+	// The number of observations that have contributed to each running average
+	UPROPERTY()
+	int32 NumRetrievals = 0;
+	
+	UPROPERTY()
+	int32 NumGenerations = 0;
+	
+	// Loads the recorded statistics, falling back to the defaults if none have been recorded
+	static FGenerationCostCalibration Load();
+	
+	// Persists the statistics (returns false if they could not be written)
+	bool Save() const;
+	
+	// Records the observed throughput of a retrieval that fetched the specified number of tiles over the network
+	static void RecordRetrieval(int32 NumRequests, int64 DownloadedBytes, double Seconds);
+	
+	// Records the observed time taken to generate a landscape with the specified number of heightmap samples
+	static void RecordGeneration(int64 NumSamples, double Seconds);
+	
+	// Estimates the number of bytes downloaded by the specified number of tile requests, and the time taken to download them
+	int64 EstimateDownloadBytes(int32 NumRequests) const;
+	float EstimateDownloadSeconds(int64 DownloadBytes) const;
+	
+	// Estimates the time taken to generate a landscape with the specified number of heightmap samples
+	float EstimateGenerationSeconds(int64 NumSamples) const;
+};
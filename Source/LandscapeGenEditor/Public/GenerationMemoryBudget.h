@@ -0,0 +1,43 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LandscapeGenerationBPFL.h"
+
+// Checks the estimated allocations of each stage of landscape generation against a memory budget before the stage runs, and records
+// the physical memory usage of the process while each stage runs
+class LANDSCAPEGENEDITOR_API FGenerationMemoryBudget
+{
+public:
+	
+	// Creates a budget of the specified size (or no limit if the size is zero) that records its stages in the supplied report
+	FGenerationMemoryBudget(int32 BudgetMB, FLandscapeGenerationMemoryReport& OutReport);
+	
+	// Ends the current stage (if any)
+	~FGenerationMemoryBudget();
+	
+	// Determines whether the estimated allocations of a stage fit within the budget given the current memory usage
+	// (Returns false, logs the estimate and stores it in the report if the stage would exceed the budget)
+	bool CheckStage(const FString& Stage, int64 EstimatedBytes);
+	
+	// Checks a stage as above and begins recording its memory usage, ending the previous stage
+	bool BeginStage(const FString& Stage, int64 EstimatedBytes);
+	
+	// Ends the current stage, recording the peak memory usage observed while it ran
+	void EndStage();
+	
+	// Estimates the peak allocations of each stage of the generation pipeline, including any buffers retained from earlier stages
+	// (The GIS data itself is not included, since it is already resident when the estimates are checked)
+	static int64 EstimateColorTexture(int64 NumPixels);
+	static int64 EstimateHoleFilling(int64 NumSamples);
+	static int64 EstimateQuantization(int64 NumSamples, bool bHasNoData);
+	static int64 EstimateDerivedMaps(int64 NumSamples);
+	static int64 EstimatePaintLayers(int64 NumSamples, int32 NumLayers);
+	static int64 EstimateImport(int64 NumSamples, int32 NumLayers);
+
+private:
+	
+	int64 BudgetBytes;
+	FLandscapeGenerationMemoryReport& Report;
+	int32 CurrentStage = INDEX_NONE;
+	uint64 StartPeakBytes = 0;
+};
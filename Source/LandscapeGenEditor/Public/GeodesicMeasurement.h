@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MapProjection.h"
+
+// Measures ground distances between points in a projected coordinate system, for projections whose units are not ground metres
+// (such as Web Mercator, whose scale increases with distance from the equator)
+class LANDSCAPEGENEDITOR_API FGeodesicMeasurement
+{
+public:
+	
+	// Selects the conversion to WGS84 for the specified projected coordinate system (the built-in projections are used where possible)
+	FGeodesicMeasurement(const FString& InWKT);
+	
+	// Computes the great-circle distance in metres between two points in the projected coordinate system
+	// (Returns false if the points cannot be converted to WGS84)
+	bool MeasureDistance(double X1, double Y1, double X2, double Y2, double& OutMetres) const;
+	
+	// Computes the great-circle distance in metres between two WGS84 coordinates (in degrees)
+	static double GreatCircleDistance(double Latitude1, double Longitude1, double Latitude2, double Longitude2);
+
+private:
+	
+	// Converts projected coordinates to WGS84 coordinates (in degrees)
+	bool ProjectedToGeographic(double X, double Y, double& OutLatitude, double& OutLongitude) const;
+	
+	FString WKT;
+	FString WGS84_WKT;
+	FMapProjection Projection;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class HeightmapHoleFilling
+{
+public:
+	
+	// Determines whether a height sample holds valid data (i.e. it is neither NaN nor equal to the nodata value)
+	static FORCEINLINE bool IsValidSample(float Sample, float NoDataValue) {
+		return (FMath::IsNaN(Sample) == false && Sample != NoDataValue);
+	}
+	
+	// Computes the range of the valid height samples in the supplied buffer, excluding nodata values
+	// (Returns false if the buffer does not contain any valid samples)
+	static LANDSCAPEGENEDITOR_API bool ComputeValidRange(const TArray64<float>& Heights, float NoDataValue, float& OutMin, float& OutMax);
+	
+	// Fills all nodata samples in the supplied heightmap buffer in-place using multi-resolution push-pull interpolation
+	// (Returns the number of samples that were filled, or -1 if the buffer does not contain any valid samples)
+	static LANDSCAPEGENEDITOR_API int64 FillHoles(TArray64<float>& Heights, uint32 SizeX, uint32 SizeY, float NoDataValue);
+};
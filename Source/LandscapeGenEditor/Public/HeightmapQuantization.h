@@ -0,0 +1,21 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GISData.h"
+
+class HeightmapQuantization
+{
+public:
+	
+	// Converts height values in metres to the uint16 samples expected by the landscape system, mapping the range [Min,Max]
+	// linearly to [0,MAX_uint16] to maximise height sample resolution (NaN samples are mapped to zero)
+	// (The output uses 32-bit sizes since that is what the landscape import expects, so the heightmap must fit within the landscape limits)
+	static LANDSCAPEGENEDITOR_API void Quantize(const TArray64<float>& Heights, float Min, float Max, TArray<uint16>& OutSamples);
+	
+	// Quantizes compact height samples as above, decoding each sample as it is quantized rather than expanding the buffer to floats
+	static LANDSCAPEGENEDITOR_API void QuantizeCompact(const TArray64<uint16>& Samples, const FGISHeightFormat& Format, float Min, float Max, TArray<uint16>& OutSamples);
+	
+	// Computes the range of the heights represented by compact height samples, excluding nodata samples
+	// (Returns false if the buffer does not contain any valid samples)
+	static LANDSCAPEGENEDITOR_API bool ComputeCompactRange(const TArray64<uint16>& Samples, const FGISHeightFormat& Format, float& OutMin, float& OutMax);
+};
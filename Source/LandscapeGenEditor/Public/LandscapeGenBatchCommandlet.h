@@ -0,0 +1,132 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GISDataSource.h"
+#include "LandscapeGenerationBPFL.h"
+#include "LandscapeGenBatchCommandlet.generated.h"
+
+// The stages that a batch generation job passes through
+UENUM()
+enum class ELandscapeGenBatchJobState : uint8
+{
+	Pending,
+	Retrieving,
+	Retrieved,
+	Completed,
+	Failed
+};
+
+// Represents a single job in a batch generation manifest, and receives the data retrieval callbacks for that job
+UCLASS()
+class LANDSCAPEGENEDITOR_API ULandscapeGenBatchJob : public UObject
+{
+	GENERATED_BODY()
+	
+public:
+	
+	// The name used for the generated landscape and its assets
+	FString Name;
+	
+	// The package path of the map that the generated landscape will be saved into
+	FString MapPath;
+	
+	// The scale factors used when generating the landscape
+	FVector Scale3D = FVector::OneVector;
+	
+	// The options used when generating the landscape
+	UPROPERTY()
+	FLandscapeGenerationOptions Options;
+	
+	// The data source used to retrieve the GIS data for the job
+	UPROPERTY()
+	UObject* DataSource = nullptr;
+	
+	// The retrieved GIS data, which is held only until the landscape has been generated
+	FGISData Data;
+	
+	ELandscapeGenBatchJobState State = ELandscapeGenBatchJobState::Pending;
+	FString Error;
+	
+	// Timestamps (in platform seconds) and durations for each stage of the job
+	double RetrievalStartTime = 0.0;
+	double RetrievalEndTime = 0.0;
+	double GenerationStartTime = 0.0;
+	double GenerationSeconds = 0.0;
+	double SaveSeconds = 0.0;
+	
+	// The number of bytes held by the retrieved GIS data buffers (and the value reported once they have been released)
+	// (While data is being retrieved, DataBytes holds the estimated peak memory of the retrieval instead)
+	int64 DataBytes = 0;
+	int64 RetrievedBytes = 0;
+	
+	// The estimated peak memory of the job's data retrieval, or -1 if the retrieval has not been planned yet
+	int64 EstimatedDataBytes = -1;
+	
+	// The memory usage of each stage of landscape generation
+	FLandscapeGenerationMemoryReport MemoryReport;
+	
+	UFUNCTION()
+	void HandleRetrievalSuccess(const FString& InError, const FGISData& InData);
+	
+	UFUNCTION()
+	void HandleRetrievalFailure(const FString& InError, const FGISData& InData);
+};
+
+// Generates a batch of landscapes described by a JSON manifest, overlapping the data retrieval for upcoming jobs with
+// landscape generation for the current job. Usage:
+//
+//   UE4Editor-Cmd.exe <Project> -run=LandscapeGenBatch -Manifest=<path/to/manifest.json> [-Report=<path/to/report.json>] [-DryRun]
+//
+// With -DryRun, no data is retrieved and no landscapes are generated. Instead, the tile counts, download size, peak memory, component
+// layout and estimated duration of each job are written to the report, along with any error that would cause the job to fail.
+//
+// Manifest format:
+//
+//   {
+//     "MaxInFlightRetrievals": 2,
+//     "MaxInFlightMemoryMB": 8192,
+//     "Jobs": [
+//       {
+//         "Name": "Area01",
+//         "Map": "/Game/Maps/Area01",
+//         "Scale": [1.0, 1.0, 1.0],
+//         "Options": { "bGenerateColorTexture": true, "MemoryBudgetMB": 16384 },
+//         "DataSource": {
+//           "Class": "/Script/GDALDataSource.GDALDataSource",
+//           "Properties": { "HeightmapDataset": "D:/Data/area01_dem.tif", "RGBDataset": "D:/Data/area01_rgb.tif" }
+//         }
+//       }
+//     ]
+//   }
+UCLASS()
+class LANDSCAPEGENEDITOR_API ULandscapeGenBatchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+	
+public:
+	
+	ULandscapeGenBatchCommandlet();
+	
+	virtual int32 Main(const FString& Params) override;
+	
+private:
+	
+	// The jobs parsed from the manifest, in manifest order
+	UPROPERTY()
+	TArray<ULandscapeGenBatchJob*> Jobs;
+	
+	// The maximum number of jobs that may be retrieving data or waiting for generation at once
+	int32 MaxInFlightRetrievals = 2;
+	
+	// The maximum number of bytes of data that may be retrieved or held while waiting for generation
+	// (Jobs whose data is still being retrieved are charged the estimated peak memory of their retrieval)
+	int64 MaxInFlightBytes = 8192ll * 1024 * 1024;
+	
+	bool ParseManifest(const FString& ManifestPath, FString& OutError);
+	void StartRetrieval(ULandscapeGenBatchJob* Job);
+	void GenerateAndSave(ULandscapeGenBatchJob* Job);
+	void TickPendingWork(float DeltaTime);
+	bool WriteReport(const FString& ReportPath, double TotalSeconds) const;
+	bool WritePlanReport(const FString& ReportPath, int32& OutNumFailed) const;
+};
@@ -3,18 +3,192 @@
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "GISData.h"
+#include "GISDataSource.h"
 #include "LandscapeGenerationBPFL.generated.h"
 
+class UMaterialInterface;
+class UTexture2D;
+
+// A landscape paint layer whose weightmap is imported from the classes of a land cover classification raster
+USTRUCT(BlueprintType)
+struct LANDSCAPEGENEDITOR_API FLandCoverPaintLayer
+{
+	GENERATED_BODY()
+	
+	// The name of the paint layer
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FName LayerName;
+	
+	// The land cover class values that are painted with this layer
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	TArray<int32> ClassValues;
+	
+	// The tiling detail texture used by the generated layered material for this layer
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	UTexture2D* DetailTexture = nullptr;
+	
+	// The size (in metres) covered by a single tile of the detail texture
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float TileSize = 10.0f;
+};
+
+// Options controlling which assets are created during landscape generation
+USTRUCT(BlueprintType)
+struct LANDSCAPEGENEDITOR_API FLandscapeGenerationOptions
+{
+	GENERATED_BODY()
+	
+	// Specifies whether a colour texture should be created from the colour data (and used to build an unlit landscape material)
+	// (Disable this for landscapes that use procedural materials, in which case the colour data is ignored)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool bGenerateColorTexture = true;
+	
+	// Specifies whether normal, slope and ambient occlusion textures should be computed from the heightmap for use by lit materials
+	// (The textures cover the same extents as the heightmap and are stored on the landscape's GIS data component)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool bGenerateDerivedMaps = false;
+	
+	// The radius (in metres) of the surrounding terrain that contributes to the ambient occlusion of each heightmap sample
+	// (The radius is limited to 64 heightmap samples)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float AmbientOcclusionRadius = 20.0f;
+	
+	// The material to apply to the landscape instead of the generated unlit material (if any)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	UMaterialInterface* LandscapeMaterial = nullptr;
+	
+	// The path to a land cover classification raster whose classes are imported as paint layer weightmaps
+	// (When paint layers are imported, no colour texture is created and a layered material is generated from the layers' detail
+	// textures instead, so texture memory no longer scales with the size of the landscape)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FString ClassificationRasterPath;
+	
+	// The paint layers to import from the classification raster (pixels whose class is not listed are assigned to the first layer)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	TArray<FLandCoverPaintLayer> PaintLayers;
+	
+	// The maximum physical memory (in megabytes) that the process may use during generation, or zero for no limit
+	// (The allocations of every stage are estimated before any work is performed and again before each stage runs, and generation
+	// stops with an error describing the estimate if a stage would exceed the budget)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	int32 MemoryBudgetMB = 0;
+};
+
+// The estimated and observed memory usage of a single stage of landscape generation
+USTRUCT(BlueprintType)
+struct LANDSCAPEGENEDITOR_API FLandscapeGenerationStageMemory
+{
+	GENERATED_BODY()
+	
+	// The name of the stage
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	FString Stage;
+	
+	// The estimated number of bytes allocated by the stage (including the buffers retained from earlier stages)
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int64 EstimatedBytes = 0;
+	
+	// The physical memory used by the process when the stage began
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int64 StartBytes = 0;
+	
+	// The peak physical memory used by the process while the stage ran
+	// (If the process's high-water mark did not rise during the stage then this is the larger of the usage at its start and end)
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int64 PeakBytes = 0;
+};
+
+// The memory usage of each stage of landscape generation
+USTRUCT(BlueprintType)
+struct LANDSCAPEGENEDITOR_API FLandscapeGenerationMemoryReport
+{
+	GENERATED_BODY()
+	
+	// The stages that ran, in order
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	TArray<FLandscapeGenerationStageMemory> Stages;
+	
+	// The peak physical memory used by the process across all of the stages
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int64 PeakBytes = 0;
+	
+	// A description of the stage that would have exceeded the memory budget, or an empty string if the budget was respected
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	FString BudgetError;
+};
+
+// The estimated cost of generating a landscape, which is computed without performing any of the generation work
+USTRUCT(BlueprintType)
+struct LANDSCAPEGENEDITOR_API FLandscapeGenerationPlan
+{
+	GENERATED_BODY()
+	
+	// The layout of the landscape components
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 NumComponentsX = 0;
+	
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 NumComponentsY = 0;
+	
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 ComponentSizeQuads = 0;
+	
+	// The stages that generation will run, in order, with their estimated allocations (the observed fields are left at zero)
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	TArray<FLandscapeGenerationStageMemory> Stages;
+	
+	// The estimated peak memory allocated by generation (including the retrieved data that it consumes)
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int64 PeakMemoryBytes = 0;
+	
+	// The estimated duration of generation, calibrated from the duration of previous generations
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float EstimatedSeconds = 0.0f;
+	
+	// The error that generation would fail with before performing any work, or an empty string if generation can proceed
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	FString Error;
+};
+
 UCLASS()
 class LANDSCAPEGENEDITOR_API ULandscapeGenerationBPFL : public UBlueprintFunctionLibrary
 {
 	GENERATED_BODY()
+
+public:
 	
 	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Single")
 	static ALandscape* GenerateLandscapeFromGISData(
 		const UObject* WorldContext, const FString& LandscapeName, const FGISData& GISData, const FVector& Scale3D
 	);
 	
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Single")
+	static ALandscape* GenerateLandscapeFromGISDataWithOptions(
+		const UObject* WorldContext, const FString& LandscapeName, const FGISData& GISData, const FVector& Scale3D,
+		const FLandscapeGenerationOptions& Options
+	);
+	
+	// Generates a landscape as above and reports the estimated and observed memory usage of each stage of the generation pipeline
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Single")
+	static ALandscape* GenerateLandscapeFromGISDataWithMemoryReport(
+		const UObject* WorldContext, const FString& LandscapeName, const FGISData& GISData, const FVector& Scale3D,
+		const FLandscapeGenerationOptions& Options, FLandscapeGenerationMemoryReport& OutReport
+	);
+	
+	// Estimates the component layout, memory usage and duration of generating a landscape from the data described by a retrieval
+	// plan, along with any size or memory budget check that would cause generation to fail, without performing any of the work
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Single")
+	static FLandscapeGenerationPlan PlanLandscapeGeneration(const FGISRetrievalPlan& RetrievalPlan, const FLandscapeGenerationOptions& Options);
+	
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Utils")
+	static UTexture2D* CreateColorTexture(const FString& LandscapeName, const FGISData& GISData);
+	
+	// Generates a lit landscape material that blends the detail textures of the specified paint layers using their weightmaps
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Utils")
+	static UMaterial* GenerateLayeredLandscapeMaterial(
+		const FString& LandscapeName, const TArray<FLandCoverPaintLayer>& PaintLayers, float MetresPerQuad
+	);
+	
 	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Utils")
 	static UMaterial* GenerateUnlitLandscapeMaterial(
 		const FString& LandscapeName, const FString& TexturePath, const int32& NumComponentsX,
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ALandscape;
+
+// A copy of the heightmap of a landscape generated from GIS data, which maps coordinates in the landscape's projected coordinate
+// system onto its surface without performing traces (and can therefore be safely queried from worker threads)
+class LANDSCAPEGENEDITOR_API FLandscapeSurface
+{
+public:
+	
+	// Reads the heightmap and geospatial metadata of the specified landscape (must be called on the game thread)
+	// (Returns false if the landscape was not generated from GIS data)
+	bool ReadFromLandscape(ALandscape* Landscape);
+	
+	// Returns the projected coordinate system of the landscape
+	const FString& GetWKT() const {
+		return this->WKT;
+	}
+	
+	// Returns the projected corner coordinates of the landscape
+	const FVector2D& GetUpperLeft() const {
+		return this->UpperLeft;
+	}
+	
+	const FVector2D& GetLowerRight() const {
+		return this->LowerRight;
+	}
+	
+	// Converts projected coordinates to a world space location on the surface of the landscape
+	FVector ProjectedToWorld(double X, double Y) const;
+	
+	// Computes the world space surface normal of the landscape at the specified projected coordinates
+	FVector GetNormal(double X, double Y) const;
+
+private:
+	
+	// Converts projected coordinates to vertex coordinates in the landscape's local space
+	FVector2D ProjectedToVertex(double X, double Y) const;
+	
+	// Bilinearly samples the heightmap at the specified vertex coordinates, returning the height in landscape local space
+	float SampleLocalHeight(double X, double Y) const;
+	
+	FString WKT;
+	FVector2D UpperLeft;
+	FVector2D LowerRight;
+	TArray<double> InvGeoTransform;
+	TArray<uint16> Heights;
+	int32 MinX = 0;
+	int32 MinY = 0;
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+	FTransform Transform;
+};
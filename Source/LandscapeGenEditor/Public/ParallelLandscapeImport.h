@@ -0,0 +1,18 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ALandscape;
+
+// Imports a heightmap into a landscape by preparing the heightmap texture data of every component in parallel, rather than building
+// the components one at a time as ALandscape::Import() does (only the creation of objects and collision remain on the game thread)
+class ParallelLandscapeImport
+{
+public:
+	
+	// Creates the components of a landscape covering the specified heightmap, filling their heightmap textures (heights, normals and
+	// mips) in parallel. The landscape's component layout, scale and material must have been set, and the landscape must not already
+	// have any components. Vertices beyond the edges of the heightmap are clamped to its edge samples.
+	// (Only landscapes with a single subsection per component and without edit layers are supported, which is what the generator creates)
+	static LANDSCAPEGENEDITOR_API void ImportHeightmap(ALandscape* Landscape, const TArray<uint16>& HeightSamples, int32 SizeX, int32 SizeY);
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GDALHelpers.h"
+#include "LandscapeGenRuntime.h"
+#include "RasterBuffers.h"
+
+class RasterAlignment
+{
+public:
+	
+	// Warps a raster to the specified projected coordinate system and extents and reads its first band, optionally resampling it to
+	// the specified dimensions (if these are zero then the warper selects a resolution that approximately preserves the source
+	// resolution, and the dimensions are updated to reflect the selected resolution)
+	// (Returns an error message, or an empty string on success)
+	template <typename T>
+	static FString ReadAlignedBand(const FString& Path, const FString& WKT, const FVector2D& UpperLeft, const FVector2D& LowerRight,
+		const FString& Resampling, TArray64<T>& OutData, int32& SizeX, int32& SizeY)
+	{
+		FLandscapeGenRuntimeModule::EnsureGDALInitialized();
+		GDALDatasetRef Dataset = GDALDatasetRef((GDALDataset*)GDALOpen(TCHAR_TO_UTF8(*Path), GA_ReadOnly));
+		if (!Dataset) {
+			return FString::Printf(TEXT("Failed to open raster \"%s\""), *Path);
+		}
+		
+		TArray<FString> Options = {
+			TEXT("-of"),
+			TEXT("MEM"),
+			TEXT("-r"),
+			Resampling,
+			TEXT("-t_srs"),
+			WKT,
+			TEXT("-te"),
+			FString::Printf(TEXT("%lf"), FMath::Min(UpperLeft.X, LowerRight.X)),
+			FString::Printf(TEXT("%lf"), FMath::Min(UpperLeft.Y, LowerRight.Y)),
+			FString::Printf(TEXT("%lf"), FMath::Max(UpperLeft.X, LowerRight.X)),
+			FString::Printf(TEXT("%lf"), FMath::Max(UpperLeft.Y, LowerRight.Y))
+		};
+		
+		if (SizeX > 0 && SizeY > 0)
+		{
+			Options.Append({
+				TEXT("-ts"),
+				FString::FromInt(SizeX),
+				FString::FromInt(SizeY)
+			});
+		}
+		
+		GDALDatasetRef Warped = GDALHelpers::Warp(Dataset, GDALHelpers::UniqueMemFilename(), GDALHelpers::ParseGDALWarpOptions(Options));
+		if (!Warped) {
+			return FString::Printf(TEXT("Failed to warp raster \"%s\" to the target projected coordinate system and extents"), *Path);
+		}
+		
+		SizeX = Warped->GetRasterXSize();
+		SizeY = Warped->GetRasterYSize();
+		mergetiff::RasterData<T> Wrapped = RasterBuffers::AllocateAndWrap<T>(OutData, 1, SizeY, SizeX, 0);
+		if (mergetiff::RasterIO::readDataset(Warped, Wrapped, {1}) == false) {
+			return FString::Printf(TEXT("Failed to read raster \"%s\""), *Path);
+		}
+		
+		return TEXT("");
+	}
+};
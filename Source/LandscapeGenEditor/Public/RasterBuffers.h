@@ -0,0 +1,19 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GDALHelpers.h"
+
+class RasterBuffers
+{
+public:
+	
+	// Allocates a buffer for an interleaved raster of the specified dimensions, fills it with the specified value and wraps it in a
+	// RasterData object so that GDAL can read directly into it
+	// (Unlike GDALHelpers::AllocateAndWrap, the buffer uses 64-bit sizes so rasters above 2^31 samples do not overflow)
+	template <typename T>
+	static mergetiff::RasterData<T> AllocateAndWrap(TArray64<T>& Buffer, uint64 Channels, uint64 Rows, uint64 Cols, T Fill)
+	{
+		Buffer.Init(Fill, (int64)(Channels * Rows * Cols));
+		return mergetiff::RasterData<T>(Buffer.GetData(), Channels, Rows, Cols, true);
+	}
+};
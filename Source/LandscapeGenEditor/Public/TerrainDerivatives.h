@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Computes the derived terrain maps used by lit landscape materials (surface normals, slope and ambient occlusion) from quantized
+// landscape height samples, processing blocks of rows in parallel with four-wide SIMD stencil kernels
+class TerrainDerivatives
+{
+public:
+	
+	// The maximum radius of the ambient occlusion window in samples, which keeps the window sums within 32-bit integers
+	static const int32 MaxOcclusionRadiusSamples = 64;
+	
+	// Computes the maps for a heightmap with the specified ground distance (in metres) between samples along each axis and height
+	// (in metres) per quantization step, writing them to caller-allocated buffers of the heightmap's dimensions:
+	// - OutNormals receives BGRA8 normals in the landscape's local space (X east, Y south, Z up), mapped from [-1,1] to [0,255]
+	// - OutSlope receives G8 slope angles, mapped from [0,90] degrees to [0,255]
+	// - OutOcclusion receives G8 ambient occlusion (where 255 is unoccluded), approximated from the mean height of the terrain within
+	//   the specified radius (in metres) of each sample
+	// (Any of the output buffers may be null, in which case the corresponding map is not computed)
+	static LANDSCAPEGENEDITOR_API void ComputeMaps(const TArray<uint16>& Samples, int32 SizeX, int32 SizeY, const FVector2D& MetresPerSample,
+		float MetresPerStep, float OcclusionRadius, uint8* OutNormals, uint8* OutSlope, uint8* OutOcclusion);
+};
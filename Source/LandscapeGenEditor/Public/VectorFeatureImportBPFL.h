@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "VectorFeatureImportBPFL.generated.h"
+
+class ALandscape;
+class UStaticMesh;
+
+// Options controlling how the features of an OGR vector layer are imported
+USTRUCT(BlueprintType)
+struct LANDSCAPEGENEDITOR_API FVectorFeatureImportOptions
+{
+	GENERATED_BODY()
+	
+	// The name of the layer to import (if this is empty then the first layer of the dataset is imported)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FString LayerName;
+	
+	// An OGR SQL attribute filter that selects the features to import, such as "highway = 'primary'" (empty to import all features)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FString AttributeFilter;
+	
+	// The mesh instanced at point features (e.g. trees and poles) and along line features (e.g. fence posts)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	UStaticMesh* PointMesh = nullptr;
+	
+	// The spacing (in metres) between the instances of the point mesh placed along line features (zero disables this)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float LineInstanceSpacing = 0.0f;
+	
+	// Specifies whether a spline is created for each line feature (e.g. roads) and for the outer ring of each polygon feature
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool bCreateSplines = true;
+	
+	// The mesh instanced at polygon features (e.g. building footprints), which is scaled to fit the bounds of each polygon
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	UStaticMesh* PolygonMesh = nullptr;
+	
+	// The name of the attribute holding the height (in metres) of polygon features (e.g. building heights)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FString HeightAttribute;
+	
+	// The height (in metres) used for polygon features that do not have a height attribute
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float DefaultPolygonHeight = 10.0f;
+	
+	// Specifies whether point mesh instances are given a random rotation about the vertical axis
+	// (The rotation is seeded by the feature ID, so repeated imports produce the same result)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool bRandomYaw = true;
+	
+	// The number of features projected by each worker thread task
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	int32 FeaturesPerBatch = 4096;
+};
+
+UCLASS()
+class LANDSCAPEGENEDITOR_API UVectorFeatureImportBPFL : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	
+	// Imports the features of an OGR vector layer (e.g. from a shapefile, GeoPackage or GeoJSON file) as hierarchical instanced
+	// static meshes and splines draped over a generated landscape, returning the actor holding the imported features
+	// (Features are read in a single sequential pass and projected through the landscape's geotransform in parallel batches on worker threads)
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Vector")
+	static AActor* ImportVectorFeatures(
+		const UObject* WorldContext, ALandscape* Landscape, const FString& DatasetPath, const FVectorFeatureImportOptions& Options
+	);
+};
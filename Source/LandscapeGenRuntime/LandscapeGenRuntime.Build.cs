@@ -20,7 +20,10 @@ public class LandscapeGenRuntime : ModuleRules
 				"Engine",
 				"Landscape",
 				"UnrealGDAL",
-				"GDAL"
+				"GDAL",
+				"ProceduralMeshComponent",
+				"Http",
+				"ImageWrapper"
 			}
 		);
 	}
@@ -1,5 +1,8 @@
 #include "GISDataComponent.h"
+#include "Engine/World.h"
+#include "GISLandscapeSubsystem.h"
 #include "Landscape.h"
+#include "LandscapeGenRuntime.h"
 
 // Sets default values for this component's properties
 UGISDataComponent::UGISDataComponent()
@@ -15,6 +18,124 @@ void UGISDataComponent::BeginPlay()
 	Super::BeginPlay();
 }
 
+void UGISDataComponent::PostLoad()
+{
+	Super::PostLoad();
+	if (this->Projection.Method == EMapProjectionMethod::Unresolved && !this->WKT.IsEmpty()) {
+		this->Projection = FMapProjection::FromWKT(this->WKT);
+	}
+}
+
+void UGISDataComponent::OnRegister()
+{
+	Super::OnRegister();
+	this->UpdateSpatialIndex();
+}
+
+void UGISDataComponent::OnUnregister()
+{
+	UWorld* World = this->GetWorld();
+	UGISLandscapeSubsystem* Subsystem = (World != nullptr) ? World->GetSubsystem<UGISLandscapeSubsystem>() : nullptr;
+	if (Subsystem != nullptr) {
+		Subsystem->RemoveComponent(this);
+	}
+	
+	Super::OnUnregister();
+}
+
+void UGISDataComponent::UpdateSpatialIndex()
+{
+	UWorld* World = this->GetWorld();
+	UGISLandscapeSubsystem* Subsystem = (World != nullptr) ? World->GetSubsystem<UGISLandscapeSubsystem>() : nullptr;
+	if (Subsystem != nullptr && this->IsRegistered()) {
+		Subsystem->AddComponent(this);
+	}
+}
+
+void UGISDataComponent::SetWKT(const FString& NewWKT)
+{
+	this->WKT = NewWKT;
+	this->Projection = FMapProjection::FromWKT(NewWKT);
+	this->FromWGS84 = nullptr;
+	this->ToWGS84 = nullptr;
+}
+
+bool UGISDataComponent::GPSToProjected(double Latitude, double Longitude, double& OutX, double& OutY)
+{
+	if (this->Projection.IsBuiltIn()) {
+		return this->Projection.GeographicToProjected(Latitude, Longitude, OutX, OutY);
+	}
+	
+	FLandscapeGenRuntimeModule::EnsureGDALInitialized();
+	if (!this->FromWGS84) {
+		this->FromWGS84 = GDALHelpers::CreateCoordinateTransform(GDALHelpers::WktFromEPSG(4326), this->WKT);
+	}
+	
+	// Prior to GDAL 3.0, coordinate transformations expect WGS84 coordinates to be in (lon,lat) format instead of (lat,lon)
+	// (See: https://gdal.org/tutorials/osr_api_tut.html#crs-and-axis-order)
+	#if GDAL_VERSION_NUM < GDAL_COMPUTE_VERSION(3,0,0)
+		OutX = Longitude;
+		OutY = Latitude;
+	#else
+		OutX = Latitude;
+		OutY = Longitude;
+	#endif
+	
+	return this->FromWGS84 && this->FromWGS84->Transform(1, &OutX, &OutY);
+}
+
+bool UGISDataComponent::ProjectedToGPS(double X, double Y, double& OutLatitude, double& OutLongitude)
+{
+	if (this->Projection.IsBuiltIn()) {
+		return this->Projection.ProjectedToGeographic(X, Y, OutLatitude, OutLongitude);
+	}
+	
+	FLandscapeGenRuntimeModule::EnsureGDALInitialized();
+	if (!this->ToWGS84) {
+		this->ToWGS84 = GDALHelpers::CreateCoordinateTransform(this->WKT, GDALHelpers::WktFromEPSG(4326));
+	}
+	
+	if (!this->ToWGS84 || !this->ToWGS84->Transform(1, &X, &Y)) {
+		return false;
+	}
+	
+	// Prior to GDAL 3.0, coordinate transformations expect WGS84 coordinates to be in (lon,lat) format instead of (lat,lon)
+	// (See: https://gdal.org/tutorials/osr_api_tut.html#crs-and-axis-order)
+	#if GDAL_VERSION_NUM < GDAL_COMPUTE_VERSION(3,0,0)
+		OutLatitude = Y;
+		OutLongitude = X;
+	#else
+		OutLatitude = X;
+		OutLongitude = Y;
+	#endif
+	
+	return true;
+}
+
+bool UGISDataComponent::GPSToProjected(const FVector2D& GPSCoordinate, FVector2D& OutProjected)
+{
+	double X;
+	double Y;
+	if (this->GPSToProjected(GPSCoordinate.X, GPSCoordinate.Y, X, Y) == false) {
+		return false;
+	}
+	
+	OutProjected = FVector2D(X, Y);
+	return true;
+}
+
+bool UGISDataComponent::ProjectedToGPS(const FVector2D& Projected, FVector2D& OutGPSCoordinate)
+{
+	double Latitude;
+	double Longitude;
+	if (this->ProjectedToGPS(Projected.X, Projected.Y, Latitude, Longitude) == false) {
+		return false;
+	}
+	
+	OutGPSCoordinate = FVector2D(Latitude, Longitude);
+	return true;
+}
+
 void UGISDataComponent::SetGeoTransforms(GDALDatasetRef& DatasetRef)
 {
 	GeoTransform.AddZeroed(6);
@@ -24,29 +145,35 @@ void UGISDataComponent::SetGeoTransforms(GDALDatasetRef& DatasetRef)
 	FMemory::Memcpy(InvGeoTransform.GetData(), GDALHelpers::GetInvertedGeoTransform(DatasetRef).Get(), 6 * sizeof(double));
 }
 
+void UGISDataComponent::SetGeoTransforms(const FVector2D& RasterUpperLeft, const FVector2D& RasterLowerRight, int32 RasterSizeX, int32 RasterSizeY)
+{
+	GeoTransform = {
+		RasterUpperLeft.X,
+		(RasterLowerRight.X - RasterUpperLeft.X) / RasterSizeX,
+		0.0,
+		RasterUpperLeft.Y,
+		0.0,
+		(RasterLowerRight.Y - RasterUpperLeft.Y) / RasterSizeY
+	};
+	
+	InvGeoTransform.SetNumZeroed(6);
+	GDALInvGeoTransform(GeoTransform.GetData(), InvGeoTransform.GetData());
+}
+
 FVector UGISDataComponent::GetWorldSpaceLocation(FVector2D GPSCoordinate)
 {
-	// Get Transform from lat long 
-	FString WGS84_WKT = GDALHelpers::WktFromEPSG(4326);
-	OGRCoordinateTransformationRef CoordTransform = GDALHelpers::CreateCoordinateTransform(WGS84_WKT, WKT);
-	
 	UE_LOG(LogTemp, Log, TEXT("coord %s"), *GPSCoordinate.ToString());
 	
 	UE_LOG(LogTemp, Log, TEXT("WKT:\n %s"), *WKT);	
 	
-	// LatLong to Projection
-	FVector Projected;
-	
-	// Prior to GDAL 3.0, coordinate transformations expect WGS84 coordinates to be in (lon,lat) format instead of (lat,lon)
-	// (See: https://gdal.org/tutorials/osr_api_tut.html#crs-and-axis-order)
-	#if GDAL_VERSION_NUM < GDAL_COMPUTE_VERSION(3,0,0)
-		GPSCoordinate = FVector2D(GPSCoordinate.Y, GPSCoordinate.X);
-	#endif
-	
-	check(GDALHelpers::TransformCoordinate(CoordTransform, FVector(GPSCoordinate, 0), Projected))
+	// LatLong to Projection (in double precision, since projected coordinates are too large to represent precisely as floats)
+	double ProjectedX;
+	double ProjectedY;
+	verify(this->GPSToProjected(GPSCoordinate.X, GPSCoordinate.Y, ProjectedX, ProjectedY));
 	
 	// Projection to pixel space
-	FVector2D PixelLoc = GDALHelpers::ApplyGeoTransform(InvGeoTransform.GetData(), FVector2D(Projected));
+	const double* Inv = InvGeoTransform.GetData();
+	FVector2D PixelLoc(Inv[0] + ProjectedX * Inv[1] + ProjectedY * Inv[2], Inv[3] + ProjectedX * Inv[4] + ProjectedY * Inv[5]);
 	
 	// Get Height at pixel from ALandscape
 	ALandscape* parent = (ALandscape*)GetAttachmentRootActor();
@@ -89,21 +216,14 @@ FVector2D UGISDataComponent::GetGPSLocation(const FVector& WorldSpaceCoordinate)
 	// Scale to pixel space
 	PixelCoordinate *= FVector2D(NumPixelsX, NumPixelsY);
 
-	// Convert PixelSpace to projection
-	FVector2D Projection = GDALHelpers::ApplyGeoTransform(GeoTransform.GetData(), PixelCoordinate);
-	
-	// Get Transform to lat long 
-	FString WGS84_WKT = GDALHelpers::WktFromEPSG(4326);
-	OGRCoordinateTransformationRef CoordTransform = GDALHelpers::CreateCoordinateTransform(WKT, WGS84_WKT);
-	
-	FVector Out;
-	check(GDALHelpers::TransformCoordinate(CoordTransform, FVector(Projection, 0), Out))
-	
-	// Prior to GDAL 3.0, coordinate transformations expect WGS84 coordinates to be in (lon,lat) format instead of (lat,lon)
-	// (See: https://gdal.org/tutorials/osr_api_tut.html#crs-and-axis-order)
-	#if GDAL_VERSION_NUM < GDAL_COMPUTE_VERSION(3,0,0)
-		Out = FVector(Out.Y, Out.X, Out.Z);
-	#endif
-	
-	return FVector2D(Out);
+	// Convert PixelSpace to projection (in double precision, since projected coordinates are too large to represent precisely as floats)
+	const double* Transform = GeoTransform.GetData();
+	double ProjectedX = Transform[0] + PixelCoordinate.X * Transform[1] + PixelCoordinate.Y * Transform[2];
+	double ProjectedY = Transform[3] + PixelCoordinate.X * Transform[4] + PixelCoordinate.Y * Transform[5];
+	
+	// Projection to lat long
+	double Latitude;
+	double Longitude;
+	verify(this->ProjectedToGPS(ProjectedX, ProjectedY, Latitude, Longitude));
+	return FVector2D(Latitude, Longitude);
 }
@@ -0,0 +1,169 @@
+#include "GISLandscapeSubsystem.h"
+#include "GISDataComponent.h"
+
+namespace
+{
+	// The size of each grid cell of the index, in degrees
+	const float CellSizeDegrees = 0.05f;
+	
+	// The maximum number of grid cells that a single footprint may be inserted into before it is treated as oversized
+	const int32 MaxCellsPerFootprint = 4096;
+	
+	// The number of points sampled along each edge of a component's extents when computing its footprint
+	// (Edges that are straight in the projected coordinate system may be curved in WGS84 coordinates)
+	const int32 SamplesPerEdge = 8;
+}
+
+void UGISLandscapeSubsystem::Deinitialize()
+{
+	this->Footprints.Empty();
+	this->Cells.Empty();
+	this->Oversized.Empty();
+	Super::Deinitialize();
+}
+
+void UGISLandscapeSubsystem::AddComponent(UGISDataComponent* Component)
+{
+	// Remove any existing entry for the component, since its geospatial metadata may have changed
+	this->RemoveComponent(Component);
+	
+	// Components that have not yet been populated with geospatial metadata cannot be indexed
+	if (Component == nullptr || Component->WKT.IsEmpty()) {
+		return;
+	}
+	
+	// Compute the bounds of the component's footprint in GPS coordinates by sampling points along the edges of its projected extents
+	FFootprint Footprint;
+	Footprint.Bounds = FBox2D(ForceInit);
+	for (int32 Sample = 0; Sample <= SamplesPerEdge; ++Sample)
+	{
+		float Alpha = (float)Sample / SamplesPerEdge;
+		FVector2D EdgePoints[] = {
+			FVector2D(FMath::Lerp(Component->UpperLeft.X, Component->LowerRight.X, Alpha), Component->UpperLeft.Y),
+			FVector2D(FMath::Lerp(Component->UpperLeft.X, Component->LowerRight.X, Alpha), Component->LowerRight.Y),
+			FVector2D(Component->UpperLeft.X, FMath::Lerp(Component->UpperLeft.Y, Component->LowerRight.Y, Alpha)),
+			FVector2D(Component->LowerRight.X, FMath::Lerp(Component->UpperLeft.Y, Component->LowerRight.Y, Alpha))
+		};
+		
+		for (const FVector2D& Point : EdgePoints)
+		{
+			FVector2D GPSCoordinate;
+			if (Component->ProjectedToGPS(Point, GPSCoordinate)) {
+				Footprint.Bounds += GPSCoordinate;
+			}
+		}
+	}
+	
+	if (!Footprint.Bounds.bIsValid)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to compute the geographic footprint of GIS data component %s"), *Component->GetPathName());
+		return;
+	}
+	
+	// Insert the component into each of the grid cells overlapped by its footprint, unless it overlaps too many of them
+	Footprint.MinCell = GetCell(Footprint.Bounds.Min);
+	Footprint.MaxCell = GetCell(Footprint.Bounds.Max);
+	int64 NumCells = (int64)(Footprint.MaxCell.X - Footprint.MinCell.X + 1) * (Footprint.MaxCell.Y - Footprint.MinCell.Y + 1);
+	if (NumCells > MaxCellsPerFootprint)
+	{
+		this->Oversized.Add(Component);
+		Footprint.MinCell = FIntPoint(0, 0);
+		Footprint.MaxCell = FIntPoint(-1, -1);
+	}
+	else
+	{
+		for (int32 Y = Footprint.MinCell.Y; Y <= Footprint.MaxCell.Y; ++Y)
+		{
+			for (int32 X = Footprint.MinCell.X; X <= Footprint.MaxCell.X; ++X) {
+				this->Cells.FindOrAdd(FIntPoint(X, Y)).Add(Component);
+			}
+		}
+	}
+	
+	this->Footprints.Add(Component, MoveTemp(Footprint));
+}
+
+void UGISLandscapeSubsystem::RemoveComponent(UGISDataComponent* Component)
+{
+	FFootprint* Footprint = this->Footprints.Find(Component);
+	if (Footprint == nullptr) {
+		return;
+	}
+	
+	for (int32 Y = Footprint->MinCell.Y; Y <= Footprint->MaxCell.Y; ++Y)
+	{
+		for (int32 X = Footprint->MinCell.X; X <= Footprint->MaxCell.X; ++X)
+		{
+			FIntPoint Cell(X, Y);
+			TArray<TWeakObjectPtr<UGISDataComponent>>* Entries = this->Cells.Find(Cell);
+			if (Entries != nullptr && Entries->RemoveSwap(Component) > 0 && Entries->Num() == 0) {
+				this->Cells.Remove(Cell);
+			}
+		}
+	}
+	
+	this->Oversized.RemoveSwap(Component);
+	this->Footprints.Remove(Component);
+}
+
+UGISDataComponent* UGISLandscapeSubsystem::FindComponentForGPSLocation(FVector2D GPSCoordinate)
+{
+	// Test the components in the grid cell containing the coordinate, followed by the oversized components
+	TArray<TWeakObjectPtr<UGISDataComponent>> Candidates = this->Oversized;
+	if (const TArray<TWeakObjectPtr<UGISDataComponent>>* Entries = this->Cells.Find(GetCell(GPSCoordinate))) {
+		Candidates.Append(*Entries);
+	}
+	
+	for (const TWeakObjectPtr<UGISDataComponent>& Candidate : Candidates)
+	{
+		UGISDataComponent* Component = Candidate.Get();
+		FFootprint* Footprint = this->Footprints.Find(Candidate);
+		if (Component != nullptr && Footprint != nullptr && Footprint->Bounds.IsInside(GPSCoordinate) && this->ContainsLocation(Component, GPSCoordinate)) {
+			return Component;
+		}
+	}
+	
+	return nullptr;
+}
+
+bool UGISLandscapeSubsystem::GetWorldSpaceLocation(FVector2D GPSCoordinate, FVector& WorldSpaceLocation)
+{
+	UGISDataComponent* Component = this->FindComponentForGPSLocation(GPSCoordinate);
+	if (Component == nullptr) {
+		return false;
+	}
+	
+	WorldSpaceLocation = Component->GetWorldSpaceLocation(GPSCoordinate);
+	return true;
+}
+
+TArray<UGISDataComponent*> UGISLandscapeSubsystem::GetAllComponents() const
+{
+	TArray<UGISDataComponent*> Components;
+	for (const TPair<TWeakObjectPtr<UGISDataComponent>, FFootprint>& Entry : this->Footprints)
+	{
+		if (UGISDataComponent* Component = Entry.Key.Get()) {
+			Components.Add(Component);
+		}
+	}
+	
+	return Components;
+}
+
+FIntPoint UGISLandscapeSubsystem::GetCell(const FVector2D& GPSCoordinate)
+{
+	return FIntPoint(FMath::FloorToInt(GPSCoordinate.X / CellSizeDegrees), FMath::FloorToInt(GPSCoordinate.Y / CellSizeDegrees));
+}
+
+bool UGISLandscapeSubsystem::ContainsLocation(UGISDataComponent* Component, const FVector2D& GPSCoordinate)
+{
+	FVector2D Projected;
+	if (Component->GPSToProjected(GPSCoordinate, Projected) == false) {
+		return false;
+	}
+	
+	return Projected.X >= FMath::Min(Component->UpperLeft.X, Component->LowerRight.X) &&
+		Projected.X <= FMath::Max(Component->UpperLeft.X, Component->LowerRight.X) &&
+		Projected.Y >= FMath::Min(Component->UpperLeft.Y, Component->LowerRight.Y) &&
+		Projected.Y <= FMath::Max(Component->UpperLeft.Y, Component->LowerRight.Y);
+}
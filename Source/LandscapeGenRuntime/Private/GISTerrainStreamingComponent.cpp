@@ -0,0 +1,622 @@
+#include "GISTerrainStreamingComponent.h"
+#include "Async/Async.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Containers/Queue.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HttpModule.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Misc/FileHelper.h"
+#include "Modules/ModuleManager.h"
+#include "ProceduralMeshComponent.h"
+#include "SlippyMapTiles.h"
+
+namespace
+{
+	// The radius of the WGS84 ellipsoid used by the Web Mercator projection of slippy map tiles
+	const double EarthRadius = 6378137.0;
+	
+	// A decoded height tile, with heights in metres (tiles that could not be loaded are flat)
+	struct FTerrainTile
+	{
+		TArray<float> Heights;
+	};
+	
+	typedef TSharedPtr<const FTerrainTile, ESPMode::ThreadSafe> FTerrainTilePtr;
+	
+	// A tile along with its eight neighbours (which are null if they lie outside the map or are not cached), so that chunk meshes
+	// can sample the heights on either side of the tile's edges
+	struct FTerrainTileNeighbourhood
+	{
+		FTerrainTilePtr Tiles[3][3];
+		
+		// Returns the height of the specified pixel relative to the centre tile, which may lie within a neighbouring tile
+		// (Pixels within unavailable neighbours fall back to the nearest pixel of the centre tile)
+		float GetHeight(int32 X, int32 Y, int32 TileSize) const
+		{
+			int32 TileX = FMath::Clamp((X + TileSize) / TileSize, 0, 2);
+			int32 TileY = FMath::Clamp((Y + TileSize) / TileSize, 0, 2);
+			const FTerrainTilePtr& Tile = this->Tiles[TileY][TileX];
+			if (!Tile.IsValid())
+			{
+				X = FMath::Clamp(X, 0, TileSize - 1);
+				Y = FMath::Clamp(Y, 0, TileSize - 1);
+				return this->Tiles[1][1]->Heights[Y * TileSize + X];
+			}
+			
+			X = FMath::Clamp(X - (TileX - 1) * TileSize, 0, TileSize - 1);
+			Y = FMath::Clamp(Y - (TileY - 1) * TileSize, 0, TileSize - 1);
+			return Tile->Heights[Y * TileSize + X];
+		}
+	};
+	
+	// The geometry for a single chunk at a given level of detail
+	struct FTerrainChunkMesh
+	{
+		FIntPoint Tile;
+		int32 LOD;
+		TArray<FVector> Vertices;
+		TArray<int32> Triangles;
+		TArray<FVector> Normals;
+		TArray<FVector2D> UVs;
+		TArray<FProcMeshTangent> Tangents;
+	};
+	
+	typedef TSharedPtr<FTerrainChunkMesh, ESPMode::ThreadSafe> FTerrainChunkMeshPtr;
+	
+	// The parameters required to build chunk meshes, captured by value for use on worker threads
+	struct FTerrainBuildParams
+	{
+		int32 TileSize;
+		float TileWorldSize;
+		float HeightScale;
+		float SkirtDepth;
+	};
+	
+	// Decodes a compressed height tile, returning null if the tile could not be decoded
+	FTerrainTilePtr DecodeHeightTile(const uint8* Bytes, int64 NumBytes, int32 TileSize, ETerrainHeightEncoding Encoding)
+	{
+		IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+		EImageFormat Format = ImageWrapperModule.DetectImageFormat(Bytes, NumBytes);
+		if (Format == EImageFormat::Invalid) {
+			return nullptr;
+		}
+		
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(Format);
+		if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(Bytes, NumBytes)) {
+			return nullptr;
+		}
+		
+		TArray64<uint8> RawData;
+		if (ImageWrapper->GetWidth() != TileSize || ImageWrapper->GetHeight() != TileSize || !ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, RawData)) {
+			return nullptr;
+		}
+		
+		TSharedPtr<FTerrainTile, ESPMode::ThreadSafe> Tile = MakeShared<FTerrainTile, ESPMode::ThreadSafe>();
+		Tile->Heights.SetNumUninitialized(TileSize * TileSize);
+		
+		const FColor* Src = (const FColor*)RawData.GetData();
+		for (int32 Index = 0; Index < Tile->Heights.Num(); ++Index)
+		{
+			Tile->Heights[Index] = (Encoding == ETerrainHeightEncoding::Terrarium)
+				? SlippyMapTiles::DecodeTerrarium(Src[Index])
+				: SlippyMapTiles::DecodeTerrainRGB(Src[Index]);
+		}
+		
+		return Tile;
+	}
+	
+	// Builds the grid geometry for a chunk, sampling every 2^LOD height samples, along with skirts around its edges
+	FTerrainChunkMeshPtr BuildChunkMesh(const FTerrainTileNeighbourhood& Neighbourhood, const FIntPoint& TileIndex, int32 LOD, const FTerrainBuildParams& Params)
+	{
+		FTerrainChunkMeshPtr Mesh = MakeShared<FTerrainChunkMesh, ESPMode::ThreadSafe>();
+		Mesh->Tile = TileIndex;
+		Mesh->LOD = LOD;
+		
+		// Vertices are placed at pixel corners, so the last row and column sample the first pixels of the tiles to the east and south
+		// (This places them at the same heights as the first row and column of the neighbouring chunks, so that adjacent chunks at
+		// the same level of detail share their edge vertices)
+		const int32 Step = 1 << LOD;
+		const int32 NumQuads = FMath::Max(1, Params.TileSize / Step);
+		const int32 NumVerts = NumQuads + 1;
+		const float QuadSize = Params.TileWorldSize / NumQuads;
+		const float HeightToWorld = 100.0f * Params.HeightScale;
+		
+		auto SampleHeight = [&](int32 X, int32 Y) -> float
+		{
+			X = FMath::DivideAndRoundDown(X * Params.TileSize, NumQuads);
+			Y = FMath::DivideAndRoundDown(Y * Params.TileSize, NumQuads);
+			return Neighbourhood.GetHeight(X, Y, Params.TileSize) * HeightToWorld;
+		};
+		
+		int32 NumGridVerts = NumVerts * NumVerts;
+		int32 NumSkirtVerts = NumQuads * 4 * 2;
+		Mesh->Vertices.Reserve(NumGridVerts + NumSkirtVerts);
+		Mesh->Normals.Reserve(NumGridVerts + NumSkirtVerts);
+		Mesh->UVs.Reserve(NumGridVerts + NumSkirtVerts);
+		Mesh->Tangents.Reserve(NumGridVerts + NumSkirtVerts);
+		Mesh->Triangles.Reserve(NumQuads * NumQuads * 6 + NumQuads * 4 * 12);
+		
+		// Generate the grid vertices, computing normals from central differences of the heights
+		for (int32 Y = 0; Y < NumVerts; ++Y)
+		{
+			for (int32 X = 0; X < NumVerts; ++X)
+			{
+				float DzDx = (SampleHeight(X + 1, Y) - SampleHeight(X - 1, Y)) / (2.0f * QuadSize);
+				float DzDy = (SampleHeight(X, Y + 1) - SampleHeight(X, Y - 1)) / (2.0f * QuadSize);
+				Mesh->Vertices.Add(FVector(X * QuadSize, Y * QuadSize, SampleHeight(X, Y)));
+				Mesh->Normals.Add(FVector(-DzDx, -DzDy, 1.0f).GetSafeNormal());
+				Mesh->UVs.Add(FVector2D((float)X / NumQuads, (float)Y / NumQuads));
+				Mesh->Tangents.Add(FProcMeshTangent(FVector(1.0f, 0.0f, DzDx).GetSafeNormal(), false));
+			}
+		}
+		
+		// Generate the grid triangles
+		for (int32 Y = 0; Y < NumQuads; ++Y)
+		{
+			for (int32 X = 0; X < NumQuads; ++X)
+			{
+				int32 TopLeft = Y * NumVerts + X;
+				int32 BottomLeft = TopLeft + NumVerts;
+				Mesh->Triangles.Append({ TopLeft, BottomLeft, BottomLeft + 1 });
+				Mesh->Triangles.Append({ TopLeft, BottomLeft + 1, TopLeft + 1 });
+			}
+		}
+		
+		// Generate a skirt hanging below each edge of the grid (skirts are double-sided so that they hide cracks from either side)
+		const FIntPoint EdgeStarts[] = { FIntPoint(0, 0), FIntPoint(NumQuads, 0), FIntPoint(NumQuads, NumQuads), FIntPoint(0, NumQuads) };
+		const FIntPoint EdgeSteps[] = { FIntPoint(1, 0), FIntPoint(0, 1), FIntPoint(-1, 0), FIntPoint(0, -1) };
+		const float SkirtOffset = Params.SkirtDepth * 100.0f;
+		for (int32 Edge = 0; Edge < 4; ++Edge)
+		{
+			for (int32 Segment = 0; Segment < NumQuads; ++Segment)
+			{
+				int32 First = Mesh->Vertices.Num();
+				for (int32 End = 0; End < 2; ++End)
+				{
+					FIntPoint Grid = EdgeStarts[Edge] + EdgeSteps[Edge] * (Segment + End);
+					const FVector& Top = Mesh->Vertices[Grid.Y * NumVerts + Grid.X];
+					Mesh->Vertices.Add(Top);
+					Mesh->Vertices.Add(Top - FVector(0.0f, 0.0f, SkirtOffset));
+					for (int32 Copy = 0; Copy < 2; ++Copy)
+					{
+						Mesh->Normals.Add(Mesh->Normals[Grid.Y * NumVerts + Grid.X]);
+						Mesh->UVs.Add(Mesh->UVs[Grid.Y * NumVerts + Grid.X]);
+						Mesh->Tangents.Add(Mesh->Tangents[Grid.Y * NumVerts + Grid.X]);
+					}
+				}
+				
+				Mesh->Triangles.Append({ First, First + 1, First + 3, First, First + 3, First + 2 });
+				Mesh->Triangles.Append({ First, First + 3, First + 1, First, First + 2, First + 3 });
+			}
+		}
+		
+		return Mesh;
+	}
+}
+
+// The state shared between the component and the worker threads that load tiles and build chunk meshes
+struct FTerrainStreamingState
+{
+	// Set when the component stops streaming, so that worker threads can discard their results
+	FThreadSafeBool bShutdown;
+	
+	// The tiles that have been loaded (or have failed to load, in which case the tile is null) and the chunk meshes that have been built
+	TQueue<TPair<FIntPoint, FTerrainTilePtr>, EQueueMode::Mpsc> LoadedTiles;
+	TQueue<FTerrainChunkMeshPtr, EQueueMode::Mpsc> BuiltChunks;
+	
+	// The remaining members are only accessed on the game thread
+	
+	// The cache of decoded tiles, along with the order in which they were last used (least recently used first)
+	TMap<FIntPoint, FTerrainTilePtr> TileCache;
+	TArray<FIntPoint> TileUsage;
+	
+	// The tiles that are loading and the HTTP requests that have been sent for them
+	TSet<FIntPoint> PendingTiles;
+	TArray<FHttpRequestPtr> PendingRequests;
+	
+	// The number of chunk meshes that are building or waiting to be uploaded
+	int32 BuildsInFlight = 0;
+	
+	void TouchTile(const FIntPoint& Tile)
+	{
+		this->TileUsage.Remove(Tile);
+		this->TileUsage.Add(Tile);
+	}
+};
+
+UGISTerrainStreamingComponent::UGISTerrainStreamingComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+}
+
+void UGISTerrainStreamingComponent::BeginPlay()
+{
+	Super::BeginPlay();
+	this->StartStreaming();
+}
+
+void UGISTerrainStreamingComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	this->StopStreaming();
+	Super::EndPlay(EndPlayReason);
+}
+
+int32 UGISTerrainStreamingComponent::GetNumLoadedChunks() const
+{
+	int32 NumLoaded = 0;
+	for (const TPair<FIntPoint, FTerrainChunk>& Chunk : this->Chunks) {
+		NumLoaded += (Chunk.Value.LOD >= 0) ? 1 : 0;
+	}
+	
+	return NumLoaded;
+}
+
+void UGISTerrainStreamingComponent::RebuildTerrain()
+{
+	this->StopStreaming();
+	this->StartStreaming();
+}
+
+void UGISTerrainStreamingComponent::SetOrigin(float Latitude, float Longitude)
+{
+	this->OriginLatitude = Latitude;
+	this->OriginLongitude = Longitude;
+	this->RebuildTerrain();
+}
+
+void UGISTerrainStreamingComponent::StartStreaming()
+{
+	// Ensure the image wrapper module is loaded on the game thread before any worker threads make use of it
+	FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	this->State = MakeShared<FTerrainStreamingState, ESPMode::ThreadSafe>();
+}
+
+void UGISTerrainStreamingComponent::StopStreaming()
+{
+	if (this->State.IsValid())
+	{
+		// Signal the worker threads to discard their results, they will release the state once they drop their references to it
+		this->State->bShutdown = true;
+		
+		// Unbind our completion handler before cancelling so that cancelled requests are not processed
+		TArray<FHttpRequestPtr> Requests = MoveTemp(this->State->PendingRequests);
+		for (FHttpRequestPtr& Request : Requests)
+		{
+			Request->OnProcessRequestComplete().Unbind();
+			Request->CancelRequest();
+		}
+		
+		this->State.Reset();
+	}
+	
+	for (TPair<FIntPoint, FTerrainChunk>& Chunk : this->Chunks) {
+		this->ReleaseChunk(Chunk.Value);
+	}
+	
+	this->Chunks.Empty();
+}
+
+void UGISTerrainStreamingComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	
+	if (!this->State.IsValid() || this->HeightTileSource.IsEmpty()) {
+		return;
+	}
+	
+	this->ProcessLoadedTiles();
+	this->UpdateChunks();
+	this->UploadBuiltChunks();
+}
+
+void UGISTerrainStreamingComponent::GetOriginMercator(double& OutX, double& OutY, double& OutScale) const
+{
+	// (The C maths functions are used directly, since the FMath equivalents operate in single precision)
+	double OriginLatRad = FMath::DegreesToRadians(this->OriginLatitude);
+	OutScale = 100.0 * cos(OriginLatRad);
+	OutX = EarthRadius * FMath::DegreesToRadians(this->OriginLongitude);
+	OutY = EarthRadius * log(tan(PI / 4.0 + OriginLatRad / 2.0));
+}
+
+void UGISTerrainStreamingComponent::GetViewpointTile(double& OutTileX, double& OutTileY) const
+{
+	// Determine the viewpoint location, preferring the specified actor and falling back to the first player's camera
+	FVector Viewpoint = this->GetComponentLocation();
+	APlayerController* PlayerController = (this->GetWorld() != nullptr) ? this->GetWorld()->GetFirstPlayerController() : nullptr;
+	if (this->ViewpointActor != nullptr) {
+		Viewpoint = this->ViewpointActor->GetActorLocation();
+	}
+	else if (PlayerController != nullptr && PlayerController->PlayerCameraManager != nullptr) {
+		Viewpoint = PlayerController->PlayerCameraManager->GetCameraLocation();
+	}
+	
+	FVector Local = this->GetComponentTransform().InverseTransformPosition(Viewpoint);
+	
+	// Convert the local tangent plane location to Web Mercator coordinates and then to a fractional tile index
+	double OriginX, OriginY, Scale;
+	this->GetOriginMercator(OriginX, OriginY, Scale);
+	double MercatorX = OriginX + Local.X / Scale;
+	double MercatorY = OriginY - Local.Y / Scale;
+	
+	double TileSpan = 2.0 * PI * EarthRadius / (double)(1 << this->Zoom);
+	OutTileX = (MercatorX + PI * EarthRadius) / TileSpan;
+	OutTileY = (PI * EarthRadius - MercatorY) / TileSpan;
+}
+
+FVector UGISTerrainStreamingComponent::GetTileOrigin(const FIntPoint& Tile) const
+{
+	double OriginX, OriginY, Scale;
+	this->GetOriginMercator(OriginX, OriginY, Scale);
+	
+	double TileSpan = 2.0 * PI * EarthRadius / (double)(1 << this->Zoom);
+	double MercatorX = Tile.X * TileSpan - PI * EarthRadius;
+	double MercatorY = PI * EarthRadius - Tile.Y * TileSpan;
+	return FVector((MercatorX - OriginX) * Scale, (OriginY - MercatorY) * Scale, 0.0f);
+}
+
+float UGISTerrainStreamingComponent::GetTileWorldSize() const
+{
+	double TileSpan = 2.0 * PI * EarthRadius / (double)(1 << this->Zoom);
+	return TileSpan * 100.0 * cos(FMath::DegreesToRadians(this->OriginLatitude));
+}
+
+void UGISTerrainStreamingComponent::ProcessLoadedTiles()
+{
+	TPair<FIntPoint, FTerrainTilePtr> Loaded;
+	while (this->State->LoadedTiles.Dequeue(Loaded))
+	{
+		this->State->PendingTiles.Remove(Loaded.Key);
+		
+		// Substitute a flat tile for any tile that could not be loaded so that we don't repeatedly request it
+		if (!Loaded.Value.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Failed to load height tile %d/%d/%d"), this->Zoom, Loaded.Key.X, Loaded.Key.Y);
+			TSharedPtr<FTerrainTile, ESPMode::ThreadSafe> FlatTile = MakeShared<FTerrainTile, ESPMode::ThreadSafe>();
+			FlatTile->Heights.SetNumZeroed(this->TileSize * this->TileSize);
+			Loaded.Value = FlatTile;
+		}
+		
+		this->State->TileCache.Add(Loaded.Key, Loaded.Value);
+		this->State->TouchTile(Loaded.Key);
+	}
+	
+	// Evict the least recently used tiles once the cache exceeds its budget
+	while (this->State->TileUsage.Num() > FMath::Max(this->MaxCachedTiles, 1))
+	{
+		this->State->TileCache.Remove(this->State->TileUsage[0]);
+		this->State->TileUsage.RemoveAt(0);
+	}
+}
+
+void UGISTerrainStreamingComponent::UpdateChunks()
+{
+	double ViewTileX, ViewTileY;
+	this->GetViewpointTile(ViewTileX, ViewTileY);
+	FIntPoint Centre((int32)FMath::FloorToDouble(ViewTileX), (int32)FMath::FloorToDouble(ViewTileY));
+	
+	// Distances between tile centres and the viewpoint are computed in double precision, since tile indices at high zoom levels
+	// exceed the range over which single precision can represent fractions of a tile
+	auto GetTileDistance = [ViewTileX, ViewTileY](const FIntPoint& Tile) -> float
+	{
+		double OffsetX = Tile.X + 0.5 - ViewTileX;
+		double OffsetY = Tile.Y + 0.5 - ViewTileY;
+		return (float)sqrt(OffsetX * OffsetX + OffsetY * OffsetY);
+	};
+	
+	int32 NumTiles = 1 << this->Zoom;
+	int32 MaxLOD = FMath::Min(this->NumLODs - 1, (int32)FMath::FloorLog2(FMath::Max(this->TileSize, 1)));
+	
+	// Release chunks that have moved outside the view radius (with a margin of one tile to avoid thrashing at the boundary)
+	for (auto It = this->Chunks.CreateIterator(); It; ++It)
+	{
+		if (GetTileDistance(It.Key()) > this->ViewRadiusTiles + 1.5f)
+		{
+			this->ReleaseChunk(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+	
+	// Determine the level of detail required for each tile within the view radius, nearest tiles first
+	TArray<TPair<float, FIntPoint>> Desired;
+	for (int32 Y = Centre.Y - this->ViewRadiusTiles; Y <= Centre.Y + this->ViewRadiusTiles; ++Y)
+	{
+		for (int32 X = Centre.X - this->ViewRadiusTiles; X <= Centre.X + this->ViewRadiusTiles; ++X)
+		{
+			float Distance = GetTileDistance(FIntPoint(X, Y));
+			if (X >= 0 && X < NumTiles && Y >= 0 && Y < NumTiles && Distance <= this->ViewRadiusTiles + 0.5f) {
+				Desired.Add(TPair<float, FIntPoint>(Distance, FIntPoint(X, Y)));
+			}
+		}
+	}
+	
+	Desired.Sort([](const TPair<float, FIntPoint>& A, const TPair<float, FIntPoint>& B) { return A.Key < B.Key; });
+	
+	for (const TPair<float, FIntPoint>& Entry : Desired)
+	{
+		const FIntPoint& Tile = Entry.Value;
+		int32 LOD = FMath::Clamp(FMath::FloorToInt(Entry.Key / this->LODDistanceTiles), 0, MaxLOD);
+		
+		FTerrainChunk* Chunk = this->Chunks.Find(Tile);
+		if (Chunk != nullptr && (Chunk->PendingLOD == LOD || (Chunk->PendingLOD < 0 && Chunk->LOD == LOD))) {
+			continue;
+		}
+		
+		// Request the height tile and its neighbours if they are not cached, since the edges of the chunk sample the neighbouring tiles
+		bool bTilesCached = true;
+		for (int32 OffsetY = -1; OffsetY <= 1; ++OffsetY)
+		{
+			for (int32 OffsetX = -1; OffsetX <= 1; ++OffsetX)
+			{
+				FIntPoint Neighbour = Tile + FIntPoint(OffsetX, OffsetY);
+				if (Neighbour.X < 0 || Neighbour.X >= NumTiles || Neighbour.Y < 0 || Neighbour.Y >= NumTiles || this->State->TileCache.Contains(Neighbour)) {
+					continue;
+				}
+				
+				bTilesCached = false;
+				if (!this->State->PendingTiles.Contains(Neighbour) && this->State->PendingTiles.Num() < this->MaxConcurrentTileLoads) {
+					this->RequestTile(Neighbour);
+				}
+			}
+		}
+		
+		if (!bTilesCached) {
+			continue;
+		}
+		
+		// Build the chunk at the required level of detail if there is room in the build budget
+		if (this->State->BuildsInFlight < this->MaxConcurrentBuilds)
+		{
+			if (Chunk == nullptr) {
+				Chunk = &this->Chunks.Add(Tile);
+			}
+			
+			Chunk->PendingLOD = LOD;
+			this->BuildChunk(Tile, LOD);
+		}
+	}
+}
+
+void UGISTerrainStreamingComponent::UploadBuiltChunks()
+{
+	int32 NumUploads = 0;
+	FTerrainChunkMeshPtr Built;
+	while (NumUploads < this->MaxUploadsPerTick && this->State->BuiltChunks.Dequeue(Built))
+	{
+		this->State->BuildsInFlight--;
+		
+		// Discard meshes for chunks that have streamed out or that have since been rebuilt at a different level of detail
+		FTerrainChunk* Chunk = this->Chunks.Find(Built->Tile);
+		if (Chunk == nullptr || Chunk->PendingLOD != Built->LOD) {
+			continue;
+		}
+		
+		// Reuse a mesh component released by another chunk if one is available
+		if (Chunk->Mesh == nullptr)
+		{
+			if (this->FreeMeshes.Num() > 0) {
+				Chunk->Mesh = this->FreeMeshes.Pop();
+			}
+			else
+			{
+				Chunk->Mesh = NewObject<UProceduralMeshComponent>(this->GetOwner(), NAME_None, RF_Transient);
+				Chunk->Mesh->bUseAsyncCooking = true;
+				Chunk->Mesh->SetupAttachment(this);
+				Chunk->Mesh->RegisterComponent();
+			}
+			
+			Chunk->Mesh->SetRelativeLocation(this->GetTileOrigin(Built->Tile));
+			Chunk->Mesh->SetMaterial(0, this->Material);
+		}
+		
+		// Replace the chunk's geometry, which is uploaded to the GPU by the render thread
+		Chunk->Mesh->CreateMeshSection(0, Built->Vertices, Built->Triangles, Built->Normals, Built->UVs, TArray<FColor>(), Built->Tangents, this->bCreateCollision);
+		Chunk->LOD = Built->LOD;
+		Chunk->PendingLOD = -1;
+		NumUploads++;
+	}
+}
+
+void UGISTerrainStreamingComponent::RequestTile(const FIntPoint& Tile)
+{
+	this->State->PendingTiles.Add(Tile);
+	
+	TSharedRef<FTerrainStreamingState, ESPMode::ThreadSafe> StateRef = this->State.ToSharedRef();
+	FString Source = SlippyMapTiles::ExpandTileTemplate(this->HeightTileSource, this->Zoom, Tile.X, Tile.Y);
+	int32 Size = this->TileSize;
+	ETerrainHeightEncoding Encoding = this->HeightEncoding;
+	
+	// Read local tiles directly on a worker thread
+	if (!Source.StartsWith(TEXT("http://")) && !Source.StartsWith(TEXT("https://")))
+	{
+		Source.RemoveFromStart(TEXT("file://"));
+		Async(EAsyncExecution::ThreadPool, [StateRef, Tile, Source, Size, Encoding]()
+		{
+			TArray<uint8> Bytes;
+			FTerrainTilePtr Decoded;
+			if (!StateRef->bShutdown && FFileHelper::LoadFileToArray(Bytes, *Source, FILEREAD_Silent)) {
+				Decoded = DecodeHeightTile(Bytes.GetData(), Bytes.Num(), Size, Encoding);
+			}
+			
+			StateRef->LoadedTiles.Enqueue(TPair<FIntPoint, FTerrainTilePtr>(Tile, Decoded));
+		});
+		
+		return;
+	}
+	
+	// Fetch remote tiles over HTTP and decode them on a worker thread rather than blocking the game thread
+	TSharedRef<IHttpRequest> HttpRequest = FHttpModule::Get().CreateRequest();
+	HttpRequest->OnProcessRequestComplete().BindLambda([StateRef, Tile, Size, Encoding](FHttpRequestPtr CompletedRequest, FHttpResponsePtr Response, bool bSucceeded)
+	{
+		StateRef->PendingRequests.Remove(CompletedRequest);
+		if (!bSucceeded || !Response.IsValid() || Response->GetContentLength() <= 0)
+		{
+			StateRef->LoadedTiles.Enqueue(TPair<FIntPoint, FTerrainTilePtr>(Tile, nullptr));
+			return;
+		}
+		
+		Async(EAsyncExecution::ThreadPool, [StateRef, Tile, Size, Encoding, Content = Response->GetContent()]()
+		{
+			FTerrainTilePtr Decoded = StateRef->bShutdown ? nullptr : DecodeHeightTile(Content.GetData(), Content.Num(), Size, Encoding);
+			StateRef->LoadedTiles.Enqueue(TPair<FIntPoint, FTerrainTilePtr>(Tile, Decoded));
+		});
+	});
+	
+	HttpRequest->SetURL(Source);
+	HttpRequest->SetVerb(TEXT("GET"));
+	
+	// Add the request to the pending list first, since its completion callback (which removes it) can run before ProcessRequest() returns
+	this->State->PendingRequests.Add(HttpRequest);
+	HttpRequest->ProcessRequest();
+}
+
+void UGISTerrainStreamingComponent::BuildChunk(const FIntPoint& Tile, int32 LOD)
+{
+	// Capture the tile along with whichever of its neighbours are cached, so that the edges of the chunk match those of its neighbours
+	FTerrainTileNeighbourhood Neighbourhood;
+	Neighbourhood.Tiles[1][1] = this->State->TileCache.FindChecked(Tile);
+	for (int32 OffsetY = -1; OffsetY <= 1; ++OffsetY)
+	{
+		for (int32 OffsetX = -1; OffsetX <= 1; ++OffsetX)
+		{
+			FIntPoint Neighbour = Tile + FIntPoint(OffsetX, OffsetY);
+			FTerrainTilePtr* Cached = this->State->TileCache.Find(Neighbour);
+			if (Cached != nullptr)
+			{
+				Neighbourhood.Tiles[OffsetY + 1][OffsetX + 1] = *Cached;
+				this->State->TouchTile(Neighbour);
+			}
+		}
+	}
+	
+	this->State->BuildsInFlight++;
+	
+	FTerrainBuildParams Params;
+	Params.TileSize = this->TileSize;
+	Params.TileWorldSize = this->GetTileWorldSize();
+	Params.HeightScale = this->HeightScale;
+	Params.SkirtDepth = this->SkirtDepth;
+	
+	TSharedRef<FTerrainStreamingState, ESPMode::ThreadSafe> StateRef = this->State.ToSharedRef();
+	Async(EAsyncExecution::ThreadPool, [StateRef, Neighbourhood, Tile, LOD, Params]()
+	{
+		if (!StateRef->bShutdown) {
+			StateRef->BuiltChunks.Enqueue(BuildChunkMesh(Neighbourhood, Tile, LOD, Params));
+		}
+	});
+}
+
+void UGISTerrainStreamingComponent::ReleaseChunk(FTerrainChunk& Chunk)
+{
+	if (Chunk.Mesh != nullptr)
+	{
+		Chunk.Mesh->ClearAllMeshSections();
+		this->FreeMeshes.Add(Chunk.Mesh);
+		Chunk.Mesh = nullptr;
+	}
+}
@@ -1,16 +1,31 @@
 #include "LandscapeGenRuntime.h"
 #include "UnrealGDAL.h"
+#include "Misc/ScopeLock.h"
 
 #define LOCTEXT_NAMESPACE "FLandscapeGenRuntimeModule"
 
-void FLandscapeGenRuntimeModule::StartupModule()
-{
-	FUnrealGDALModule* UnrealGDAL = FModuleManager::Get().LoadModulePtr<FUnrealGDALModule>("UnrealGDAL");
-	UnrealGDAL->InitGDAL();
-}
+void FLandscapeGenRuntimeModule::StartupModule() {}
 
 void FLandscapeGenRuntimeModule::ShutdownModule() {}
 
+void FLandscapeGenRuntimeModule::EnsureGDALInitialized()
+{
+	static FCriticalSection Lock;
+	static TAtomic<bool> bInitialized(false);
+	if (bInitialized) {
+		return;
+	}
+	
+	// The UnrealGDAL module is a dependency of every module that uses GDAL, so it has already been loaded by the time we get here
+	FScopeLock ScopedLock(&Lock);
+	if (!bInitialized)
+	{
+		FUnrealGDALModule* UnrealGDAL = FModuleManager::Get().LoadModulePtr<FUnrealGDALModule>("UnrealGDAL");
+		UnrealGDAL->InitGDAL();
+		bInitialized = true;
+	}
+}
+
 #undef LOCTEXT_NAMESPACE
 
 IMPLEMENT_MODULE(FLandscapeGenRuntimeModule, LandscapeGenRuntime)
\ No newline at end of file
@@ -3,8 +3,11 @@
 #include "CoreMinimal.h"
 #include "Components/SceneComponent.h"
 #include "GDALHelpers.h"
+#include "MapProjection.h"
 #include "GISDataComponent.generated.h"
 
+class UTexture2D;
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class LANDSCAPEGENRUNTIME_API UGISDataComponent : public USceneComponent
 {
@@ -39,14 +42,57 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	FString WKT;
 	
+	// The projection selected for the WKT when the landscape was generated, which converts coordinates without GDAL where possible
+	UPROPERTY(VisibleAnywhere)
+	FMapProjection Projection;
+	
+	// The derived terrain maps computed from the heightmap when the landscape was generated (if any), which cover the same extents as
+	// the heightmap so that lit materials can sample them with the landscape's coordinates
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UTexture2D* NormalMap = nullptr;
+	
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UTexture2D* SlopeMap = nullptr;
+	
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UTexture2D* AmbientOcclusionMap = nullptr;
+	
 protected:
 	
 	// Called when the game starts
 	virtual void BeginPlay() override;
 	
+	// Selects the projection for components that were saved before projections were selected at generation time
+	virtual void PostLoad() override;
+	
+	// Adds or removes the component from the world's index of GIS data components
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+	
 public:
 	void SetGeoTransforms(GDALDatasetRef& GPSCoordinate);
 	
+	// Computes the geotransforms for a north-up raster of the specified size from its projected corner coordinates
+	void SetGeoTransforms(const FVector2D& RasterUpperLeft, const FVector2D& RasterLowerRight, int32 RasterSizeX, int32 RasterSizeY);
+	
+	// Sets the projected coordinate system and selects the projection used to convert coordinates to and from it
+	void SetWKT(const FString& NewWKT);
+	
+	// Converts between GPS coordinates and coordinates in the projected coordinate system, returning false if the conversion fails
+	// (GDAL is initialised and used only if the projected coordinate system is not supported by the built-in projections)
+	bool GPSToProjected(double Latitude, double Longitude, double& OutX, double& OutY);
+	bool ProjectedToGPS(double X, double Y, double& OutLatitude, double& OutLongitude);
+	
+	// Converts coordinates as above, with single precision inputs and outputs (which limits projected coordinates to metre accuracy)
+	bool GPSToProjected(const FVector2D& GPSCoordinate, FVector2D& OutProjected);
+	bool ProjectedToGPS(const FVector2D& Projected, FVector2D& OutGPSCoordinate);
+	
+	// Updates the component's entry in the world's index of GIS data components (call this after changing the geospatial metadata)
+	void UpdateSpatialIndex();
+	
+	// Returns the geotransform that maps projected coordinates to pixel coordinates in the landscape's heightmap
+	const TArray<double>& GetInvGeoTransform() const { return InvGeoTransform; }
+	
 	UFUNCTION(BlueprintCallable, CallInEditor)
 	FVector GetWorldSpaceLocation(FVector2D GPSCoordinate);
 	
@@ -59,4 +105,9 @@ private:
 	
 	UPROPERTY()
 	TArray<double> InvGeoTransform;
+	
+	// The GDAL coordinate transformations used for projected coordinate systems that are not supported by the built-in projections
+	// (These are created on first use)
+	OGRCoordinateTransformationRef FromWGS84;
+	OGRCoordinateTransformationRef ToWGS84;
 };
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GISLandscapeSubsystem.generated.h"
+
+class UGISDataComponent;
+
+// Maintains a spatial index of the geographic footprints of all of the GIS data components in a world, so that the landscape containing
+// a given GPS coordinate can be found without scanning every actor in maps that contain many generated landscapes
+//
+// GPS coordinates use the same (latitude, longitude) convention as UGISDataComponent.
+UCLASS()
+class LANDSCAPEGENRUNTIME_API UGISLandscapeSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	
+	virtual void Deinitialize() override;
+	
+	// Adds a GIS data component to the index, or updates its footprint if it has already been added
+	// (Components register themselves, but must be updated again if their geospatial metadata changes after registration)
+	void AddComponent(UGISDataComponent* Component);
+	
+	// Removes a GIS data component from the index
+	void RemoveComponent(UGISDataComponent* Component);
+	
+	// Returns the GIS data component whose footprint contains the specified GPS coordinate, or null if there is none
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen")
+	UGISDataComponent* FindComponentForGPSLocation(FVector2D GPSCoordinate);
+	
+	// Converts a GPS coordinate to a world space location using the landscape that contains it, returning false if no landscape does
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen")
+	bool GetWorldSpaceLocation(FVector2D GPSCoordinate, FVector& WorldSpaceLocation);
+	
+	// Returns all of the GIS data components in the index
+	UFUNCTION(BlueprintPure, Category = "LandscapeGen")
+	TArray<UGISDataComponent*> GetAllComponents() const;
+
+private:
+	
+	// The indexed data for an individual component
+	struct FFootprint
+	{
+		// The bounds of the footprint in GPS coordinates
+		FBox2D Bounds;
+		
+		// The grid cells covered by the bounds (or an empty range for footprints that are stored in the oversized list)
+		FIntPoint MinCell;
+		FIntPoint MaxCell;
+	};
+	
+	// Computes the grid cell containing the specified GPS coordinate
+	static FIntPoint GetCell(const FVector2D& GPSCoordinate);
+	
+	// Determines whether the specified GPS coordinate lies within the projected extents of a component
+	bool ContainsLocation(UGISDataComponent* Component, const FVector2D& GPSCoordinate);
+	
+	// The footprints of the indexed components
+	TMap<TWeakObjectPtr<UGISDataComponent>, FFootprint> Footprints;
+	
+	// The grid cells of the index, each of which lists the components whose footprints overlap the cell
+	TMap<FIntPoint, TArray<TWeakObjectPtr<UGISDataComponent>>> Cells;
+	
+	// Components whose footprints cover too many cells to insert into the grid, which are tested for every query
+	TArray<TWeakObjectPtr<UGISDataComponent>> Oversized;
+};
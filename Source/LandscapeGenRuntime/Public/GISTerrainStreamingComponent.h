@@ -0,0 +1,181 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "GISTerrainStreamingComponent.generated.h"
+
+class UMaterialInterface;
+class UProceduralMeshComponent;
+struct FTerrainStreamingState;
+
+// The encodings used to store height values in the RGB channels of height tiles
+UENUM(BlueprintType)
+enum class ETerrainHeightEncoding : uint8
+{
+	// Mapbox Terrain-RGB encoding
+	TerrainRGB  UMETA(DisplayName = "Terrain-RGB"),
+	
+	// Mapzen/Tilezen Terrarium encoding
+	Terrarium   UMETA(DisplayName = "Terrarium"),
+};
+
+// A single streamed terrain chunk, which covers the area of one height tile
+USTRUCT()
+struct FTerrainChunk
+{
+	GENERATED_BODY()
+	
+	// The mesh component holding the chunk's geometry (null until the first build of the chunk has been uploaded)
+	UPROPERTY(Transient)
+	UProceduralMeshComponent* Mesh = nullptr;
+	
+	// The level of detail of the uploaded geometry and of the build that is in flight (-1 if there is none)
+	int32 LOD = -1;
+	int32 PendingLOD = -1;
+};
+
+// Streams terrain meshes built from slippy map (z/x/y) height tiles around a moving viewpoint at runtime, without requiring
+// landscapes to be generated in the Editor. Each height tile becomes one chunk, and the level of detail of each chunk is
+// selected by its distance from the viewpoint. Tiles are read and decoded and chunk meshes are built on worker threads, and
+// only a limited number of completed chunks are uploaded each tick so that terrain streams in without hitches.
+//
+// The terrain is placed in a local tangent plane centred on the origin coordinate, with X pointing east and Y pointing south.
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class LANDSCAPEGENRUNTIME_API UGISTerrainStreamingComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	
+	UGISTerrainStreamingComponent();
+	
+	// The tile source for the height tiles, which is either a URL template such as "https://tiles.example.com/terrain/{z}/{x}/{y}.png"
+	// or a local directory tree template such as "file://D:/Tiles/terrain/{z}/{x}/{y}.png" ({-y} selects TMS row numbering)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming")
+	FString HeightTileSource;
+	
+	// The encoding used by the height tiles
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming")
+	ETerrainHeightEncoding HeightEncoding = ETerrainHeightEncoding::TerrainRGB;
+	
+	// The zoom level of the height tiles
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming", meta = (ClampMin = "0", ClampMax = "22"))
+	int32 Zoom = 12;
+	
+	// The width and height of each height tile in pixels
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming", meta = (ClampMin = "2"))
+	int32 TileSize = 256;
+	
+	// The WGS84 latitude of the coordinate that is placed at the component's origin
+	// (Stored in double precision since single precision resolves only around a metre at large longitudes, and Blueprints
+	// cannot access double properties, so they set the origin via SetOrigin() instead)
+	UPROPERTY(EditAnywhere, Category = "Terrain Streaming")
+	double OriginLatitude = 0.0;
+	
+	// The WGS84 longitude of the coordinate that is placed at the component's origin
+	UPROPERTY(EditAnywhere, Category = "Terrain Streaming")
+	double OriginLongitude = 0.0;
+	
+	// The scale factor applied to height values
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming")
+	float HeightScale = 1.0f;
+	
+	// The radius (in tiles) around the viewpoint within which chunks are streamed in
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming", meta = (ClampMin = "0"))
+	int32 ViewRadiusTiles = 3;
+	
+	// The number of levels of detail, each of which halves the mesh resolution of the previous level
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 NumLODs = 4;
+	
+	// The distance (in tiles) from the viewpoint covered by each level of detail
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming", meta = (ClampMin = "0.1"))
+	float LODDistanceTiles = 1.0f;
+	
+	// The depth (in metres) of the skirts around each chunk, which hide the cracks between chunks with differing levels of detail
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming")
+	float SkirtDepth = 50.0f;
+	
+	// The maximum number of decoded height tiles held in the cache
+	// (Chunks are only built once the tiles surrounding them are cached, so this should exceed the number of tiles within one tile of the view radius)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming|Budgets", meta = (ClampMin = "1"))
+	int32 MaxCachedTiles = 128;
+	
+	// The maximum number of height tiles that may be loading at once
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming|Budgets", meta = (ClampMin = "1"))
+	int32 MaxConcurrentTileLoads = 8;
+	
+	// The maximum number of chunk meshes that may be building on worker threads at once
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming|Budgets", meta = (ClampMin = "1"))
+	int32 MaxConcurrentBuilds = 4;
+	
+	// The maximum number of completed chunk meshes that are uploaded each tick
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming|Budgets", meta = (ClampMin = "1"))
+	int32 MaxUploadsPerTick = 2;
+	
+	// Specifies whether collision is created for chunks (collision is cooked asynchronously)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming")
+	bool bCreateCollision = true;
+	
+	// The material applied to all chunks
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming")
+	UMaterialInterface* Material = nullptr;
+	
+	// The actor whose location is used as the viewpoint (if none is specified then the first player's camera is used)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain Streaming")
+	AActor* ViewpointActor = nullptr;
+	
+	// Returns the number of chunks whose geometry has been uploaded
+	UFUNCTION(BlueprintPure, Category = "LandscapeGen|Streaming")
+	int32 GetNumLoadedChunks() const;
+	
+	// Discards all chunks and cached tiles so that the terrain is streamed in again using the current property values
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Streaming")
+	void RebuildTerrain();
+	
+	// Sets the WGS84 coordinate that is placed at the component's origin and rebuilds the terrain around it
+	UFUNCTION(BlueprintCallable, Category = "LandscapeGen|Streaming")
+	void SetOrigin(float Latitude, float Longitude);
+	
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+	
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	
+	// The streamed chunks, keyed by tile index
+	UPROPERTY(Transient)
+	TMap<FIntPoint, FTerrainChunk> Chunks;
+	
+	// Mesh components released by chunks that have streamed out, which are reused for chunks that stream in
+	UPROPERTY(Transient)
+	TArray<UProceduralMeshComponent*> FreeMeshes;
+	
+	// The tile cache and the queues shared with the worker threads that load tiles and build chunk meshes
+	TSharedPtr<FTerrainStreamingState, ESPMode::ThreadSafe> State;
+	
+	void StartStreaming();
+	void StopStreaming();
+	
+	// Computes the Web Mercator coordinates of the origin and the scale from Web Mercator metres to Unreal units at the origin
+	void GetOriginMercator(double& OutX, double& OutY, double& OutScale) const;
+	
+	// Computes the fractional tile index of the viewpoint
+	void GetViewpointTile(double& OutTileX, double& OutTileY) const;
+	
+	// Computes the location of the upper-left corner of a tile relative to the component
+	FVector GetTileOrigin(const FIntPoint& Tile) const;
+	
+	// Computes the width of a tile in Unreal units
+	float GetTileWorldSize() const;
+	
+	void ProcessLoadedTiles();
+	void UpdateChunks();
+	void UploadBuiltChunks();
+	void RequestTile(const FIntPoint& Tile);
+	void BuildChunk(const FIntPoint& Tile, int32 LOD);
+	void ReleaseChunk(FTerrainChunk& Chunk);
+};
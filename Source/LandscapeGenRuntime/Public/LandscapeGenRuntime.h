@@ -3,9 +3,13 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
-class FLandscapeGenRuntimeModule : public IModuleInterface
+class LANDSCAPEGENRUNTIME_API FLandscapeGenRuntimeModule : public IModuleInterface
 {
 public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
-};
+	
+	// Initialises GDAL the first time it is called, so that sessions which never touch GIS data (or which only use the built-in
+	// projections) never initialise it (this is safe to call from any thread)
+	static void EnsureGDALInitialized();
+};
\ No newline at end of file
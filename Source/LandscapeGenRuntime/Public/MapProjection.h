@@ -0,0 +1,480 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MapProjection.generated.h"
+
+// Implementation details of FMapProjection
+namespace MapProjectionInternal
+{
+	// The parameters of the WGS84 ellipsoid
+	const double SemiMajorAxis = 6378137.0;
+	const double Flattening = 1.0 / 298.257223563;
+	
+	// The coefficients of the Krüger series for the transverse Mercator projection, which are accurate to within a few nanometres
+	// (See: Karney, C.F.F. 2011, "Transverse Mercator with an accuracy of a few nanometers", Journal of Geodesy 85(8), 475-485)
+	struct FKrugerSeries
+	{
+		double Eccentricity;
+		double RectifyingRadius;
+		double Alpha[6];
+		double Beta[6];
+		
+		FKrugerSeries()
+		{
+			double n = Flattening / (2.0 - Flattening);
+			double n2 = n * n;
+			double n3 = n2 * n;
+			double n4 = n3 * n;
+			double n5 = n4 * n;
+			double n6 = n5 * n;
+			
+			this->Eccentricity = sqrt(Flattening * (2.0 - Flattening));
+			this->RectifyingRadius = SemiMajorAxis / (1.0 + n) * (1.0 + n2 / 4.0 + n4 / 64.0 + n6 / 256.0);
+			
+			this->Alpha[0] = n / 2.0 - 2.0 * n2 / 3.0 + 5.0 * n3 / 16.0 + 41.0 * n4 / 180.0 - 127.0 * n5 / 288.0 + 7891.0 * n6 / 37800.0;
+			this->Alpha[1] = 13.0 * n2 / 48.0 - 3.0 * n3 / 5.0 + 557.0 * n4 / 1440.0 + 281.0 * n5 / 630.0 - 1983433.0 * n6 / 1935360.0;
+			this->Alpha[2] = 61.0 * n3 / 240.0 - 103.0 * n4 / 140.0 + 15061.0 * n5 / 26880.0 + 167603.0 * n6 / 181440.0;
+			this->Alpha[3] = 49561.0 * n4 / 161280.0 - 179.0 * n5 / 168.0 + 6601661.0 * n6 / 7257600.0;
+			this->Alpha[4] = 34729.0 * n5 / 80640.0 - 3418889.0 * n6 / 1995840.0;
+			this->Alpha[5] = 212378941.0 * n6 / 319334400.0;
+			
+			this->Beta[0] = n / 2.0 - 2.0 * n2 / 3.0 + 37.0 * n3 / 96.0 - n4 / 360.0 - 81.0 * n5 / 512.0 + 96199.0 * n6 / 604800.0;
+			this->Beta[1] = n2 / 48.0 + n3 / 15.0 - 437.0 * n4 / 1440.0 + 46.0 * n5 / 105.0 - 1118711.0 * n6 / 3870720.0;
+			this->Beta[2] = 17.0 * n3 / 480.0 - 37.0 * n4 / 840.0 - 209.0 * n5 / 4480.0 + 5569.0 * n6 / 90720.0;
+			this->Beta[3] = 4397.0 * n4 / 161280.0 - 11.0 * n5 / 504.0 - 830251.0 * n6 / 7257600.0;
+			this->Beta[4] = 4583.0 * n5 / 161280.0 - 108847.0 * n6 / 3991680.0;
+			this->Beta[5] = 20648693.0 * n6 / 638668800.0;
+		}
+		
+		static const FKrugerSeries& Get()
+		{
+			static const FKrugerSeries Series;
+			return Series;
+		}
+	};
+	
+	// Computes the tangent of the conformal latitude from the tangent of the geodetic latitude
+	inline double ConformalTangent(double Tau, double Eccentricity)
+	{
+		double Sigma = sinh(Eccentricity * atanh(Eccentricity * Tau / sqrt(1.0 + Tau * Tau)));
+		return Tau * sqrt(1.0 + Sigma * Sigma) - Sigma * sqrt(1.0 + Tau * Tau);
+	}
+	
+	// Projects a geodetic latitude and a longitude relative to the central meridian (in radians) onto an unscaled transverse Mercator
+	// projection with its origin at the equator
+	inline void ProjectTransverseMercator(double Lat, double Lon, double& OutEasting, double& OutNorthing)
+	{
+		const FKrugerSeries& Series = FKrugerSeries::Get();
+		double TauPrime = ConformalTangent(tan(Lat), Series.Eccentricity);
+		double XiPrime = atan2(TauPrime, cos(Lon));
+		double EtaPrime = asinh(sin(Lon) / sqrt(TauPrime * TauPrime + cos(Lon) * cos(Lon)));
+		
+		double Xi = XiPrime;
+		double Eta = EtaPrime;
+		for (int32 Index = 0; Index < 6; ++Index)
+		{
+			double Order = 2.0 * (Index + 1);
+			Xi += Series.Alpha[Index] * sin(Order * XiPrime) * cosh(Order * EtaPrime);
+			Eta += Series.Alpha[Index] * cos(Order * XiPrime) * sinh(Order * EtaPrime);
+		}
+		
+		OutEasting = Series.RectifyingRadius * Eta;
+		OutNorthing = Series.RectifyingRadius * Xi;
+	}
+	
+	// Inverts ProjectTransverseMercator()
+	inline void UnprojectTransverseMercator(double Easting, double Northing, double& OutLat, double& OutLon)
+	{
+		const FKrugerSeries& Series = FKrugerSeries::Get();
+		double Xi = Northing / Series.RectifyingRadius;
+		double Eta = Easting / Series.RectifyingRadius;
+		
+		double XiPrime = Xi;
+		double EtaPrime = Eta;
+		for (int32 Index = 0; Index < 6; ++Index)
+		{
+			double Order = 2.0 * (Index + 1);
+			XiPrime -= Series.Beta[Index] * sin(Order * Xi) * cosh(Order * Eta);
+			EtaPrime -= Series.Beta[Index] * cos(Order * Xi) * sinh(Order * Eta);
+		}
+		
+		double SinhEtaPrime = sinh(EtaPrime);
+		double CosXiPrime = cos(XiPrime);
+		double TauPrime = sin(XiPrime) / sqrt(SinhEtaPrime * SinhEtaPrime + CosXiPrime * CosXiPrime);
+		
+		// Recover the geodetic latitude from the conformal latitude using Newton's method, which converges within a few iterations
+		double EccentricitySquared = Series.Eccentricity * Series.Eccentricity;
+		double Tau = TauPrime;
+		for (int32 Iteration = 0; Iteration < 8; ++Iteration)
+		{
+			double TauIPrime = ConformalTangent(Tau, Series.Eccentricity);
+			double Delta = (TauPrime - TauIPrime) / sqrt(1.0 + TauIPrime * TauIPrime) *
+				(1.0 + (1.0 - EccentricitySquared) * Tau * Tau) / ((1.0 - EccentricitySquared) * sqrt(1.0 + Tau * Tau));
+			Tau += Delta;
+			if (FMath::Abs(Delta) < 1e-12) {
+				break;
+			}
+		}
+		
+		OutLat = atan(Tau);
+		OutLon = atan2(SinhEtaPrime, CosXiPrime);
+	}
+	
+	// A node of a WKT string, along with its (unquoted) values and its child nodes
+	struct FWKTNode
+	{
+		FString Keyword;
+		TArray<FString> Values;
+		TArray<FWKTNode> Children;
+		
+		const FWKTNode* Find(const TCHAR* ChildKeyword) const {
+			return this->Children.FindByPredicate([ChildKeyword](const FWKTNode& Child) { return Child.Keyword == ChildKeyword; });
+		}
+	};
+	
+	// Reads an unquoted value or keyword from a WKT string
+	inline FString ReadWKTToken(const FString& WKT, int32& Position)
+	{
+		int32 Start = Position;
+		while (Position < WKT.Len() && FCString::Strchr(TEXT(",[]() \t\r\n"), WKT[Position]) == nullptr) {
+			++Position;
+		}
+		
+		return WKT.Mid(Start, Position - Start);
+	}
+	
+	inline void SkipWKTWhitespace(const FString& WKT, int32& Position)
+	{
+		while (Position < WKT.Len() && FChar::IsWhitespace(WKT[Position])) {
+			++Position;
+		}
+	}
+	
+	// Parses the WKT node that begins at the specified position, advancing the position past the end of the node
+	inline bool ParseWKTNode(const FString& WKT, int32& Position, FWKTNode& OutNode)
+	{
+		SkipWKTWhitespace(WKT, Position);
+		OutNode.Keyword = ReadWKTToken(WKT, Position).ToUpper();
+		SkipWKTWhitespace(WKT, Position);
+		if (OutNode.Keyword.IsEmpty() || Position >= WKT.Len() || (WKT[Position] != TEXT('[') && WKT[Position] != TEXT('('))) {
+			return false;
+		}
+		
+		++Position;
+		while (true)
+		{
+			SkipWKTWhitespace(WKT, Position);
+			if (Position >= WKT.Len()) {
+				return false;
+			}
+			
+			if (WKT[Position] == TEXT('"'))
+			{
+				// Quoted strings escape quotes by doubling them
+				FString Value;
+				for (++Position; Position < WKT.Len(); ++Position)
+				{
+					if (WKT[Position] == TEXT('"'))
+					{
+						if (Position + 1 >= WKT.Len() || WKT[Position + 1] != TEXT('"')) {
+							break;
+						}
+						
+						++Position;
+					}
+					
+					Value.AppendChar(WKT[Position]);
+				}
+				
+				++Position;
+				OutNode.Values.Add(Value);
+			}
+			else
+			{
+				// Unquoted values are either numbers, enumerated values or the keywords of child nodes
+				int32 Start = Position;
+				FString Token = ReadWKTToken(WKT, Position);
+				SkipWKTWhitespace(WKT, Position);
+				if (Token.IsEmpty()) {
+					return false;
+				}
+				
+				if (Position < WKT.Len() && (WKT[Position] == TEXT('[') || WKT[Position] == TEXT('(')))
+				{
+					Position = Start;
+					if (ParseWKTNode(WKT, Position, OutNode.Children.AddDefaulted_GetRef()) == false) {
+						return false;
+					}
+				}
+				else {
+					OutNode.Values.Add(Token);
+				}
+			}
+			
+			SkipWKTWhitespace(WKT, Position);
+			if (Position < WKT.Len() && WKT[Position] == TEXT(',')) {
+				++Position;
+			}
+			else if (Position < WKT.Len() && (WKT[Position] == TEXT(']') || WKT[Position] == TEXT(')')))
+			{
+				++Position;
+				return true;
+			}
+			else {
+				return false;
+			}
+		}
+	}
+}
+
+// The methods that can be used to convert between WGS84 coordinates and a projected coordinate system
+UENUM()
+enum class EMapProjectionMethod : uint8
+{
+	// The method has not been selected yet (e.g. for components saved before the method was selected at generation time)
+	Unresolved,
+	
+	// The projected coordinate system is not supported by the built-in implementations, so GDAL must perform conversions
+	GDAL,
+	
+	// Web Mercator (EPSG:3857), as used by slippy map tiles
+	WebMercator,
+	
+	// Transverse Mercator on the WGS84 ellipsoid, which includes the UTM zones (EPSG:32601-32660 and EPSG:32701-32760)
+	TransverseMercator
+};
+
+// A header-only double-precision implementation of common projected coordinate systems, which converts coordinates without initialising
+// GDAL or PROJ (the method is selected once from the WKT of the coordinate system, and unsupported coordinate systems select GDAL)
+//
+// Geographic coordinates use the same (latitude, longitude) convention as UGISDataComponent.
+USTRUCT()
+struct FMapProjection
+{
+	GENERATED_BODY()
+	
+	UPROPERTY()
+	EMapProjectionMethod Method = EMapProjectionMethod::Unresolved;
+	
+	// The parameters of the transverse Mercator projection (in degrees and metres)
+	UPROPERTY()
+	double LatitudeOfOrigin = 0.0;
+	
+	UPROPERTY()
+	double CentralMeridian = 0.0;
+	
+	UPROPERTY()
+	double ScaleFactor = 1.0;
+	
+	UPROPERTY()
+	double FalseEasting = 0.0;
+	
+	UPROPERTY()
+	double FalseNorthing = 0.0;
+	
+	// Returns true if conversions can be performed without GDAL
+	bool IsBuiltIn() const {
+		return this->Method == EMapProjectionMethod::WebMercator || this->Method == EMapProjectionMethod::TransverseMercator;
+	}
+	
+	static FMapProjection WebMercator()
+	{
+		FMapProjection Projection;
+		Projection.Method = EMapProjectionMethod::WebMercator;
+		return Projection;
+	}
+	
+	static FMapProjection UTM(int32 Zone, bool bNorth)
+	{
+		FMapProjection Projection;
+		Projection.Method = EMapProjectionMethod::TransverseMercator;
+		Projection.CentralMeridian = Zone * 6.0 - 183.0;
+		Projection.ScaleFactor = 0.9996;
+		Projection.FalseEasting = 500000.0;
+		Projection.FalseNorthing = bNorth ? 0.0 : 10000000.0;
+		return Projection;
+	}
+	
+	// Selects the method for the specified WKT, selecting GDAL if the coordinate system is not supported
+	// (Coordinate systems are identified by their EPSG code where one is present, or else by the parameters of a WKT1 projection)
+	static FMapProjection FromWKT(const FString& WKT)
+	{
+		using namespace MapProjectionInternal;
+		
+		FMapProjection Fallback;
+		Fallback.Method = EMapProjectionMethod::GDAL;
+		
+		FWKTNode Root;
+		int32 Position = 0;
+		if (ParseWKTNode(WKT, Position, Root) == false ||
+			(Root.Keyword != TEXT("PROJCS") && Root.Keyword != TEXT("PROJCRS") && Root.Keyword != TEXT("PROJECTEDCRS"))) {
+			return Fallback;
+		}
+		
+		// Identify the coordinate system by its EPSG code if it has one (WKT1 uses AUTHORITY nodes and WKT2 uses ID nodes)
+		const FWKTNode* Authority = Root.Find(TEXT("AUTHORITY"));
+		if (Authority == nullptr) {
+			Authority = Root.Find(TEXT("ID"));
+		}
+		
+		if (Authority != nullptr && Authority->Values.Num() >= 2 && Authority->Values[0] == TEXT("EPSG"))
+		{
+			int32 Code = FCString::Atoi(*Authority->Values[1]);
+			if (Code == 3857 || Code == 3785 || Code == 900913) {
+				return WebMercator();
+			}
+			
+			if (Code >= 32601 && Code <= 32660) {
+				return UTM(Code - 32600, true);
+			}
+			
+			if (Code >= 32701 && Code <= 32760) {
+				return UTM(Code - 32700, false);
+			}
+			
+			return Fallback;
+		}
+		
+		// Otherwise, accept WKT1 transverse Mercator projections on the WGS84 datum whose linear unit is the metre
+		const FWKTNode* Projection = Root.Find(TEXT("PROJECTION"));
+		const FWKTNode* GeographicCS = Root.Find(TEXT("GEOGCS"));
+		const FWKTNode* Datum = (GeographicCS != nullptr) ? GeographicCS->Find(TEXT("DATUM")) : nullptr;
+		const FWKTNode* Unit = Root.Find(TEXT("UNIT"));
+		if (Projection == nullptr || Projection->Values.Num() == 0 || Projection->Values[0] != TEXT("Transverse_Mercator") ||
+			Datum == nullptr || Datum->Values.Num() == 0 || Datum->Values[0] != TEXT("WGS_1984") ||
+			Unit == nullptr || Unit->Values.Num() < 2 || FCString::Atod(*Unit->Values[1]) != 1.0) {
+			return Fallback;
+		}
+		
+		FMapProjection Result;
+		Result.Method = EMapProjectionMethod::TransverseMercator;
+		for (const FWKTNode& Child : Root.Children)
+		{
+			if (Child.Keyword != TEXT("PARAMETER") || Child.Values.Num() < 2) {
+				continue;
+			}
+			
+			FString Name = Child.Values[0].ToLower();
+			double Value = FCString::Atod(*Child.Values[1]);
+			if (Name == TEXT("latitude_of_origin")) {
+				Result.LatitudeOfOrigin = Value;
+			}
+			else if (Name == TEXT("central_meridian")) {
+				Result.CentralMeridian = Value;
+			}
+			else if (Name == TEXT("scale_factor")) {
+				Result.ScaleFactor = Value;
+			}
+			else if (Name == TEXT("false_easting")) {
+				Result.FalseEasting = Value;
+			}
+			else if (Name == TEXT("false_northing")) {
+				Result.FalseNorthing = Value;
+			}
+			else {
+				return Fallback;
+			}
+		}
+		
+		return Result;
+	}
+	
+	// Converts WGS84 coordinates (in degrees) to projected coordinates (returns false if the method is not built-in)
+	// (Projected coordinates are too large to represent precisely as floats, so callers that need metre accuracy should use these
+	// double precision overloads rather than the FVector2D overloads below)
+	bool GeographicToProjected(double Latitude, double Longitude, double& OutX, double& OutY) const
+	{
+		using namespace MapProjectionInternal;
+		
+		double Lat = FMath::DegreesToRadians(Latitude);
+		double Lon = FMath::DegreesToRadians(Longitude);
+		if (this->Method == EMapProjectionMethod::WebMercator)
+		{
+			OutX = SemiMajorAxis * Lon;
+			OutY = SemiMajorAxis * log(tan(PI / 4.0 + Lat / 2.0));
+			return true;
+		}
+		
+		if (this->Method == EMapProjectionMethod::TransverseMercator)
+		{
+			double Easting;
+			double Northing;
+			ProjectTransverseMercator(Lat, Lon - FMath::DegreesToRadians(this->CentralMeridian), Easting, Northing);
+			OutX = this->ScaleFactor * Easting + this->FalseEasting;
+			OutY = this->ScaleFactor * (Northing - this->GetOriginNorthing()) + this->FalseNorthing;
+			return true;
+		}
+		
+		return false;
+	}
+	
+	// Converts projected coordinates to WGS84 coordinates (in degrees), returning false if the method is not built-in
+	bool ProjectedToGeographic(double X, double Y, double& OutLatitude, double& OutLongitude) const
+	{
+		using namespace MapProjectionInternal;
+		
+		if (this->Method == EMapProjectionMethod::WebMercator)
+		{
+			OutLatitude = FMath::RadiansToDegrees(2.0 * atan(exp(Y / SemiMajorAxis)) - PI / 2.0);
+			OutLongitude = FMath::RadiansToDegrees(X / SemiMajorAxis);
+			return true;
+		}
+		
+		if (this->Method == EMapProjectionMethod::TransverseMercator)
+		{
+			double Lat;
+			double Lon;
+			UnprojectTransverseMercator(
+				(X - this->FalseEasting) / this->ScaleFactor,
+				(Y - this->FalseNorthing) / this->ScaleFactor + this->GetOriginNorthing(),
+				Lat,
+				Lon
+			);
+			
+			OutLatitude = FMath::RadiansToDegrees(Lat);
+			OutLongitude = FMath::RadiansToDegrees(Lon) + this->CentralMeridian;
+			return true;
+		}
+		
+		return false;
+	}
+	
+	// Converts between WGS84 coordinates in (lat,lon) format and projected coordinates as above, with single precision inputs and outputs
+	bool GeographicToProjected(const FVector2D& GPSCoordinate, FVector2D& OutProjected) const
+	{
+		double X;
+		double Y;
+		if (this->GeographicToProjected(GPSCoordinate.X, GPSCoordinate.Y, X, Y) == false) {
+			return false;
+		}
+		
+		OutProjected = FVector2D(X, Y);
+		return true;
+	}
+	
+	bool ProjectedToGeographic(const FVector2D& Projected, FVector2D& OutGPSCoordinate) const
+	{
+		double Latitude;
+		double Longitude;
+		if (this->ProjectedToGeographic(Projected.X, Projected.Y, Latitude, Longitude) == false) {
+			return false;
+		}
+		
+		OutGPSCoordinate = FVector2D(Latitude, Longitude);
+		return true;
+	}
+
+private:
+	
+	// Computes the unscaled northing of the latitude of origin, which is zero for the UTM zones
+	double GetOriginNorthing() const
+	{
+		double Easting = 0.0;
+		double Northing = 0.0;
+		if (this->LatitudeOfOrigin != 0.0) {
+			MapProjectionInternal::ProjectTransverseMercator(FMath::DegreesToRadians(this->LatitudeOfOrigin), 0.0, Easting, Northing);
+		}
+		
+		return Northing;
+	}
+};
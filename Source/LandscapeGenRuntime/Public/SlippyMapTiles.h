@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Tile math and decoding helpers shared by the data sources and runtime components that use slippy map (z/x/y) tiles
+// (See: https://wiki.openstreetmap.org/wiki/Slippy_map_tilenames)
+namespace SlippyMapTiles
+{
+	// The height value used to mark the samples of height tiles that could not be retrieved
+	const float MissingTileHeight = -32768.0f;
+	
+	inline float long2tilexf(double lon, int z)
+	{
+		return (lon + 180.0) / 360.0 * (1 << z);
+	}
+	
+	inline float lat2tileyf(double lat, int z)
+	{
+		double latrad = lat * PI/180.0;
+		return (1.0 - asinh(tan(latrad)) / PI) / 2.0 * (1 << z);
+	}
+	
+	inline int long2tilex(double lon, int z)
+	{
+		return (int)(floor(long2tilexf(lon, z)));
+	}
+	
+	inline int lat2tiley(double lat, int z)
+	{
+		return (int)(floor(lat2tileyf(lat, z)));
+	}
+	
+	inline double tilex2long(int x, int z)
+	{
+		return x / (double)(1 << z) * 360.0 - 180;
+	}
+	
+	inline double tiley2lat(int y, int z)
+	{
+		double n = PI - 2.0 * PI * y / (double)(1 << z);
+		return 180.0 / PI * atan(0.5 * (exp(n) - exp(-n)));
+	}
+	
+	// Converts an XYZ tile row index to the flipped row index used by the TMS scheme (and by MBTiles archives)
+	inline int tiley2tms(int y, int z)
+	{
+		return (1 << z) - 1 - y;
+	}
+	
+	// Substitutes the tile indices into a tile source template, where {-y} selects the flipped TMS row index
+	inline FString ExpandTileTemplate(const FString& Template, int32 Z, int32 X, int32 Y)
+	{
+		return Template
+			.Replace(TEXT("{z}"), *FString::FromInt(Z))
+			.Replace(TEXT("{x}"), *FString::FromInt(X))
+			.Replace(TEXT("{-y}"), *FString::FromInt(tiley2tms(Y, Z)))
+			.Replace(TEXT("{y}"), *FString::FromInt(Y));
+	}
+	
+	// Validates the bounds and zoom level of a tile request, returning false and populating the error string if they are invalid
+	inline bool ValidateRequestBounds(float upperLat, float leftLon, float lowerLat, float rightLon, int zoom, int maxZoom, FString& OutError)
+	{
+		const int minZoom = 0;
+		
+		const float minLat = -85.0511f;
+		const float maxLat = 85.0511f;
+		const float minLon = -180.0f;
+		const float maxLon = 180.0f;
+		
+		if (zoom < minZoom || zoom > maxZoom)
+		{
+			OutError = FString::Printf(TEXT("Zoom out of valid Range (%d-%d)"), minZoom, maxZoom);
+			return false;
+		}
+		
+		if (upperLat < lowerLat)
+		{
+			OutError = FString(TEXT("Upper Latitude value is lower than Lower Latitude value"));
+			return false;
+		}
+		
+		if (rightLon < leftLon)
+		{
+			OutError = FString(TEXT("Right Longitude value is lower than Left Longitude value"));
+			return false;
+		}
+		
+		if (upperLat > maxLat || lowerLat < minLat)
+		{
+			OutError = FString::Printf(TEXT("Upper or Lower Latitude value out of range (%f-%f)"), minLat, maxLat);
+			return false;
+		}
+		
+		if (rightLon > maxLon || leftLon < minLon)
+		{
+			OutError = FString::Printf(TEXT("Left or Right Longitude value out of range (%f-%f)"), minLon, maxLon);
+			return false;
+		}
+		
+		return true;
+	}
+	
+	// Decodes a height value (in metres) from a Mapbox Terrain-RGB pixel
+	// (See: https://docs.mapbox.com/data/tilesets/reference/mapbox-terrain-rgb-v1/)
+	FORCEINLINE float DecodeTerrainRGB(const FColor& pixel)
+	{
+		return -10000.0f + ((pixel.R * 256 * 256 + pixel.G * 256 + pixel.B) * 0.1f);
+	}
+	
+	// Decodes a height value (in metres) from a Terrarium-encoded pixel
+	// (See: https://github.com/tilezen/joerd/blob/master/docs/formats.md#terrarium)
+	FORCEINLINE float DecodeTerrarium(const FColor& pixel)
+	{
+		return (pixel.R * 256.0f + pixel.G + pixel.B / 256.0f) - 32768.0f;
+	}
+}
@@ -1,49 +1,67 @@
 #include "MapboxDataSource.h"
+#include "Async/ParallelFor.h"
 #include "Modules/ModuleManager.h"
 #include "IImageWrapper.h"
 #include "IImageWrapperModule.h"
-#include "Interfaces/IHttpResponse.h"
-#include "HttpModule.h"
 #include "ImageUtils.h"
-#include "GDALHelpers.h"
+#include "CoordinateSystemRegistry.h"
+#include "GenerationCostCalibration.h"
 #include "LandscapeConstraints.h"
+#include "SlippyMapTiles.h"
+
+using namespace SlippyMapTiles;
 
 namespace
 {
-	float long2tilexf(double lon, int z)
-	{
-		return (lon + 180.0) / 360.0 * (1 << z);
-	}
-	
-	float lat2tileyf(double lat, int z)
-	{
-		double latrad = lat * PI/180.0;
-		return (1.0 - asinh(tan(latrad)) / PI) / 2.0 * (1 << z);
-	}
-	
-	int long2tilex(double lon, int z)
-	{
-		return (int)(floor(long2tilexf(lon, z)));
-	}
-	
-	int lat2tiley(double lat, int z)
-	{
-		return (int)(floor(lat2tileyf(lat, z)));
-	}
-	
-	double tilex2long(int x, int z)
-	{
-		return x / (double)(1 << z) * 360.0 - 180;
-	}
+	// The width and height of each Mapbox tile in pixels
+	const int MapboxTileSize = 256;
 	
-	double tiley2lat(int y, int z)
+	// Computes the range of tile indices covering the specified coordinates at the specified zoom level
+	void ComputeTileBounds(float upperLat, float leftLon, float lowerLat, float rightLon, int zoom, int& minx, int& miny, int& maxx, int& maxy)
 	{
-		double n = PI - 2.0 * PI * y / (double)(1 << z);
-		return 180.0 / PI * atan(0.5 * (exp(n) - exp(-n)));
+		// Find tile indice bounds for given coordinates and zoom
+		float minxf = long2tilexf(leftLon, zoom);
+		float minyf = lat2tileyf(upperLat, zoom);
+		
+		float maxxf = long2tilexf(rightLon, zoom);
+		float maxyf = lat2tileyf(lowerLat, zoom);
+		
+		////////// Make requests produce square results for now /////////////
+		
+		minxf = (int)(floor(minxf));
+		minyf = (int)(floor(minyf));
+		
+		maxxf = (int)(floor(maxxf));
+		maxyf = (int)(floor(maxyf));
+		
+		// Expand either x or y dimension to produce square result
+		bool isXLarger = (maxxf - minxf) >= (maxyf - minyf);
+		float largerSize = isXLarger ? (maxxf - minxf) : (maxyf - minyf);
+		float& smallerMin = isXLarger ? minyf : minxf;
+		float& smallerMax = isXLarger ? maxyf : maxxf;
+		
+		while (largerSize > (smallerMax - smallerMin))
+		{
+			if (((int)(smallerMax - smallerMin)) % 2) {
+				smallerMin--;
+			} else {
+				smallerMax++;
+			}
+		}
+		
+		////////// Make requests produce square results for now /////////////
+		
+		minx = (int)(floor(minxf));
+		miny = (int)(floor(minyf));
+		
+		maxx = (int)(floor(maxxf));
+		maxy = (int)(floor(maxyf));
 	}
 }
 
-const FString UMapboxDataSource::ProjectionWKT = GDALHelpers::WktFromEPSG(3857);
+FString UMapboxDataSource::GetProjectionWKT() {
+	return CoordinateSystemRegistry::GetWKT(3857);
+}
 
 void UMapboxDataSource::RetrieveData(FGISDataSourceDelegate InOnSuccess, FGISDataSourceDelegate InOnFailure)
 {
@@ -52,52 +70,107 @@ void UMapboxDataSource::RetrieveData(FGISDataSourceDelegate InOnSuccess, FGISDat
 	this->RequestSectionRGBHeight(this->reqUpperLat, this->reqLeftLon, this->reqLowerLat, this->reqRightLon, this->reqZoom);
 }
 
-bool UMapboxDataSource::ValidateRequest(FString& OutError)
+bool UMapboxDataSource::ValidateRequest(FString& OutError) const
 {
-	const int minZoom = 0;
 	const int maxZoom = 15;
-	
-	const float minLat = -85.0511f;
-	const float maxLat = 85.0511f;
-	const float minLon = -180.0f;
-	const float maxLon = 180.0f;
-	
-	if (this->reqZoom < minZoom || this->reqZoom > maxZoom)
-	{
-		OutError = FString::Printf(TEXT("Zoom out of valid Range (%d-%d)"), minZoom, maxZoom);
-		return false;
-	}
-	
-	if (this->reqUpperLat < this->reqLowerLat)
-	{
-		OutError = FString(TEXT("Upper Latitude value is lower than Lower Latitude value"));
-		return false;
+	return ValidateRequestBounds(this->reqUpperLat, this->reqLeftLon, this->reqLowerLat, this->reqRightLon, this->reqZoom, maxZoom, OutError);
+}
+
+void UMapboxDataSource::CancelRetrieval()
+{
+	this->CancelPendingRequests();
+	this->ReleaseBuffers();
+}
+
+float UMapboxDataSource::GetRetrievalProgress() const
+{
+	return (this->TotalRequests > 0) ? ((float)this->CompletedRequests / (float)this->TotalRequests) : 0.0f;
+}
+
+FGISRetrievalPlan UMapboxDataSource::PlanRetrieval() const
+{
+	FGISRetrievalPlan Plan;
+	if (!this->ValidateRequest(Plan.Error)) {
+		return Plan;
 	}
 	
-	if (this->reqRightLon < this->reqLeftLon)
-	{
-		OutError = FString(TEXT("Right Longitude value is lower than Left Longitude value"));
-		return false;
+	int minx, miny, maxx, maxy;
+	ComputeTileBounds(this->reqUpperLat, this->reqLeftLon, this->reqLowerLat, this->reqRightLon, this->reqZoom, minx, miny, maxx, maxy);
+	if (!this->ValidateMosaicSize(minx, miny, maxx, maxy, Plan.Error)) {
+		return Plan;
 	}
 	
-	if (this->reqUpperLat > maxLat || this->reqLowerLat < minLat)
+	// Count the distinct tiles for each requested channel, which are all fetched over the network unless they are being replayed
+	const bool bRequestRGB = (this->Channels != EGISDataChannels::HeightOnly);
+	const bool bRequestHeight = (this->Channels != EGISDataChannels::ColorOnly);
+	TArray<int> PlannedTileZooms;
+	int NumTiles = this->GatherTiles(this->reqUpperLat, this->reqLeftLon, this->reqLowerLat, this->reqRightLon, this->reqZoom, minx, miny, maxx, maxy, PlannedTileZooms).Num();
+	Plan.NumTiles = NumTiles * ((bRequestRGB ? 1 : 0) + (bRequestHeight ? 1 : 0));
+	Plan.NumRequests = (this->TransportSettings.Mode == ETileTransportMode::Replay) ? 0 : Plan.NumTiles;
+	
+	// The mosaic buffers are allocated up front and moved into the retrieved data, so they dominate the memory usage
+	int MosaicSizeX = MapboxTileSize * (maxx - minx + 1);
+	int MosaicSizeY = MapboxTileSize * (maxy - miny + 1);
+	Plan.HeightSizeX = bRequestHeight ? MosaicSizeX : 0;
+	Plan.HeightSizeY = bRequestHeight ? MosaicSizeY : 0;
+	Plan.ColorSizeX = bRequestRGB ? MosaicSizeX : 0;
+	Plan.ColorSizeY = bRequestRGB ? MosaicSizeY : 0;
+	Plan.HeightFormat = this->HeightFormat;
+	Plan.bHeightMayHaveNoData = bRequestHeight && this->bIgnoreMissingTiles;
+	Plan.PeakMemoryBytes = Plan.GetDataBytes();
+	
+	FGenerationCostCalibration Calibration = FGenerationCostCalibration::Load();
+	Plan.ExpectedDownloadBytes = Calibration.EstimateDownloadBytes(Plan.NumRequests);
+	Plan.EstimatedSeconds = Calibration.EstimateDownloadSeconds(Plan.ExpectedDownloadBytes);
+	return Plan;
+}
+
+bool UMapboxDataSource::ValidateMosaicSize(int minx, int miny, int maxx, int maxy, FString& OutError) const
+{
+	// check that number of tiles is smaller than max texture size
+	if ((uint64)(MapboxTileSize * (maxx - minx + 1)) > LandscapeConstraints::MaxRasterSizeX() || (uint64)(MapboxTileSize * (maxy - miny + 1)) > LandscapeConstraints::MaxRasterSizeY())
 	{
-		OutError = FString::Printf(TEXT("Upper or Lower Latitude value out of range (%f-%f)"), minLat, maxLat);
+		OutError = FString::Printf(TEXT("%d x %d tile dims too large please reduce to 64 x 64 by lowering zoom level or reducing area"), (maxx - minx), (maxy - miny));
 		return false;
 	}
 	
-	if (this->reqRightLon > maxLon || this->reqLeftLon < minLon)
+	return true;
+}
+
+void UMapboxDataSource::CancelPendingRequests()
+{
+	// Cancelled fetches never invoke their completion handlers, so they are not reported as failures
+	if (this->Transport.IsValid())
 	{
-		OutError = FString::Printf(TEXT("Upper or Lower Latitude value out of range (%f-%f)"), minLon, maxLon);
-		return false;
+		this->Transport->CancelAll();
+		this->Transport.Reset();
 	}
-	
-	return true;
+}
+
+void UMapboxDataSource::ReleaseBuffers()
+{
+	this->HeightData.Empty();
+	this->CompactHeightData.Empty();
+	this->RGBData.Empty();
+	this->TileZooms.Empty();
+}
+
+void UMapboxDataSource::FailRetrieval(const FString& Error)
+{
+	this->hasReqFailed = true;
+	this->CancelPendingRequests();
+	this->ReleaseBuffers();
+	this->OnFailure.Broadcast(Error, FGISData());
 }
 
 void UMapboxDataSource::RequestSectionRGBHeight(float upperLat, float leftLon, float lowerLat, float rightLon, int zoom)
 {
+	// Cancel any previous retrieval that is still in flight
+	this->CancelRetrieval();
 	this->hasReqFailed = false;
+	this->TotalRequests = 0;
+	this->CompletedRequests = 0;
+	this->ReceivedBytes = 0;
 	
 	// Check that request values are valid
 	FString ValidationError;
@@ -107,46 +180,12 @@ void UMapboxDataSource::RequestSectionRGBHeight(float upperLat, float leftLon, f
 		return;
 	}
 	
-	const int dimx = 256;
-	const int dimy = 256;
+	const int dimx = MapboxTileSize;
+	const int dimy = MapboxTileSize;
 	
 	// Find tile indice bounds for given coordinates and zoom
-	float minxf = long2tilexf(leftLon, zoom);
-	float minyf = lat2tileyf(upperLat, zoom);
-	
-	float maxxf = long2tilexf(rightLon, zoom);
-	float maxyf = lat2tileyf(lowerLat, zoom);
-	
-	////////// Make requests produce square results for now /////////////
-	
-	minxf = (int)(floor(minxf));
-	minyf = (int)(floor(minyf));
-	
-	maxxf = (int)(floor(maxxf));
-	maxyf = (int)(floor(maxyf));
-	
-	// Expand either x or y dimension to produce square result
-	bool isXLarger = (maxxf - minxf) >= (maxyf - minyf);
-	float largerSize = isXLarger ? (maxxf - minxf) : (maxyf - minyf);
-	float& smallerMin = isXLarger ? minyf : minxf;
-	float& smallerMax = isXLarger ? maxyf : maxxf;
-	
-	while (largerSize > (smallerMax - smallerMin))
-	{
-		if (((int)(smallerMax - smallerMin)) % 2) {
-			smallerMin--;
-		} else {
-			smallerMax++;
-		}
-	}
-	
-	////////// Make requests produce square results for now /////////////
-	
-	int minx = (int)(floor(minxf));
-	int miny = (int)(floor(minyf));
-	
-	int maxx = (int)(floor(maxxf));
-	int maxy = (int)(floor(maxyf));
+	int minx, miny, maxx, maxy;
+	ComputeTileBounds(upperLat, leftLon, lowerLat, rightLon, zoom, minx, miny, maxx, maxy);
 	
 	// /v4/{tileset_id}/{zoom}/{x}/{y}{@2x}.{format}
 	// https://api.mapbox.com/v4/mapbox.terrain-rgb/{z}/{x}/{y}.pngraw?access_token=YOUR_MAPBOX_ACCESS_TOKEN
@@ -158,7 +197,7 @@ void UMapboxDataSource::RequestSectionRGBHeight(float upperLat, float leftLon, f
 	FString TextureFormat = TEXT(".jpg90");
 	
 	FString HeightTilesetId = TEXT("mapbox.terrain-rgb");
-	FString HeightFormat = TEXT(".pngraw");
+	FString HeightTileFormat = TEXT(".pngraw");
 	
 	FString ApiKey = this->reqAPIKey;
 	
@@ -195,56 +234,216 @@ void UMapboxDataSource::RequestSectionRGBHeight(float upperLat, float leftLon, f
 	RequestTask->NumYHeightPixels = RequestTask->DimY;
 
 	// check that number of tiles is smaller than max texture size
-	if (RequestTask->NumXHeightPixels > LandscapeConstraints::MaxRasterSizeX() || RequestTask->NumYHeightPixels > LandscapeConstraints::MaxRasterSizeY())
+	FString ErrString;
+	if (!this->ValidateMosaicSize(minx, miny, maxx, maxy, ErrString))
 	{
-		FString ErrString = FString::Printf(TEXT("%d x %d tile dims too large please reduce to 64 x 64 by lowering zoom level or reducing area"), (maxx - minx), (maxy - miny));
 		this->OnFailure.Broadcast(ErrString, FGISData());
 		return;
 	}
 
-	RequestTask->RGBData = TArray<FColor>();
-	RequestTask->RGBData.AddDefaulted(RequestTask->NumXHeightPixels * RequestTask->NumYHeightPixels);
+	// Only allocate buffers (and send requests) for the channels that have been requested
+	const bool bRequestRGB = (this->Channels != EGISDataChannels::HeightOnly);
+	const bool bRequestHeight = (this->Channels != EGISDataChannels::ColorOnly);
+	
+	const int64 NumPixels = (int64)RequestTask->NumXHeightPixels * RequestTask->NumYHeightPixels;
+	RequestTask->RGBData = TArray64<uint8>();
+	if (bRequestRGB) {
+		RequestTask->RGBData.SetNumZeroed(NumPixels * sizeof(FColor));
+	}
+	
+	// Fill the height data with the missing tile marker so that any tiles that are ignored can be filled during generation
+	RequestTask->HeightData = TArray64<float>();
+	RequestTask->CompactHeightData = TArray64<uint16>();
+	if (bRequestHeight && this->HeightFormat.IsCompact()) {
+		RequestTask->CompactHeightData.Init(this->HeightFormat.Encode(std::numeric_limits<float>::quiet_NaN()), NumPixels);
+	}
+	else if (bRequestHeight) {
+		RequestTask->HeightData.Init(MissingTileHeight, NumPixels);
+	}
+	RequestTask->bHasMissingHeightTiles = false;
 	
-	RequestTask->HeightData = TArray<float>();
-	RequestTask->HeightData.AddDefaulted(RequestTask->NumXHeightPixels * RequestTask->NumYHeightPixels);
+	// Create a fresh transport for this retrieval so that it carries no state from any previous retrieval
+	RequestTask->Transport = ITileTransport::Create(this->TransportSettings);
+	RequestTask->RetrievalStartTime = FPlatformTime::Seconds();
 	
-	// Iterate over range of tile indices and create RGB and height data requests for each
-	for (int x = minx; x <= maxx; x++)
+	// Determine the zoom level that each tile of the mosaic will be filled from, and gather the distinct tiles that cover them
+	// (Coarse tiles shared by several tiles of the mosaic are only requested once)
+	TArray<FIntVector> Tiles = RequestTask->GatherTiles(upperLat, leftLon, lowerLat, rightLon, zoom, minx, miny, maxx, maxy, RequestTask->TileZooms);
+	if (Tiles.Num() < RequestTask->MaxX * RequestTask->MaxY) {
+		UE_LOG(LogTemp, Log, TEXT("Multi-resolution retrieval requires %d tiles per channel instead of %d"), Tiles.Num(), RequestTask->MaxX * RequestTask->MaxY);
+	}
+	
+	// Create RGB and height data requests for each tile
+	for (const FIntVector& Tile : Tiles)
 	{
-		for (int y = miny; y <= maxy; y++)
+		if (bRequestRGB)
 		{
-			FString TextureRequestURL = FString::Printf(TEXT("%s%s/%d/%d/%d%s?access_token=%s"), *BaseURL, *TextureTilesetId, zoom, x, y, *TextureFormat, *ApiKey);
-			FMapboxRequestData TextureReqData = { EMapboxRequestDataType::RGB, x, y };
+			FString TextureRequestURL = FString::Printf(TEXT("%s%s/%d/%d/%d%s?access_token=%s"), *BaseURL, *TextureTilesetId, Tile.Z, Tile.X, Tile.Y, *TextureFormat, *ApiKey);
+			FMapboxRequestData TextureReqData = { EMapboxRequestDataType::RGB, Tile.X, Tile.Y, Tile.Z };
 			RequestTask->Start(TextureRequestURL, TextureReqData);
-			
-			FString HeightRequestURL = FString::Printf(TEXT("%s%s/%d/%d/%d%s?access_token=%s"), *BaseURL, *HeightTilesetId, zoom, x, y, *HeightFormat, *ApiKey);
-			FMapboxRequestData HeightReqData = { EMapboxRequestDataType::HEIGHT, x, y };
+		}
+		
+		if (bRequestHeight)
+		{
+			FString HeightRequestURL = FString::Printf(TEXT("%s%s/%d/%d/%d%s?access_token=%s"), *BaseURL, *HeightTilesetId, Tile.Z, Tile.X, Tile.Y, *HeightTileFormat, *ApiKey);
+			FMapboxRequestData HeightReqData = { EMapboxRequestDataType::HEIGHT, Tile.X, Tile.Y, Tile.Z };
 			RequestTask->Start(HeightRequestURL, HeightReqData);
 		}
 	}
 }
 
-void UMapboxDataSource::Start(FString URL, FMapboxRequestData data)
+TArray<FIntVector> UMapboxDataSource::GatherTiles(float upperLat, float leftLon, float lowerLat, float rightLon, int zoom, int minx, int miny, int maxx, int maxy, TArray<int>& OutTileZooms) const
+{
+	int NumX = maxx - minx + 1;
+	int NumY = maxy - miny + 1;
+	OutTileZooms.Init(zoom, NumX * NumY);
+	if (this->bMultiResolution)
+	{
+		// Compute the focus centre in fractional tile coordinates, and the size of a tile in kilometres at the focus latitude
+		double CentreLat = (upperLat + lowerLat) * 0.5;
+		double CentreLon = (leftLon + rightLon) * 0.5;
+		double FocusX = long2tilexf(CentreLon, zoom);
+		double FocusY = lat2tileyf(CentreLat, zoom);
+		double TileSizeKm = 40075.016686 * FMath::Cos(FMath::DegreesToRadians(CentreLat)) / (double)(1 << zoom);
+		double FocusRadiusTiles = FMath::Max((double)this->FocusRadiusKm, 0.001) / TileSizeKm;
+		int LowestZoom = FMath::Clamp(this->MinimumZoom, 0, zoom);
+		
+		// Drop one zoom level for each doubling of the distance from the focus centre beyond the focus radius
+		for (int y = 0; y < NumY; y++)
+		{
+			for (int x = 0; x < NumX; x++)
+			{
+				double Distance = FVector2D::Distance(FVector2D(minx + x + 0.5, miny + y + 0.5), FVector2D(FocusX, FocusY));
+				int Levels = (Distance > FocusRadiusTiles) ? FMath::CeilToInt(FMath::Log2(Distance / FocusRadiusTiles)) : 0;
+				OutTileZooms[y * NumX + x] = FMath::Max(zoom - Levels, LowestZoom);
+			}
+		}
+	}
+	
+	// Gather the distinct tiles that cover the mosaic at each tile's zoom level
+	TArray<FIntVector> Tiles;
+	TSet<FIntVector> GatheredTiles;
+	for (int y = miny; y <= maxy; y++)
+	{
+		for (int x = minx; x <= maxx; x++)
+		{
+			int TileZoom = OutTileZooms[(y - miny) * NumX + (x - minx)];
+			int Shift = zoom - TileZoom;
+			FIntVector Tile(x >> Shift, y >> Shift, TileZoom);
+			if (!GatheredTiles.Contains(Tile))
+			{
+				GatheredTiles.Add(Tile);
+				Tiles.Add(Tile);
+			}
+		}
+	}
+	
+	return Tiles;
+}
+
+void UMapboxDataSource::UpsampleCoarseTile(const TArray64<uint8>& RawData, const FMapboxRequestData& data)
 {
-	// Create the Http request and add to pending request list
-	TSharedRef<IHttpRequest> HttpRequest = FHttpModule::Get().CreateRequest();
+	if (RawData.Num() < (int64)this->TileDimX * this->TileDimY * sizeof(FColor))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Coarse tile %d/%d/%d has unexpected dimensions"), data.Zoom, data.RelX, data.RelY);
+		return;
+	}
+	
+	// Decode the heights of the coarse tile up front so that they can be interpolated
+	const FColor* Src = (const FColor*)RawData.GetData();
+	TArray<float> CoarseHeights;
+	if (data.DataType == EMapboxRequestDataType::HEIGHT)
+	{
+		CoarseHeights.SetNumUninitialized(this->TileDimX * this->TileDimY);
+		for (int Index = 0; Index < CoarseHeights.Num(); Index++) {
+			CoarseHeights[Index] = DecodeTerrainRGB(Src[Index]);
+		}
+	}
 	
-	UE_LOG(LogTemp, Log, TEXT("Sent Request: %s"), *URL);
+	// Gather the tiles of the mosaic that are covered by the coarse tile and are filled from its zoom level
+	int Scale = 1 << (this->Zoom - data.Zoom);
+	TArray<FIntPoint> Targets;
+	for (int y = FMath::Max(data.RelY * Scale - this->OffsetY, 0); y < FMath::Min((data.RelY + 1) * Scale - this->OffsetY, this->MaxY); y++)
+	{
+		for (int x = FMath::Max(data.RelX * Scale - this->OffsetX, 0); x < FMath::Min((data.RelX + 1) * Scale - this->OffsetX, this->MaxX); x++)
+		{
+			if (this->TileZooms[y * this->MaxX + x] == data.Zoom) {
+				Targets.Add(FIntPoint(x, y));
+			}
+		}
+	}
 	
-	HttpRequest->OnProcessRequestComplete().BindUObject(this, &UMapboxDataSource::HandleMapboxRequest, data);
-	HttpRequest->SetURL(URL);
-	HttpRequest->SetVerb(TEXT("GET"));
-	HttpRequest->ProcessRequest();
+	// Bilinearly upsample the coarse tile into each target tile in parallel
+	ParallelFor(Targets.Num(), [&](int32 TargetIndex)
+	{
+		const FIntPoint& Target = Targets[TargetIndex];
+		for (int py = 0; py < this->TileDimY; py++)
+		{
+			// Compute the pixel row in the coarse tile that this row of the mosaic samples from
+			int64 AbsY = (int64)(this->OffsetY + Target.Y) * this->TileDimY + py;
+			float V = FMath::Clamp((float)((AbsY + 0.5) / Scale - (double)data.RelY * this->TileDimY - 0.5), 0.0f, (float)(this->TileDimY - 1));
+			int V0 = FMath::FloorToInt(V);
+			int V1 = FMath::Min(V0 + 1, this->TileDimY - 1);
+			float FracV = V - V0;
+			
+			int64 DestRow = ((int64)Target.Y * this->TileDimY + py) * this->NumXHeightPixels + (int64)Target.X * this->TileDimX;
+			for (int px = 0; px < this->TileDimX; px++)
+			{
+				int64 AbsX = (int64)(this->OffsetX + Target.X) * this->TileDimX + px;
+				float U = FMath::Clamp((float)((AbsX + 0.5) / Scale - (double)data.RelX * this->TileDimX - 0.5), 0.0f, (float)(this->TileDimX - 1));
+				int U0 = FMath::FloorToInt(U);
+				int U1 = FMath::Min(U0 + 1, this->TileDimX - 1);
+				float FracU = U - U0;
+				
+				int64 DestIdx = DestRow + px;
+				if (data.DataType == EMapboxRequestDataType::HEIGHT)
+				{
+					float Top = FMath::Lerp(CoarseHeights[V0 * this->TileDimX + U0], CoarseHeights[V0 * this->TileDimX + U1], FracU);
+					float Bottom = FMath::Lerp(CoarseHeights[V1 * this->TileDimX + U0], CoarseHeights[V1 * this->TileDimX + U1], FracU);
+					float Height = FMath::Lerp(Top, Bottom, FracV);
+					if (this->HeightFormat.IsCompact()) {
+						this->CompactHeightData[DestIdx] = this->HeightFormat.Encode(Height);
+					}
+					else {
+						this->HeightData[DestIdx] = Height;
+					}
+				}
+				else
+				{
+					FLinearColor Top = FMath::Lerp(Src[V0 * this->TileDimX + U0].ReinterpretAsLinear(), Src[V0 * this->TileDimX + U1].ReinterpretAsLinear(), FracU);
+					FLinearColor Bottom = FMath::Lerp(Src[V1 * this->TileDimX + U0].ReinterpretAsLinear(), Src[V1 * this->TileDimX + U1].ReinterpretAsLinear(), FracU);
+					((FColor*)this->RGBData.GetData())[DestIdx] = FMath::Lerp(Top, Bottom, FracV).ToFColor(false);
+				}
+			}
+		}
+	});
+}
+
+void UMapboxDataSource::Start(FString URL, FMapboxRequestData data)
+{
+	// Fetch the tile through the current transport, ignoring the response if this object has been destroyed in the meantime
+	TWeakObjectPtr<UMapboxDataSource> WeakThis = this;
+	this->Transport->Fetch(URL, [WeakThis, data](bool bSucceeded, const TArray<uint8>& Content)
+	{
+		if (WeakThis.IsValid()) {
+			WeakThis->HandleMapboxRequest(bSucceeded, Content, data);
+		}
+	});
 	
 	this->TotalRequests++;
 }
 
-void UMapboxDataSource::HandleMapboxRequest(FHttpRequestPtr HttpRequest, FHttpResponsePtr HttpResponse, bool bSucceeded, FMapboxRequestData data)
+void UMapboxDataSource::HandleMapboxRequest(bool bSucceeded, const TArray<uint8>& Content, FMapboxRequestData data)
 {
-	RemoveFromRoot();
+	// Ignore any responses that arrive after a failure
+	if (this->hasReqFailed) {
+		return;
+	}
 	
 	// Check if the HTTP requests succeeded, enter failure state if any request fails
-	if ( bSucceeded && HttpResponse.IsValid() && HttpResponse->GetContentLength() > 0 )
+	bool bDecoded = false;
+	this->ReceivedBytes += Content.Num();
+	if ( bSucceeded && Content.Num() > 0 )
 	{
 		IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
 		TSharedPtr<IImageWrapper> ImageWrappers[3] =
@@ -257,8 +456,18 @@ void UMapboxDataSource::HandleMapboxRequest(FHttpRequestPtr HttpRequest, FHttpRe
 		// Iterate of image wrappers until one is valid for the received data
 		for ( auto ImageWrapper : ImageWrappers )
 		{
-			if ( ImageWrapper.IsValid() && ImageWrapper->SetCompressed(HttpResponse->GetContent().GetData(), HttpResponse->GetContentLength()) )
+			if ( ImageWrapper.IsValid() && ImageWrapper->SetCompressed(Content.GetData(), Content.Num()) )
 			{
+				// Coarse tiles of multi-resolution requests are upsampled into each of the mosaic tiles that they fill
+				if (data.Zoom != this->Zoom)
+				{
+					TArray64<uint8> RawData;
+					ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, RawData);
+					this->UpsampleCoarseTile(RawData, data);
+					bDecoded = true;
+					break;
+				}
+				
 				// Determine which tile index we are dealing with
 				int TileXIdx = data.RelX - this->OffsetX;
 				int TileYIdx = data.RelY - this->OffsetY;
@@ -299,7 +508,7 @@ void UMapboxDataSource::HandleMapboxRequest(FHttpRequestPtr HttpRequest, FHttpRe
 							}
 							
 							// Check that we don't aren't writing to out of bounds indices in the destination array
-							if (DestPtrIdx >= (this->NumXHeightPixels * this->NumYHeightPixels)) {
+							if (DestPtrIdx >= ((int64)this->NumXHeightPixels * this->NumYHeightPixels)) {
 								UE_LOG(LogTemp, Error, TEXT("Writing Height data to out of bounds address"))
 							}
 							
@@ -334,7 +543,8 @@ void UMapboxDataSource::HandleMapboxRequest(FHttpRequestPtr HttpRequest, FHttpRe
 						{
 							// Set y location to start writing to in destination array
 							auto DestPtrIdx = ((int64)(y + TilePixelOffsetY)) * this->NumXHeightPixels + TilePixelOffsetX;
-							float* DestPtr = &((float*)this->HeightData.GetData())[DestPtrIdx];
+							float* DestPtr = this->HeightFormat.IsCompact() ? nullptr : this->HeightData.GetData() + DestPtrIdx;
+							uint16* CompactDestPtr = this->HeightFormat.IsCompact() ? this->CompactHeightData.GetData() + DestPtrIdx : nullptr;
 							
 							// Set y location to start reading from in source image
 							auto SrcPtrIdx = ((int64)(y)) * this->TileDimX + (TileXIdx ? 0 : XHeightOffsetMin);
@@ -346,14 +556,19 @@ void UMapboxDataSource::HandleMapboxRequest(FHttpRequestPtr HttpRequest, FHttpRe
 							}
 							
 							// Check that we are not writing to out of bounds indices in the destination array
-							if (DestPtrIdx >= (this->NumXHeightPixels * this->NumYHeightPixels)) {
+							if (DestPtrIdx >= ((int64)this->NumXHeightPixels * this->NumYHeightPixels)) {
 								UE_LOG(LogTemp, Error, TEXT("Writing Height data to out of bounds address"))
 							}
 							
 							// Iterate over x indices of source image that we want to read from (ignoring cropped indices)
 							for (int x = TileXIdx ? 0 : XHeightOffsetMin; x < ((TileXIdx + 1 == this->MaxX && XHeightOffsetMax) ? XHeightOffsetMax : this->TileDimX); x++)
 							{
-								*DestPtr++ = -10000.0f + ((SrcPtr->R * 256 * 256 + SrcPtr->G * 256 + SrcPtr->B) * 0.1f);
+								if (this->HeightFormat.IsCompact()) {
+									*CompactDestPtr++ = this->HeightFormat.Encode(DecodeTerrainRGB(*SrcPtr));
+								}
+								else {
+									*DestPtr++ = DecodeTerrainRGB(*SrcPtr);
+								}
 								SrcPtr++;
 							}
 						}
@@ -365,40 +580,73 @@ void UMapboxDataSource::HandleMapboxRequest(FHttpRequestPtr HttpRequest, FHttpRe
 					}
 				}
 				
-				this->CompletedRequests++;
-				UE_LOG(LogTemp, Log, TEXT("Completed Request, total resolved: %d"), this->CompletedRequests);
-				
-				// All requests complete, collate results and broadcast to success delegate
-				if (this->CompletedRequests >= this->TotalRequests || this->bIgnoreMissingTiles)
-				{
-					UE_LOG(LogTemp, Log, TEXT("MAPBOX REQUEST COMPLETE"));
-					
-					FGISData OutData;
-					OutData.HeightBuffer = this->HeightData;
-					OutData.HeightBufferX = this->NumXHeightPixels;
-					OutData.HeightBufferY = this->NumYHeightPixels;
-					OutData.ColorBuffer = TArray<uint8>((uint8*)this->RGBData.GetData(), this->RGBData.Num() * sizeof(FColor));
-					OutData.ColorBufferX = this->NumXHeightPixels;
-					OutData.ColorBufferY = this->NumYHeightPixels;
-					OutData.ProjectionWKT = UMapboxDataSource::ProjectionWKT;
-					OutData.CornerType = ECornerCoordinateType::LatLon;
-					OutData.UpperLeft = FVector2D(tiley2lat(this->OffsetY, this->Zoom), tilex2long(this->OffsetX, this->Zoom));
-					OutData.LowerRight = FVector2D(tiley2lat(this->OffsetY+this->MaxY, this->Zoom), tilex2long(this->OffsetX+this->MaxX, this->Zoom));
-					OutData.PixelFormat = EPixelFormat::PF_B8G8R8A8;
-					
-					this->OnSuccess.Broadcast(FString(), OutData);
-				}
-				return;
+				bDecoded = true;
+				break;
 			}
 		}
 	}
 	
-	if (!this->hasReqFailed)
+	// Enter the failure state if the request failed, unless we have been asked to ignore missing tiles
+	if (!bDecoded)
+	{
+		if (!this->bIgnoreMissingTiles)
+		{
+			this->FailRetrieval(bSucceeded
+				? FString(TEXT("One or more requests failed: Unable to process image"))
+				: FString(TEXT("One or more requests failed: Web request failed"))
+			);
+			return;
+		}
+		
+		UE_LOG(LogTemp, Warning, TEXT("Ignoring missing tile %d/%d,%d"), data.Zoom, data.RelX, data.RelY);
+		this->bHasMissingHeightTiles |= (data.DataType == EMapboxRequestDataType::HEIGHT);
+	}
+	
+	this->CompletedRequests++;
+	UE_LOG(LogTemp, Log, TEXT("Completed Request, total resolved: %d"), this->CompletedRequests);
+	
+	// All requests complete, collate results and broadcast to success delegate
+	if (this->CompletedRequests >= this->TotalRequests)
 	{
-		this->hasReqFailed = true;
-		FString FailString = bSucceeded 
-			? FString(TEXT("One or more requests failed: Unable to process image"))
-			: FString(TEXT("One or more requests failed: Web request failed"));
-		this->OnFailure.Broadcast(FailString, FGISData());
+		UE_LOG(LogTemp, Log, TEXT("MAPBOX REQUEST COMPLETE"));
+		
+		// Report the throughput of the retrieval so that transports and builds can be compared
+		double Elapsed = FMath::Max(FPlatformTime::Seconds() - this->RetrievalStartTime, 1e-6);
+		double ReceivedMB = (double)this->ReceivedBytes / (1024.0 * 1024.0);
+		UE_LOG(LogTemp, Log, TEXT("Retrieved %d tiles (%.2f MB) in %.2f seconds (%.2f MB/s)"), this->TotalRequests, ReceivedMB, Elapsed, ReceivedMB / Elapsed);
+		
+		// Calibrate future retrieval plans from live network fetches only, since replayed and simulated fetches do not reflect the network
+		if (this->TransportSettings.Mode != ETileTransportMode::Replay && this->TransportSettings.SimulatedLatencyMs <= 0.0f && this->TransportSettings.SimulatedBandwidthMbps <= 0.0f) {
+			FGenerationCostCalibration::RecordRetrieval(this->TotalRequests, this->ReceivedBytes, Elapsed);
+		}
+		this->Transport.Reset();
+		
+		// Move our buffers into the output data so that we don't retain a copy once retrieval has finished
+		// (Any channel that was not requested is left empty)
+		FGISData OutData;
+		if (this->HeightData.Num() > 0 || this->CompactHeightData.Num() > 0)
+		{
+			OutData.HeightBuffer = MoveTemp(this->HeightData);
+			OutData.CompactHeightBuffer = MoveTemp(this->CompactHeightData);
+			OutData.HeightFormat = this->HeightFormat;
+			OutData.HeightBufferX = this->NumXHeightPixels;
+			OutData.HeightBufferY = this->NumYHeightPixels;
+			OutData.bHeightHasNoData = this->bHasMissingHeightTiles;
+			OutData.HeightNoDataValue = MissingTileHeight;
+		}
+		if (this->RGBData.Num() > 0)
+		{
+			OutData.ColorBuffer = MoveTemp(this->RGBData);
+			OutData.ColorBufferX = this->NumXHeightPixels;
+			OutData.ColorBufferY = this->NumYHeightPixels;
+		}
+		OutData.ProjectionWKT = UMapboxDataSource::GetProjectionWKT();
+		OutData.CornerType = ECornerCoordinateType::LatLon;
+		OutData.UpperLeft = FVector2D(tiley2lat(this->OffsetY, this->Zoom), tilex2long(this->OffsetX, this->Zoom));
+		OutData.LowerRight = FVector2D(tiley2lat(this->OffsetY+this->MaxY, this->Zoom), tilex2long(this->OffsetX+this->MaxX, this->Zoom));
+		OutData.PixelFormat = EPixelFormat::PF_B8G8R8A8;
+		this->ReleaseBuffers();
+		
+		this->OnSuccess.Broadcast(FString(), OutData);
 	}
 }
@@ -1,13 +1,8 @@
 #include "MapboxDataSourceModule.h"
-#include "UnrealGDAL.h"
 
 #define LOCTEXT_NAMESPACE "FMapboxDataSourceModule"
 
-void FMapboxDataSourceModule::StartupModule()
-{
-	FUnrealGDALModule* UnrealGDAL = FModuleManager::Get().LoadModulePtr<FUnrealGDALModule>("UnrealGDAL");
-	UnrealGDAL->InitGDAL();
-}
+void FMapboxDataSourceModule::StartupModule() {}
 
 void FMapboxDataSourceModule::ShutdownModule() {}
 
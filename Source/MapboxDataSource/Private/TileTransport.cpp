@@ -0,0 +1,230 @@
+#include "TileTransport.h"
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+
+namespace
+{
+	// Computes the path of the recorded response for a URL, ignoring any access token in the query string
+	FString GetRecordingPath(const FString& Directory, const FString& URL)
+	{
+		FString Key = URL;
+		FString Query;
+		if (URL.Split(TEXT("?"), &Key, &Query))
+		{
+			TArray<FString> Parameters;
+			Query.ParseIntoArray(Parameters, TEXT("&"));
+			Parameters.RemoveAll([](const FString& Parameter) { return Parameter.StartsWith(TEXT("access_token=")); });
+			if (Parameters.Num() > 0) {
+				Key += TEXT("?") + FString::Join(Parameters, TEXT("&"));
+			}
+		}
+		
+		return FPaths::Combine(Directory, FMD5::HashAnsiString(*Key) + TEXT(".tile"));
+	}
+	
+	// Fetches tiles over HTTP
+	class FHttpTileTransport : public ITileTransport, public TSharedFromThis<FHttpTileTransport, ESPMode::ThreadSafe>
+	{
+	public:
+		
+		virtual void Fetch(const FString& URL, FTileFetchCallback OnComplete) override
+		{
+			TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+			TWeakPtr<FHttpTileTransport, ESPMode::ThreadSafe> WeakThis = this->AsShared();
+			Request->OnProcessRequestComplete().BindLambda([WeakThis, OnComplete](FHttpRequestPtr CompletedRequest, FHttpResponsePtr Response, bool bSucceeded)
+			{
+				TSharedPtr<FHttpTileTransport, ESPMode::ThreadSafe> This = WeakThis.Pin();
+				if (This.IsValid()) {
+					This->PendingRequests.Remove(CompletedRequest);
+				}
+				
+				if (bSucceeded && Response.IsValid() && Response->GetContentLength() > 0) {
+					OnComplete(true, Response->GetContent());
+				}
+				else {
+					OnComplete(false, TArray<uint8>());
+				}
+			});
+			
+			UE_LOG(LogTemp, Log, TEXT("Sent Request: %s"), *URL);
+			Request->SetURL(URL);
+			Request->SetVerb(TEXT("GET"));
+			
+			// Track the request before processing it, since a request that fails immediately may complete synchronously
+			this->PendingRequests.Add(Request);
+			Request->ProcessRequest();
+		}
+		
+		virtual void CancelAll() override
+		{
+			// Unbind our completion handler before cancelling so that cancelled requests are not reported as failures
+			TArray<FHttpRequestPtr> Requests = MoveTemp(this->PendingRequests);
+			for (FHttpRequestPtr& Request : Requests)
+			{
+				Request->OnProcessRequestComplete().Unbind();
+				Request->CancelRequest();
+			}
+		}
+	
+	private:
+		
+		// The HTTP requests that have been sent but have not yet completed
+		TArray<FHttpRequestPtr> PendingRequests;
+	};
+	
+	// Fetches tiles through another transport and saves each successful response to the recording directory
+	class FRecordingTileTransport : public ITileTransport
+	{
+	public:
+		
+		FRecordingTileTransport(const TSharedRef<ITileTransport, ESPMode::ThreadSafe>& InInner, const FString& InDirectory) :
+			Inner(InInner), Directory(InDirectory) {}
+		
+		virtual void Fetch(const FString& URL, FTileFetchCallback OnComplete) override
+		{
+			FString Path = GetRecordingPath(this->Directory, URL);
+			this->Inner->Fetch(URL, [Path, OnComplete](bool bSucceeded, const TArray<uint8>& Content)
+			{
+				if (bSucceeded && FFileHelper::SaveArrayToFile(Content, *Path) == false) {
+					UE_LOG(LogTemp, Warning, TEXT("Failed to record tile response to \"%s\""), *Path);
+				}
+				
+				OnComplete(bSucceeded, Content);
+			});
+		}
+		
+		virtual void CancelAll() override {
+			this->Inner->CancelAll();
+		}
+	
+	private:
+		
+		TSharedRef<ITileTransport, ESPMode::ThreadSafe> Inner;
+		FString Directory;
+	};
+	
+	// Serves tiles from the recording directory, reading each recorded response on a worker thread
+	class FReplayTileTransport : public ITileTransport
+	{
+	public:
+		
+		FReplayTileTransport(const FString& InDirectory) : Directory(InDirectory), Generation(MakeShared<FThreadSafeCounter, ESPMode::ThreadSafe>()) {}
+		
+		virtual void Fetch(const FString& URL, FTileFetchCallback OnComplete) override
+		{
+			// Fetches that were started before the most recent cancellation are dropped when they complete
+			FString Path = GetRecordingPath(this->Directory, URL);
+			TSharedRef<FThreadSafeCounter, ESPMode::ThreadSafe> CurrentGeneration = this->Generation;
+			int32 FetchGeneration = CurrentGeneration->GetValue();
+			Async(EAsyncExecution::ThreadPool, [Path, OnComplete, CurrentGeneration, FetchGeneration]()
+			{
+				TArray<uint8> Content;
+				bool bSucceeded = FFileHelper::LoadFileToArray(Content, *Path, FILEREAD_Silent) && Content.Num() > 0;
+				AsyncTask(ENamedThreads::GameThread, [OnComplete, CurrentGeneration, FetchGeneration, bSucceeded, Content = MoveTemp(Content)]()
+				{
+					if (CurrentGeneration->GetValue() == FetchGeneration) {
+						OnComplete(bSucceeded, Content);
+					}
+				});
+			});
+		}
+		
+		virtual void CancelAll() override {
+			this->Generation->Increment();
+		}
+	
+	private:
+		
+		FString Directory;
+		TSharedRef<FThreadSafeCounter, ESPMode::ThreadSafe> Generation;
+	};
+	
+	// Delivers the responses of another transport as if they had travelled over a network link with the specified round-trip latency
+	// and bandwidth, which is shared by all fetches so that concurrent transfers queue behind one another
+	class FSimulatedLinkTileTransport : public ITileTransport
+	{
+	public:
+		
+		FSimulatedLinkTileTransport(const TSharedRef<ITileTransport, ESPMode::ThreadSafe>& InInner, float LatencyMs, float BandwidthMbps) :
+			Inner(InInner),
+			Latency(FMath::Max(LatencyMs, 0.0f) / 1000.0),
+			BytesPerSecond(FMath::Max(BandwidthMbps, 0.0f) * 1000.0 * 1000.0 / 8.0),
+			State(MakeShared<FLinkState, ESPMode::ThreadSafe>())
+		{}
+		
+		virtual void Fetch(const FString& URL, FTileFetchCallback OnComplete) override
+		{
+			double StartTime = FPlatformTime::Seconds();
+			double InLatency = this->Latency;
+			double InBytesPerSecond = this->BytesPerSecond;
+			TSharedRef<FLinkState, ESPMode::ThreadSafe> LinkState = this->State;
+			int32 FetchGeneration = LinkState->Generation;
+			
+			// The inner transport always completes on the game thread, so the link state is only ever accessed from the game thread
+			this->Inner->Fetch(URL, [OnComplete, StartTime, InLatency, InBytesPerSecond, LinkState, FetchGeneration](bool bSucceeded, const TArray<uint8>& Content)
+			{
+				if (LinkState->Generation != FetchGeneration) {
+					return;
+				}
+				
+				// The response starts arriving once the latency has elapsed and the link has finished carrying earlier responses
+				double Now = FPlatformTime::Seconds();
+				double TransferTime = (InBytesPerSecond > 0.0) ? (Content.Num() / InBytesPerSecond) : 0.0;
+				double DeliveryTime = FMath::Max(StartTime + InLatency, LinkState->LinkFreeTime) + TransferTime;
+				LinkState->LinkFreeTime = FMath::Max(LinkState->LinkFreeTime, DeliveryTime);
+				
+				FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([OnComplete, LinkState, FetchGeneration, bSucceeded, Content](float DeltaTime) -> bool
+				{
+					if (LinkState->Generation == FetchGeneration) {
+						OnComplete(bSucceeded, Content);
+					}
+					
+					return false;
+				}), (float)FMath::Max(DeliveryTime - Now, 0.0));
+			});
+		}
+		
+		virtual void CancelAll() override
+		{
+			this->State->Generation++;
+			this->Inner->CancelAll();
+		}
+	
+	private:
+		
+		// The state of the simulated link, which is shared with in-flight fetches
+		struct FLinkState
+		{
+			int32 Generation = 0;
+			double LinkFreeTime = 0.0;
+		};
+		
+		TSharedRef<ITileTransport, ESPMode::ThreadSafe> Inner;
+		double Latency;
+		double BytesPerSecond;
+		TSharedRef<FLinkState, ESPMode::ThreadSafe> State;
+	};
+}
+
+TSharedRef<ITileTransport, ESPMode::ThreadSafe> ITileTransport::Create(const FTileTransportSettings& Settings)
+{
+	TSharedRef<ITileTransport, ESPMode::ThreadSafe> Transport = (Settings.Mode == ETileTransportMode::Replay) ?
+		StaticCastSharedRef<ITileTransport>(MakeShared<FReplayTileTransport, ESPMode::ThreadSafe>(Settings.RecordingDirectory)) :
+		StaticCastSharedRef<ITileTransport>(MakeShared<FHttpTileTransport, ESPMode::ThreadSafe>());
+	
+	if (Settings.Mode == ETileTransportMode::Record) {
+		Transport = MakeShared<FRecordingTileTransport, ESPMode::ThreadSafe>(Transport, Settings.RecordingDirectory);
+	}
+	
+	if (Settings.SimulatedLatencyMs > 0.0f || Settings.SimulatedBandwidthMbps > 0.0f) {
+		Transport = MakeShared<FSimulatedLinkTileTransport, ESPMode::ThreadSafe>(Transport, Settings.SimulatedLatencyMs, Settings.SimulatedBandwidthMbps);
+	}
+	
+	return Transport;
+}
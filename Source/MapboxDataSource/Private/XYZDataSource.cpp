@@ -0,0 +1,619 @@
+#include "XYZDataSource.h"
+#include "MapboxDataSource.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Misc/FileHelper.h"
+#include "Modules/ModuleManager.h"
+#include "GDALHeaders.h"
+#include "GenerationCostCalibration.h"
+#include "LandscapeConstraints.h"
+#include "LandscapeGenRuntime.h"
+#include "SlippyMapTiles.h"
+
+using namespace SlippyMapTiles;
+
+// The state of a single retrieval, shared between the data source and the worker threads that read and decode tiles
+struct FXYZRetrieval
+{
+	// The request parameters, which are immutable once the retrieval has started
+	int32 Zoom;
+	int32 MinX;
+	int32 MinY;
+	int32 NumTilesX;
+	int32 NumTilesY;
+	int32 TileSize;
+	EXYZHeightEncoding HeightEncoding;
+	FGISHeightFormat HeightFormat;
+	bool bIgnoreMissingTiles;
+	
+	// The mosaic buffers that tiles are decoded into (each tile writes to a disjoint region)
+	// (Heights are decoded into the compact buffer instead of the float buffer when a compact height format was requested)
+	TArray64<float> HeightData;
+	TArray64<uint16> CompactHeightData;
+	TArray64<uint8> ColorData;
+	
+	int32 TotalTiles = 0;
+	FThreadSafeCounter ProcessedTiles;
+	FThreadSafeBool bCancelled;
+	FThreadSafeBool bHasMissingHeightTiles;
+	
+	// The throughput statistics for tiles fetched from URL tile sources (only accessed on the game thread)
+	double StartTime = 0.0;
+	int32 FetchedTiles = 0;
+	int64 FetchedBytes = 0;
+	
+	void SetError(const FString& InError)
+	{
+		FScopeLock Lock(&this->ErrorLock);
+		if (this->Error.IsEmpty()) {
+			this->Error = InError;
+		}
+	}
+	
+	FString GetError()
+	{
+		FScopeLock Lock(&this->ErrorLock);
+		return this->Error;
+	}
+	
+	int64 GetMosaicWidth() const {
+		return (int64)this->NumTilesX * this->TileSize;
+	}
+	
+	int64 GetMosaicHeight() const {
+		return (int64)this->NumTilesY * this->TileSize;
+	}
+	
+private:
+	FCriticalSection ErrorLock;
+	FString Error;
+};
+
+namespace
+{
+	enum class EXYZTileSourceType
+	{
+		Http,
+		File,
+		MBTiles
+	};
+	
+	EXYZTileSourceType GetTileSourceType(const FString& Source)
+	{
+		if (Source.StartsWith(TEXT("http://")) || Source.StartsWith(TEXT("https://"))) {
+			return EXYZTileSourceType::Http;
+		}
+		
+		if (Source.EndsWith(TEXT(".mbtiles"))) {
+			return EXYZTileSourceType::MBTiles;
+		}
+		
+		return EXYZTileSourceType::File;
+	}
+	
+	// Opens a read-only handle to an MBTiles archive (each thread needs its own handle, since handles are not thread-safe)
+	GDALDatasetRef OpenMBTiles(const FString& Path)
+	{
+		FLandscapeGenRuntimeModule::EnsureGDALInitialized();
+		
+		// Prefer opening the archive as a plain SQLite database, falling back to whichever driver claims it
+		const char* const sqliteDriver[] = { "SQLite", nullptr };
+		GDALDataset* dataset = (GDALDataset*)GDALOpenEx(TCHAR_TO_UTF8(*Path), GDAL_OF_VECTOR | GDAL_OF_READONLY, sqliteDriver, nullptr, nullptr);
+		if (dataset == nullptr) {
+			dataset = (GDALDataset*)GDALOpenEx(TCHAR_TO_UTF8(*Path), GDAL_OF_RASTER | GDAL_OF_VECTOR | GDAL_OF_READONLY, nullptr, nullptr, nullptr);
+		}
+		
+		return GDALDatasetRef(dataset);
+	}
+	
+	// Reads the compressed data for a tile from an MBTiles archive
+	bool ReadMBTilesTile(GDALDataset* Archive, int32 Z, int32 X, int32 Y, TArray<uint8>& OutBytes)
+	{
+		// MBTiles archives use the flipped TMS row scheme
+		FString Query = FString::Printf(
+			TEXT("SELECT tile_data FROM tiles WHERE zoom_level=%d AND tile_column=%d AND tile_row=%d"),
+			Z, X, tiley2tms(Y, Z)
+		);
+		
+		OGRLayer* Result = Archive->ExecuteSQL(TCHAR_TO_UTF8(*Query), nullptr, nullptr);
+		if (Result == nullptr) {
+			return false;
+		}
+		
+		bool bFound = false;
+		OGRFeature* Feature = Result->GetNextFeature();
+		if (Feature != nullptr)
+		{
+			int NumBytes = 0;
+			const GByte* Blob = Feature->GetFieldAsBinary(0, &NumBytes);
+			if (Blob != nullptr && NumBytes > 0)
+			{
+				OutBytes.Append(Blob, NumBytes);
+				bFound = true;
+			}
+			
+			OGRFeature::DestroyFeature(Feature);
+		}
+		
+		Archive->ReleaseResultSet(Result);
+		return bFound;
+	}
+	
+	// Decodes a row of height tile pixels into the mosaic, storing the heights in the retrieval's height format
+	template <typename DecodeFunction>
+	void DecodeHeightRow(FXYZRetrieval& Retrieval, int64 DestIndex, const FColor* SrcRow, DecodeFunction Decode)
+	{
+		if (Retrieval.HeightFormat.IsCompact())
+		{
+			uint16* DestRow = Retrieval.CompactHeightData.GetData() + DestIndex;
+			for (int32 Col = 0; Col < Retrieval.TileSize; ++Col) {
+				DestRow[Col] = Retrieval.HeightFormat.Encode(Decode(SrcRow[Col]));
+			}
+		}
+		else
+		{
+			float* DestRow = Retrieval.HeightData.GetData() + DestIndex;
+			for (int32 Col = 0; Col < Retrieval.TileSize; ++Col) {
+				DestRow[Col] = Decode(SrcRow[Col]);
+			}
+		}
+	}
+	
+	// Decodes a compressed tile and copies its pixels into the appropriate region of the mosaic
+	bool DecodeTile(FXYZRetrieval& Retrieval, bool bHeight, int32 X, int32 Y, const uint8* Bytes, int64 NumBytes)
+	{
+		IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+		EImageFormat Format = ImageWrapperModule.DetectImageFormat(Bytes, NumBytes);
+		if (Format == EImageFormat::Invalid) {
+			return false;
+		}
+		
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(Format);
+		if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(Bytes, NumBytes)) {
+			return false;
+		}
+		
+		if (ImageWrapper->GetWidth() != Retrieval.TileSize || ImageWrapper->GetHeight() != Retrieval.TileSize)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Tile %d/%d/%d has dimensions %dx%d, expected %dx%d"), Retrieval.Zoom, X, Y, ImageWrapper->GetWidth(), ImageWrapper->GetHeight(), Retrieval.TileSize, Retrieval.TileSize);
+			return false;
+		}
+		
+		TArray64<uint8> RawData;
+		if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, RawData)) {
+			return false;
+		}
+		
+		// Copy each row of the tile into the mosaic
+		const FColor* Src = (const FColor*)RawData.GetData();
+		int64 MosaicWidth = Retrieval.GetMosaicWidth();
+		int64 OriginX = (int64)(X - Retrieval.MinX) * Retrieval.TileSize;
+		int64 OriginY = (int64)(Y - Retrieval.MinY) * Retrieval.TileSize;
+		for (int32 Row = 0; Row < Retrieval.TileSize; ++Row)
+		{
+			int64 DestIndex = (OriginY + Row) * MosaicWidth + OriginX;
+			const FColor* SrcRow = Src + (int64)Row * Retrieval.TileSize;
+			
+			if (bHeight)
+			{
+				if (Retrieval.HeightEncoding == EXYZHeightEncoding::Terrarium) {
+					DecodeHeightRow(Retrieval, DestIndex, SrcRow, DecodeTerrarium);
+				}
+				else {
+					DecodeHeightRow(Retrieval, DestIndex, SrcRow, DecodeTerrainRGB);
+				}
+			}
+			else {
+				FMemory::Memcpy(Retrieval.ColorData.GetData() + DestIndex * sizeof(FColor), SrcRow, Retrieval.TileSize * sizeof(FColor));
+			}
+		}
+		
+		return true;
+	}
+	
+	// Records a tile that could not be retrieved or decoded, which is an error unless we are ignoring missing tiles
+	void HandleMissingTile(FXYZRetrieval& Retrieval, bool bHeight, int32 X, int32 Y)
+	{
+		if (!Retrieval.bIgnoreMissingTiles)
+		{
+			Retrieval.SetError(FString::Printf(TEXT("Failed to retrieve %s tile %d/%d/%d"), bHeight ? TEXT("height") : TEXT("colour"), Retrieval.Zoom, X, Y));
+			return;
+		}
+		
+		UE_LOG(LogTemp, Warning, TEXT("Ignoring missing %s tile %d/%d/%d"), bHeight ? TEXT("height") : TEXT("colour"), Retrieval.Zoom, X, Y);
+		if (bHeight)
+		{
+			Retrieval.bHasMissingHeightTiles = true;
+			return;
+		}
+		
+		// The colour mosaic is not pre-filled, so fill the region of the missing tile with opaque black
+		int64 MosaicWidth = Retrieval.GetMosaicWidth();
+		int64 OriginX = (int64)(X - Retrieval.MinX) * Retrieval.TileSize;
+		int64 OriginY = (int64)(Y - Retrieval.MinY) * Retrieval.TileSize;
+		for (int32 Row = 0; Row < Retrieval.TileSize; ++Row)
+		{
+			FColor* DestRow = (FColor*)Retrieval.ColorData.GetData() + (OriginY + Row) * MosaicWidth + OriginX;
+			for (int32 Col = 0; Col < Retrieval.TileSize; ++Col) {
+				DestRow[Col] = FColor::Black;
+			}
+		}
+	}
+	
+	// Reads and decodes all of the tiles from a local tile source, spreading the tiles across worker threads that each hold
+	// their own file or archive handle
+	void ReadLocalTiles(FXYZRetrieval& Retrieval, const FString& Source, bool bHeight)
+	{
+		EXYZTileSourceType SourceType = GetTileSourceType(Source);
+		FString Path = Source;
+		Path.RemoveFromStart(TEXT("file://"));
+		
+		int32 NumTiles = Retrieval.NumTilesX * Retrieval.NumTilesY;
+		int32 NumWorkers = FMath::Clamp(FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, 1, NumTiles);
+		ParallelFor(NumWorkers, [&](int32 Worker)
+		{
+			GDALDatasetRef Archive;
+			if (SourceType == EXYZTileSourceType::MBTiles)
+			{
+				Archive = OpenMBTiles(Path);
+				if (!Archive)
+				{
+					Retrieval.SetError(FString::Printf(TEXT("Failed to open MBTiles archive %s"), *Path));
+					return;
+				}
+			}
+			
+			TArray<uint8> Bytes;
+			for (int32 Index = Worker; Index < NumTiles && !Retrieval.bCancelled; Index += NumWorkers)
+			{
+				int32 X = Retrieval.MinX + (Index % Retrieval.NumTilesX);
+				int32 Y = Retrieval.MinY + (Index / Retrieval.NumTilesX);
+				
+				Bytes.Reset();
+				bool bRead = (SourceType == EXYZTileSourceType::MBTiles)
+					? ReadMBTilesTile(Archive.Get(), Retrieval.Zoom, X, Y, Bytes)
+					: FFileHelper::LoadFileToArray(Bytes, *ExpandTileTemplate(Path, Retrieval.Zoom, X, Y), FILEREAD_Silent);
+				
+				if (!bRead || !DecodeTile(Retrieval, bHeight, X, Y, Bytes.GetData(), Bytes.Num())) {
+					HandleMissingTile(Retrieval, bHeight, X, Y);
+				}
+				
+				Retrieval.ProcessedTiles.Increment();
+			}
+		});
+	}
+}
+
+void UXYZDataSource::RetrieveData(FGISDataSourceDelegate InOnSuccess, FGISDataSourceDelegate InOnFailure)
+{
+	// Cancel any previous retrieval that is still in flight
+	this->CancelRetrieval();
+	this->OnSuccess = InOnSuccess;
+	this->OnFailure = InOnFailure;
+	
+	// Check that request values are valid
+	FString ValidationError;
+	if (!this->ValidateRequest(ValidationError))
+	{
+		this->OnFailure.Broadcast(ValidationError, FGISData());
+		return;
+	}
+	
+	// Find tile index bounds for the requested coordinates and zoom
+	int32 MinX, MinY, MaxX, MaxY;
+	this->ComputeTileBounds(MinX, MinY, MaxX, MaxY);
+	
+	TSharedRef<FXYZRetrieval, ESPMode::ThreadSafe> Retrieval = MakeShared<FXYZRetrieval, ESPMode::ThreadSafe>();
+	Retrieval->Zoom = this->reqZoom;
+	Retrieval->MinX = MinX;
+	Retrieval->MinY = MinY;
+	Retrieval->NumTilesX = MaxX - MinX + 1;
+	Retrieval->NumTilesY = MaxY - MinY + 1;
+	Retrieval->TileSize = this->TileSize;
+	Retrieval->HeightEncoding = this->HeightEncoding;
+	Retrieval->HeightFormat = this->HeightFormat;
+	Retrieval->bIgnoreMissingTiles = this->bIgnoreMissingTiles;
+	
+	// Check that the mosaic is no larger than the maximum supported raster size
+	FString ErrString;
+	if (!this->ValidateMosaicSize(Retrieval->GetMosaicWidth(), Retrieval->GetMosaicHeight(), ErrString))
+	{
+		this->OnFailure.Broadcast(ErrString, FGISData());
+		return;
+	}
+	
+	// Gather the tile sources for the requested channels, skipping the buffers and tile reads for any other channel
+	TArray<TPair<FString, bool>> Sources;
+	if (this->Channels != EGISDataChannels::ColorOnly) {
+		Sources.Add(TPair<FString, bool>(this->HeightTileSource, true));
+	}
+	if (this->Channels != EGISDataChannels::HeightOnly) {
+		Sources.Add(TPair<FString, bool>(this->ColorTileSource, false));
+	}
+	
+	// Fill the height data with the missing tile marker (or the nodata sample for compact heights), while the colour data is left
+	// uninitialised since every tile either copies its pixels (including alpha) into the mosaic or fills its region if it is missing
+	int64 NumPixels = Retrieval->GetMosaicWidth() * Retrieval->GetMosaicHeight();
+	if (this->Channels != EGISDataChannels::ColorOnly)
+	{
+		if (this->HeightFormat.IsCompact()) {
+			Retrieval->CompactHeightData.Init(this->HeightFormat.Encode(std::numeric_limits<float>::quiet_NaN()), NumPixels);
+		}
+		else {
+			Retrieval->HeightData.Init(MissingTileHeight, NumPixels);
+		}
+	}
+	if (this->Channels != EGISDataChannels::HeightOnly)
+	{
+		Retrieval->ColorData.SetNumUninitialized(NumPixels * sizeof(FColor));
+	}
+	
+	int32 NumTiles = Retrieval->NumTilesX * Retrieval->NumTilesY;
+	Retrieval->TotalTiles = NumTiles * Sources.Num();
+	this->CurrentRetrieval = Retrieval;
+	Retrieval->StartTime = FPlatformTime::Seconds();
+	
+	// Ensure the image wrapper module is loaded on the game thread before any worker threads make use of it
+	FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	
+	// Fetch the tiles for any remote tile sources and gather the local tile sources
+	TArray<TPair<FString, bool>> LocalSources;
+	for (const TPair<FString, bool>& Source : Sources)
+	{
+		if (GetTileSourceType(Source.Key) != EXYZTileSourceType::Http)
+		{
+			LocalSources.Add(Source);
+			continue;
+		}
+		
+		if (!this->Transport.IsValid()) {
+			this->Transport = ITileTransport::Create(this->TransportSettings);
+		}
+		
+		for (int32 Index = 0; Index < NumTiles; ++Index)
+		{
+			int32 X = MinX + (Index % Retrieval->NumTilesX);
+			int32 Y = MinY + (Index / Retrieval->NumTilesX);
+			this->StartTileFetch(Retrieval, ExpandTileTemplate(Source.Key, this->reqZoom, X, Y), Source.Value, X, Y);
+		}
+	}
+	
+	// Read the tiles for any local tile sources on a background thread
+	if (LocalSources.Num() > 0)
+	{
+		TWeakObjectPtr<UXYZDataSource> WeakThis(this);
+		Async(EAsyncExecution::ThreadPool, [WeakThis, Retrieval, LocalSources]()
+		{
+			for (const TPair<FString, bool>& Source : LocalSources) {
+				ReadLocalTiles(Retrieval.Get(), Source.Key, Source.Value);
+			}
+			
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Retrieval]()
+			{
+				if (WeakThis.IsValid()) {
+					WeakThis->HandleTileProcessed(Retrieval);
+				}
+			});
+		});
+	}
+}
+
+void UXYZDataSource::CancelRetrieval()
+{
+	// Signal any worker threads to stop, they will release the buffers once they drop their references to the retrieval
+	if (this->CurrentRetrieval.IsValid())
+	{
+		this->CurrentRetrieval->bCancelled = true;
+		this->CurrentRetrieval.Reset();
+	}
+	
+	// Cancelled fetches never invoke their completion handlers, so they are not reported as failures
+	if (this->Transport.IsValid())
+	{
+		this->Transport->CancelAll();
+		this->Transport.Reset();
+	}
+}
+
+float UXYZDataSource::GetRetrievalProgress() const
+{
+	if (this->CurrentRetrieval.IsValid() && this->CurrentRetrieval->TotalTiles > 0) {
+		return (float)this->CurrentRetrieval->ProcessedTiles.GetValue() / (float)this->CurrentRetrieval->TotalTiles;
+	}
+	
+	return 0.0f;
+}
+
+FGISRetrievalPlan UXYZDataSource::PlanRetrieval() const
+{
+	FGISRetrievalPlan Plan;
+	if (!this->ValidateRequest(Plan.Error)) {
+		return Plan;
+	}
+	
+	int32 MinX, MinY, MaxX, MaxY;
+	this->ComputeTileBounds(MinX, MinY, MaxX, MaxY);
+	int32 NumTiles = (MaxX - MinX + 1) * (MaxY - MinY + 1);
+	int64 MosaicWidth = (int64)(MaxX - MinX + 1) * this->TileSize;
+	int64 MosaicHeight = (int64)(MaxY - MinY + 1) * this->TileSize;
+	if (!this->ValidateMosaicSize(MosaicWidth, MosaicHeight, Plan.Error)) {
+		return Plan;
+	}
+	
+	// Every tile of each requested channel is read, but only the tiles of URL tile sources are fetched over the network
+	// (and not even those when they are being replayed from a recording)
+	const bool bRetrieveHeight = (this->Channels != EGISDataChannels::ColorOnly);
+	const bool bRetrieveColor = (this->Channels != EGISDataChannels::HeightOnly);
+	const bool bFetchRemote = (this->TransportSettings.Mode != ETileTransportMode::Replay);
+	if (bRetrieveHeight)
+	{
+		Plan.NumTiles += NumTiles;
+		Plan.NumRequests += (bFetchRemote && GetTileSourceType(this->HeightTileSource) == EXYZTileSourceType::Http) ? NumTiles : 0;
+		Plan.HeightSizeX = (int32)MosaicWidth;
+		Plan.HeightSizeY = (int32)MosaicHeight;
+	}
+	if (bRetrieveColor)
+	{
+		Plan.NumTiles += NumTiles;
+		Plan.NumRequests += (bFetchRemote && GetTileSourceType(this->ColorTileSource) == EXYZTileSourceType::Http) ? NumTiles : 0;
+		Plan.ColorSizeX = (int32)MosaicWidth;
+		Plan.ColorSizeY = (int32)MosaicHeight;
+	}
+	
+	// The mosaic buffers are allocated up front and moved into the retrieved data, so they dominate the memory usage
+	Plan.HeightFormat = this->HeightFormat;
+	Plan.bHeightMayHaveNoData = bRetrieveHeight && this->bIgnoreMissingTiles;
+	Plan.PeakMemoryBytes = Plan.GetDataBytes();
+	
+	// Local tile reads are not included in the estimated duration, since they are typically much faster than network fetches
+	FGenerationCostCalibration Calibration = FGenerationCostCalibration::Load();
+	Plan.ExpectedDownloadBytes = Calibration.EstimateDownloadBytes(Plan.NumRequests);
+	Plan.EstimatedSeconds = Calibration.EstimateDownloadSeconds(Plan.ExpectedDownloadBytes);
+	return Plan;
+}
+
+void UXYZDataSource::ComputeTileBounds(int32& OutMinX, int32& OutMinY, int32& OutMaxX, int32& OutMaxY) const
+{
+	int32 MaxTileIndex = (1 << this->reqZoom) - 1;
+	OutMinX = FMath::Clamp(long2tilex(this->reqLeftLon, this->reqZoom), 0, MaxTileIndex);
+	OutMaxX = FMath::Clamp(long2tilex(this->reqRightLon, this->reqZoom), 0, MaxTileIndex);
+	OutMinY = FMath::Clamp(lat2tiley(this->reqUpperLat, this->reqZoom), 0, MaxTileIndex);
+	OutMaxY = FMath::Clamp(lat2tiley(this->reqLowerLat, this->reqZoom), 0, MaxTileIndex);
+}
+
+bool UXYZDataSource::ValidateMosaicSize(int64 MosaicWidth, int64 MosaicHeight, FString& OutError) const
+{
+	if ((uint64)MosaicWidth > LandscapeConstraints::MaxRasterSizeX() || (uint64)MosaicHeight > LandscapeConstraints::MaxRasterSizeY())
+	{
+		OutError = FString::Printf(TEXT("%lld x %lld pixel mosaic exceeds the maximum supported raster size, please lower the zoom level or reduce the area"), MosaicWidth, MosaicHeight);
+		return false;
+	}
+	
+	return true;
+}
+
+bool UXYZDataSource::ValidateRequest(FString& OutError) const
+{
+	if ((this->Channels != EGISDataChannels::ColorOnly && this->HeightTileSource.IsEmpty()) || (this->Channels != EGISDataChannels::HeightOnly && this->ColorTileSource.IsEmpty()))
+	{
+		OutError = TEXT("A tile source must be specified for each requested channel");
+		return false;
+	}
+	
+	if (this->TileSize <= 0)
+	{
+		OutError = TEXT("Tile size must be greater than zero");
+		return false;
+	}
+	
+	const int maxZoom = 22;
+	return ValidateRequestBounds(this->reqUpperLat, this->reqLeftLon, this->reqLowerLat, this->reqRightLon, this->reqZoom, maxZoom, OutError);
+}
+
+void UXYZDataSource::StartTileFetch(const TSharedRef<FXYZRetrieval, ESPMode::ThreadSafe>& Retrieval, const FString& URL, bool bHeight, int32 X, int32 Y)
+{
+	TWeakObjectPtr<UXYZDataSource> WeakThis(this);
+	this->Transport->Fetch(URL, [WeakThis, Retrieval, bHeight, X, Y](bool bSucceeded, const TArray<uint8>& Content)
+	{
+		if (!WeakThis.IsValid() || Retrieval->bCancelled) {
+			return;
+		}
+		
+		Retrieval->FetchedTiles++;
+		Retrieval->FetchedBytes += Content.Num();
+		if (!bSucceeded || Content.Num() <= 0)
+		{
+			HandleMissingTile(Retrieval.Get(), bHeight, X, Y);
+			Retrieval->ProcessedTiles.Increment();
+			WeakThis->HandleTileProcessed(Retrieval);
+			return;
+		}
+		
+		// Decode the tile on a worker thread rather than blocking the game thread
+		Async(EAsyncExecution::ThreadPool, [WeakThis, Retrieval, bHeight, X, Y, Content]()
+		{
+			if (!Retrieval->bCancelled && !DecodeTile(Retrieval.Get(), bHeight, X, Y, Content.GetData(), Content.Num())) {
+				HandleMissingTile(Retrieval.Get(), bHeight, X, Y);
+			}
+			
+			Retrieval->ProcessedTiles.Increment();
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Retrieval]()
+			{
+				if (WeakThis.IsValid()) {
+					WeakThis->HandleTileProcessed(Retrieval);
+				}
+			});
+		});
+	});
+}
+
+void UXYZDataSource::HandleTileProcessed(const TSharedRef<FXYZRetrieval, ESPMode::ThreadSafe>& Retrieval)
+{
+	// Ignore notifications for retrievals that have been cancelled or have already finished
+	if (this->CurrentRetrieval.Get() != &Retrieval.Get()) {
+		return;
+	}
+	
+	if (!Retrieval->GetError().IsEmpty() || Retrieval->ProcessedTiles.GetValue() >= Retrieval->TotalTiles) {
+		this->FinishRetrieval(Retrieval);
+	}
+}
+
+void UXYZDataSource::FinishRetrieval(const TSharedRef<FXYZRetrieval, ESPMode::ThreadSafe>& Retrieval)
+{
+	FString Error = Retrieval->GetError();
+	if (!Error.IsEmpty())
+	{
+		this->CancelRetrieval();
+		this->OnFailure.Broadcast(Error, FGISData());
+		return;
+	}
+	
+	this->CurrentRetrieval.Reset();
+	this->Transport.Reset();
+	
+	// Report the throughput of any remote tile fetches so that transports and builds can be compared
+	if (Retrieval->FetchedTiles > 0)
+	{
+		double Elapsed = FMath::Max(FPlatformTime::Seconds() - Retrieval->StartTime, 1e-6);
+		double FetchedMB = (double)Retrieval->FetchedBytes / (1024.0 * 1024.0);
+		UE_LOG(LogTemp, Log, TEXT("Fetched %d tiles (%.2f MB) in %.2f seconds (%.2f MB/s)"), Retrieval->FetchedTiles, FetchedMB, Elapsed, FetchedMB / Elapsed);
+		
+		// Calibrate future retrieval plans from live network fetches only, since replayed and simulated fetches do not reflect the network
+		// (The elapsed time includes any local tile reads, which run concurrently with the fetches)
+		if (this->TransportSettings.Mode != ETileTransportMode::Replay && this->TransportSettings.SimulatedLatencyMs <= 0.0f && this->TransportSettings.SimulatedBandwidthMbps <= 0.0f) {
+			FGenerationCostCalibration::RecordRetrieval(Retrieval->FetchedTiles, Retrieval->FetchedBytes, Elapsed);
+		}
+	}
+	
+	// Move the mosaic buffers into the output data so that we don't retain a copy once retrieval has finished
+	// (Any channel that was not requested is left empty)
+	FGISData OutData;
+	if (Retrieval->HeightData.Num() > 0 || Retrieval->CompactHeightData.Num() > 0)
+	{
+		OutData.HeightBuffer = MoveTemp(Retrieval->HeightData);
+		OutData.CompactHeightBuffer = MoveTemp(Retrieval->CompactHeightData);
+		OutData.HeightFormat = Retrieval->HeightFormat;
+		OutData.HeightBufferX = Retrieval->GetMosaicWidth();
+		OutData.HeightBufferY = Retrieval->GetMosaicHeight();
+		OutData.bHeightHasNoData = Retrieval->bHasMissingHeightTiles;
+		OutData.HeightNoDataValue = MissingTileHeight;
+	}
+	if (Retrieval->ColorData.Num() > 0)
+	{
+		OutData.ColorBuffer = MoveTemp(Retrieval->ColorData);
+		OutData.ColorBufferX = Retrieval->GetMosaicWidth();
+		OutData.ColorBufferY = Retrieval->GetMosaicHeight();
+	}
+	OutData.PixelFormat = EPixelFormat::PF_B8G8R8A8;
+	OutData.ProjectionWKT = UMapboxDataSource::GetProjectionWKT();
+	OutData.CornerType = ECornerCoordinateType::LatLon;
+	OutData.UpperLeft = FVector2D(tiley2lat(Retrieval->MinY, Retrieval->Zoom), tilex2long(Retrieval->MinX, Retrieval->Zoom));
+	OutData.LowerRight = FVector2D(tiley2lat(Retrieval->MinY + Retrieval->NumTilesY, Retrieval->Zoom), tilex2long(Retrieval->MinX + Retrieval->NumTilesX, Retrieval->Zoom));
+	
+	this->OnSuccess.Broadcast(FString(), OutData);
+}
@@ -1,8 +1,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Interfaces/IHttpRequest.h"
 #include "GISDataSource.h"
+#include "TileTransport.h"
 #include "UObject/NoExportTypes.h"
 #include "MapboxDataSource.generated.h"
 
@@ -17,6 +17,9 @@ struct FMapboxRequestData
 	EMapboxRequestDataType DataType;
 	int RelX;
 	int RelY;
+	
+	// The zoom level of the requested tile, which is lower than the mosaic zoom level for the coarse tiles of multi-resolution requests
+	int Zoom;
 };
 
 UCLASS(Blueprintable)
@@ -25,10 +28,18 @@ class MAPBOXDATASOURCE_API UMapboxDataSource : public UObject, public IGISDataSo
 	GENERATED_BODY()
 	
 public:
-	const static FString ProjectionWKT;
+	// Returns the WKT of the Web Mercator projected coordinate system used by slippy map tiles
+	static FString GetProjectionWKT();
 	
 	virtual void RetrieveData(FGISDataSourceDelegate OnSuccess, FGISDataSourceDelegate OnFailure);
 	
+	virtual void CancelRetrieval() override;
+	
+	virtual float GetRetrievalProgress() const override;
+	
+	// Estimates the number of tiles, download size, memory usage and duration of the retrieval without sending any requests
+	virtual FGISRetrievalPlan PlanRetrieval() const override;
+	
 	void RequestSectionRGBHeight(float upperLat, float leftLon, float lowerLat, float rightLon, int zoom);
 	
 	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
@@ -52,17 +63,48 @@ public:
 	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
 	bool bIgnoreMissingTiles;
 	
+	// The raster data to retrieve (tiles for any channel that is not retrieved are never requested)
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	EGISDataChannels Channels = EGISDataChannels::HeightAndColor;
+	
+	// The format that retrieved heights are stored in (the compact formats halve the memory used by the heightmap)
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	FGISHeightFormat HeightFormat;
+	
+	// Controls how tiles are fetched (live, recorded to disk or replayed from disk, optionally over a simulated network link)
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	FTileTransportSettings TransportSettings;
+	
+	// Enables multi-resolution retrieval, which fetches tiles at reqZoom only within the focus radius of the centre of the requested
+	// area and drops one zoom level for each doubling of the distance beyond it, upsampling the coarser tiles into the mosaic
+	// (This greatly reduces the number of tiles fetched for large areas that only need detail near their centre)
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	bool bMultiResolution = false;
+	
+	// The radius around the centre of the requested area within which tiles are fetched at reqZoom
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	float FocusRadiusKm = 5.0f;
+	
+	// The lowest zoom level that multi-resolution retrieval will fetch tiles at
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	int MinimumZoom = 8;
+	
 	FGISDataSourceDelegate OnSuccess;
 	
 	FGISDataSourceDelegate OnFailure;
 	
 	void Start(FString URL, FMapboxRequestData data);
 	
-	TArray<float> HeightData;
-	TArray<FColor> RGBData;
+	// The mosaicked height and colour data (the colour data holds BGRA bytes, matching the memory layout of FColor)
+	// (These use 64-bit sizes so that mosaics above 2^31 samples do not overflow, and heights are stored in the compact buffer instead
+	// of the float buffer when a compact height format was requested)
+	TArray64<float> HeightData;
+	TArray64<uint16> CompactHeightData;
+	TArray64<uint8> RGBData;
 	
 private:
 	bool hasReqFailed = false;
+	bool bHasMissingHeightTiles = false;
 	
 	int DimX;
 	int DimY;
@@ -77,11 +119,25 @@ private:
 	float MaxU;
 	float MinV;
 	float MaxV;
-	int TotalRequests;
-	int CompletedRequests;
+	int TotalRequests = 0;
+	int CompletedRequests = 0;
 	int NumXHeightPixels;
 	int NumYHeightPixels;
 	
-	bool ValidateRequest(FString& OutError);
-	void HandleMapboxRequest(FHttpRequestPtr HttpRequest, FHttpResponsePtr HttpResponse, bool bSucceeded, FMapboxRequestData data);
+	// The zoom level that each tile of the mosaic is filled from, in row-major order
+	TArray<int> TileZooms;
+	
+	// The transport used by the current retrieval, and the throughput statistics for that retrieval
+	TSharedPtr<ITileTransport, ESPMode::ThreadSafe> Transport;
+	double RetrievalStartTime = 0.0;
+	int64 ReceivedBytes = 0;
+	
+	bool ValidateRequest(FString& OutError) const;
+	bool ValidateMosaicSize(int minx, int miny, int maxx, int maxy, FString& OutError) const;
+	void CancelPendingRequests();
+	void ReleaseBuffers();
+	void FailRetrieval(const FString& Error);
+	TArray<FIntVector> GatherTiles(float upperLat, float leftLon, float lowerLat, float rightLon, int zoom, int minx, int miny, int maxx, int maxy, TArray<int>& OutTileZooms) const;
+	void UpsampleCoarseTile(const TArray64<uint8>& RawData, const FMapboxRequestData& data);
+	void HandleMapboxRequest(bool bSucceeded, const TArray<uint8>& Content, FMapboxRequestData data);
 };
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TileTransport.generated.h"
+
+// The ways in which tile data sources can fetch remote tiles
+UENUM(BlueprintType)
+enum class ETileTransportMode : uint8
+{
+	// Fetch tiles over HTTP
+	Live    UMETA(DisplayName = "Live"),
+	
+	// Fetch tiles over HTTP and save each response to the recording directory
+	Record  UMETA(DisplayName = "Record"),
+	
+	// Serve tiles from the recording directory without any network access (tiles that were not recorded are reported as failures)
+	Replay  UMETA(DisplayName = "Replay"),
+};
+
+// Settings controlling how a tile data source fetches remote tiles
+USTRUCT(BlueprintType)
+struct MAPBOXDATASOURCE_API FTileTransportSettings
+{
+	GENERATED_BODY()
+	
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	ETileTransportMode Mode = ETileTransportMode::Live;
+	
+	// The directory that responses are recorded to or replayed from
+	// (Recordings are keyed by URL with any access token removed, so they can be replayed without credentials)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	FString RecordingDirectory;
+	
+	// The simulated round-trip latency added to each fetch, or zero to disable the latency simulation
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float SimulatedLatencyMs = 0.0f;
+	
+	// The simulated bandwidth of the link that all fetches share, or zero to disable the bandwidth simulation
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float SimulatedBandwidthMbps = 0.0f;
+};
+
+// The callback invoked on the game thread when a fetch completes
+typedef TFunction<void(bool bSucceeded, const TArray<uint8>& Content)> FTileFetchCallback;
+
+// The interface through which tile data sources fetch remote tiles, which allows retrieval to be recorded, replayed offline and run
+// over a simulated network link so that tile scheduling and decoding can be reproduced and benchmarked deterministically
+class MAPBOXDATASOURCE_API ITileTransport
+{
+public:
+	
+	virtual ~ITileTransport() {}
+	
+	// Fetches the content at the specified URL, invoking the callback on the game thread once the fetch completes
+	// (Fetches that succeed with empty content are reported as failures)
+	virtual void Fetch(const FString& URL, FTileFetchCallback OnComplete) = 0;
+	
+	// Cancels all in-flight fetches, whose callbacks will not be invoked
+	virtual void CancelAll() = 0;
+	
+	// Creates the transport described by the specified settings (the link simulation is applied on top of the selected mode)
+	static TSharedRef<ITileTransport, ESPMode::ThreadSafe> Create(const FTileTransportSettings& Settings);
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GISDataSource.h"
+#include "TileTransport.h"
+#include "UObject/NoExportTypes.h"
+#include "XYZDataSource.generated.h"
+
+// The encodings used to store height values in the RGB channels of height tiles
+UENUM(BlueprintType)
+enum class EXYZHeightEncoding : uint8
+{
+	// Mapbox Terrain-RGB encoding
+	TerrainRGB  UMETA(DisplayName = "Terrain-RGB"),
+	
+	// Mapzen/Tilezen Terrarium encoding
+	Terrarium   UMETA(DisplayName = "Terrarium"),
+};
+
+struct FXYZRetrieval;
+
+// A data source that retrieves height and colour tiles from any slippy map (z/x/y) tile source. Each tile source may be:
+//
+// - A URL template such as "https://tiles.example.com/terrain/{z}/{x}/{y}.png"
+// - A local directory tree template such as "file://D:/Tiles/terrain/{z}/{x}/{y}.png"
+// - The path to an MBTiles archive such as "D:/Tiles/terrain.mbtiles"
+//
+// Templates may use {-y} in place of {y} for tile sources that use the flipped TMS row scheme.
+UCLASS(Blueprintable)
+class MAPBOXDATASOURCE_API UXYZDataSource : public UObject, public IGISDataSource
+{
+	GENERATED_BODY()
+	
+public:
+	
+	virtual void RetrieveData(FGISDataSourceDelegate OnSuccess, FGISDataSourceDelegate OnFailure);
+	
+	virtual void CancelRetrieval() override;
+	
+	virtual float GetRetrievalProgress() const override;
+	
+	// Estimates the number of tiles, download size, memory usage and duration of the retrieval without reading any tiles
+	virtual FGISRetrievalPlan PlanRetrieval() const override;
+	
+	// The tile source for the height tiles
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	FString HeightTileSource;
+	
+	// The tile source for the colour tiles
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	FString ColorTileSource;
+	
+	// The encoding used by the height tiles
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	EXYZHeightEncoding HeightEncoding = EXYZHeightEncoding::TerrainRGB;
+	
+	// The format that retrieved heights are stored in (the compact formats halve the memory used by the heightmap)
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	FGISHeightFormat HeightFormat;
+	
+	// The width and height of each tile in pixels (all height and colour tiles must share the same size)
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	int TileSize = 256;
+	
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	float reqUpperLat;
+	
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	float reqLeftLon;
+	
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	float reqLowerLat;
+	
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	float reqRightLon;
+	
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	int reqZoom;
+	
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	bool bIgnoreMissingTiles;
+	
+	// The raster data to retrieve (the tile source for any channel that is not retrieved is never read and may be left empty)
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	EGISDataChannels Channels = EGISDataChannels::HeightAndColor;
+	
+	// Controls how tiles from URL tile sources are fetched (live, recorded to disk or replayed from disk, optionally over a simulated network link)
+	UPROPERTY(BlueprintReadWrite, meta = (ExposeOnSpawn = "true"))
+	FTileTransportSettings TransportSettings;
+	
+private:
+	
+	FGISDataSourceDelegate OnSuccess;
+	FGISDataSourceDelegate OnFailure;
+	
+	// The state of the in-flight retrieval, which is shared with the worker threads that read and decode tiles
+	TSharedPtr<FXYZRetrieval, ESPMode::ThreadSafe> CurrentRetrieval;
+	
+	// The transport used to fetch tiles from URL tile sources during the in-flight retrieval
+	TSharedPtr<ITileTransport, ESPMode::ThreadSafe> Transport;
+	
+	bool ValidateRequest(FString& OutError) const;
+	void ComputeTileBounds(int32& OutMinX, int32& OutMinY, int32& OutMaxX, int32& OutMaxY) const;
+	bool ValidateMosaicSize(int64 MosaicWidth, int64 MosaicHeight, FString& OutError) const;
+	void StartTileFetch(const TSharedRef<FXYZRetrieval, ESPMode::ThreadSafe>& Retrieval, const FString& URL, bool bHeight, int32 X, int32 Y);
+	void HandleTileProcessed(const TSharedRef<FXYZRetrieval, ESPMode::ThreadSafe>& Retrieval);
+	void FinishRetrieval(const TSharedRef<FXYZRetrieval, ESPMode::ThreadSafe>& Retrieval);
+};